@@ -40,6 +40,9 @@
 #include "ejudge/random.h"
 #include "ejudge/ej_process.h"
 #include "ejudge/agent_client.h"
+#include "ejudge/spool_notify.h"
+#include "ejudge/compile_cache.h"
+#include "ejudge/sha256.h"
 
 #include "ejudge/meta_generic.h"
 #include "ejudge/meta/compile_packet_meta.h"
@@ -79,6 +82,9 @@ static unsigned char *agent_name;
 static struct AgentClient *agent;
 static unsigned char *instance_id;
 static int verbose_mode;
+static struct compile_cache *compile_cache;
+// set by invoke_compiler, timed out compilations are not cached
+static int compiler_timed_out;
 
 struct testinfo_subst_handler_compile
 {
@@ -213,6 +219,7 @@ invoke_compiler(
   const struct section_global_data *global = serve_state.global;
   tpTask tsk = 0;
 
+  compiler_timed_out = 0;
   tsk = task_New();
   if (req->vcs_mode) {
     unsigned char helper_path[PATH_MAX];
@@ -307,6 +314,7 @@ invoke_compiler(
 
   if (task_IsTimeout(tsk)) {
     err("Compilation process timed out");
+    compiler_timed_out = 1;
     task_Delete(tsk);
     if (req->not_ok_is_cf > 0) {
       fprintf(log_f, "\nCompilation process timed out\n");
@@ -333,6 +341,168 @@ invoke_compiler(
   }
 }
 
+static void
+cache_key_add_str(SHA256_CTX *ctx, const unsigned char *str)
+{
+  unsigned int len = 0;
+  if (str) len = strlen(str) + 1;
+  sha256_update(ctx, (const uint8_t *) &len, sizeof(len));
+  if (str) sha256_update(ctx, (const uint8_t *) str, len);
+}
+
+static void
+cache_key_add_num(SHA256_CTX *ctx, long long num)
+{
+  sha256_update(ctx, (const uint8_t *) &num, sizeof(num));
+}
+
+/* identify the compiler script or the style checker */
+static void
+cache_key_add_file(SHA256_CTX *ctx, const unsigned char *path)
+{
+  struct stat stb;
+
+  cache_key_add_str(ctx, path);
+  memset(&stb, 0, sizeof(stb));
+  if (path) stat(path, &stb);
+  cache_key_add_num(ctx, stb.st_dev);
+  cache_key_add_num(ctx, stb.st_ino);
+  cache_key_add_num(ctx, stb.st_size);
+  cache_key_add_num(ctx, stb.st_mtime);
+}
+
+struct compiler_version
+{
+  unsigned char *cmd;
+  unsigned char *version;
+  time_t check_time;
+};
+
+static struct compiler_version *compiler_versions;
+static int compiler_versions_u, compiler_versions_a;
+
+/* the version is checked again after that, as the compiler might be
+   upgraded while ej-compile is running */
+enum { COMPILER_VERSION_CHECK_INTERVAL = 600 };
+
+/* the full compiler version as reported by the CMD-version script,
+   NULL if it is not available */
+static const unsigned char *
+get_compiler_version(const unsigned char *cmd)
+{
+  struct compiler_version *cv = NULL;
+  unsigned char version_script[PATH_MAX];
+  char *args[3];
+  unsigned char *stdout_text = NULL;
+  unsigned char *stderr_text = NULL;
+  time_t cur_time = time(NULL);
+  int i, r;
+
+  if (!cmd || !*cmd) return NULL;
+  for (i = 0; i < compiler_versions_u; ++i) {
+    if (!strcmp(compiler_versions[i].cmd, cmd)) {
+      cv = &compiler_versions[i];
+      break;
+    }
+  }
+  if (cv && cv->check_time + COMPILER_VERSION_CHECK_INTERVAL > cur_time) {
+    return cv->version;
+  }
+  if (!cv) {
+    if (compiler_versions_u == compiler_versions_a) {
+      if (!(compiler_versions_a *= 2)) compiler_versions_a = 16;
+      XREALLOC(compiler_versions, compiler_versions_a);
+    }
+    cv = &compiler_versions[compiler_versions_u++];
+    memset(cv, 0, sizeof(*cv));
+    cv->cmd = xstrdup(cmd);
+  }
+  xfree(cv->version); cv->version = NULL;
+  cv->check_time = cur_time;
+
+  snprintf(version_script, sizeof(version_script), "%s-version", cmd);
+  if (access(version_script, X_OK) < 0) return NULL;
+  args[0] = version_script;
+  args[1] = "-f";
+  args[2] = NULL;
+  r = ejudge_invoke_process(args, NULL, NULL, "/dev/null", NULL, 0, &stdout_text, &stderr_text);
+  xfree(stderr_text);
+  if (r != 0 || !stdout_text || !*stdout_text) {
+    err("%s failed, compilation results are not cached", version_script);
+    xfree(stdout_text);
+    return NULL;
+  }
+  cv->version = stdout_text;
+  return cv->version;
+}
+
+/* the key covers everything that affects the compilation result */
+static int
+make_compile_cache_key(
+        const struct compile_request_packet *req,
+        const struct section_language_data *lang,
+        const unsigned char *src_path,
+        unsigned char *key,
+        size_t key_size)
+{
+  const struct section_global_data *global = serve_state.global;
+  char *src_s = NULL;
+  size_t src_z = 0;
+  SHA256_CTX ctx;
+  uint8_t digest[SHA256_BLOCK_SIZE];
+  const unsigned char *compiler_version;
+
+  if (key_size < COMPILE_CACHE_KEY_SIZE) return -1;
+  // the script does not change when the compiler is upgraded
+  if (!(compiler_version = get_compiler_version(lang->cmd))) return -1;
+  if (generic_read_file(&src_s, 0, &src_z, 0, NULL, src_path, "") < 0) return -1;
+
+  sha256_init(&ctx);
+  cache_key_add_num(&ctx, src_z);
+  sha256_update(&ctx, (const uint8_t *) src_s, src_z);
+  xfree(src_s); src_s = NULL;
+
+  cache_key_add_str(&ctx, lang->short_name);
+  cache_key_add_str(&ctx, lang->long_name);
+  cache_key_add_str(&ctx, lang->src_sfx);
+  cache_key_add_str(&ctx, lang->exe_sfx);
+  cache_key_add_file(&ctx, lang->cmd);
+  cache_key_add_str(&ctx, compiler_version);
+  cache_key_add_num(&ctx, lang->compile_real_time_limit);
+  for (int i = 0; i < req->env_num; ++i) {
+    cache_key_add_str(&ctx, req->env_vars[i]);
+  }
+  cache_key_add_num(&ctx, -1);
+  if (req->style_checker && req->style_checker[0]) {
+    cache_key_add_file(&ctx, req->style_checker);
+    for (int i = 0; i < req->sc_env_num; ++i) {
+      cache_key_add_str(&ctx, req->sc_env_vars[i]);
+    }
+  }
+  cache_key_add_num(&ctx, -1);
+  cache_key_add_str(&ctx, req->container_options);
+  cache_key_add_num(&ctx, ejudge_config->enable_compile_container);
+  cache_key_add_num(&ctx, req->not_ok_is_cf);
+  cache_key_add_num(&ctx, req->max_vm_size);
+  cache_key_add_num(&ctx, req->max_stack_size);
+  cache_key_add_num(&ctx, req->max_file_size);
+  cache_key_add_num(&ctx, req->max_rss_size);
+  cache_key_add_num(&ctx, lang->max_vm_size);
+  cache_key_add_num(&ctx, lang->max_stack_size);
+  cache_key_add_num(&ctx, lang->max_file_size);
+  cache_key_add_num(&ctx, lang->max_rss_size);
+  cache_key_add_num(&ctx, global->compile_max_vm_size);
+  cache_key_add_num(&ctx, global->compile_max_stack_size);
+  cache_key_add_num(&ctx, global->compile_max_file_size);
+  cache_key_add_num(&ctx, global->compile_max_rss_size);
+  sha256_final(&ctx, digest);
+
+  for (int i = 0; i < SHA256_BLOCK_SIZE; ++i) {
+    snprintf(key + i * 2, 3, "%02x", digest[i]);
+  }
+  return 0;
+}
+
 static void
 handle_packet(
         FILE *log_f,
@@ -449,8 +619,18 @@ handle_packet(
     goto cleanup;
   }
 
+  // the source file name gets into the compiler messages and the debug
+  // information, so the cached results must not depend on the run
+  int cacheable = compile_cache && !req->multi_header && req->vcs_mode <= 0
+    && req->style_check_only <= 0;
+  unsigned char work_base[64];
+  if (cacheable) {
+    snprintf(work_base, sizeof(work_base), "%s", "solution");
+  } else {
+    snprintf(work_base, sizeof(work_base), "%06d", req->run_id);
+  }
   unsigned char src_work_name[PATH_MAX];
-  snprintf(src_work_name, sizeof(src_work_name), "%06d%s", req->run_id, lang->src_sfx);
+  snprintf(src_work_name, sizeof(src_work_name), "%s%s", work_base, lang->src_sfx);
   unsigned char src_work_path[PATH_MAX];
   snprintf(src_work_path, sizeof(src_work_path), "%s/%s", working_dir, src_work_name);
 
@@ -474,10 +654,23 @@ handle_packet(
   }
 
   if (!req->multi_header) {
-    snprintf(exe_work_name, PATH_MAX, "%06d%s", req->run_id, lang->exe_sfx);
+    snprintf(exe_work_name, PATH_MAX, "%s%s", work_base, lang->exe_sfx);
     unsigned char exe_work_path[PATH_MAX];
     snprintf(exe_work_path, sizeof(exe_work_path), "%s/%s", working_dir, exe_work_name);
 
+    unsigned char cache_key[COMPILE_CACHE_KEY_SIZE];
+    cache_key[0] = 0;
+    if (cacheable
+        && make_compile_cache_key(req, lang, src_work_path, cache_key, sizeof(cache_key)) >= 0) {
+      int cached_status = 0;
+      fflush(log_f);
+      if (compile_cache_lookup(compile_cache, cache_key, &cached_status,
+                               exe_work_path, log_work_path) > 0) {
+        rpl->status = cached_status;
+        goto cleanup;
+      }
+    }
+
     /*
     if (req->style_checker && req->style_checker[0]) {
       int r = invoke_style_checker(log_f, cs, lang, req, src_work_name, working_dir, log_work_path, NULL);
@@ -505,6 +698,20 @@ handle_packet(
       if (r == RUN_OK && req->style_check_only > 0) *p_override_exe = 1;
     }
 
+    if (cache_key[0] && !compiler_timed_out
+        && (rpl->status == RUN_OK || rpl->status == RUN_COMPILE_ERR
+            || rpl->status == RUN_STYLE_ERR)) {
+      struct stat stb;
+      const unsigned char *cached_exe = NULL;
+      if (lstat(exe_work_path, &stb) >= 0 && S_ISREG(stb.st_mode) && stb.st_size <= MAX_EXE_SIZE) {
+        cached_exe = exe_work_path;
+      }
+      fflush(log_f);
+      if (rpl->status != RUN_OK || cached_exe) {
+        compile_cache_store(compile_cache, cache_key, rpl->status, cached_exe, log_work_path);
+      }
+    }
+
     goto cleanup;
   }
 
@@ -889,6 +1096,7 @@ new_loop(int parallel_mode)
   int exe_copied = 0;
   path_t full_working_dir = { 0 };
   struct Future *future = NULL;
+  struct spool_notify *queue_notify = NULL;
 
   if (parallel_mode) {
     random_init();
@@ -934,6 +1142,16 @@ new_loop(int parallel_mode)
   }
 #endif
 
+  // wake up as soon as a packet is moved to the local spool
+  if (!agent) {
+    queue_notify = spool_notify_open(compile_server_queue_dir);
+  }
+
+  if (ejudge_config->compile_cache_dir && ejudge_config->compile_cache_dir[0]) {
+    compile_cache = compile_cache_open(ejudge_config->compile_cache_dir,
+                                       ejudge_config->compile_cache_size);
+  }
+
   interrupt_init();
   interrupt_setup_usr1();
   interrupt_disable();
@@ -977,6 +1195,7 @@ new_loop(int parallel_mode)
           continue;
         default:
           err("unrecoverable error, exiting");
+          spool_notify_close(queue_notify);
           return -1;
         }
       }
@@ -985,7 +1204,7 @@ new_loop(int parallel_mode)
     if (!r) {
       int sleep_time = agent?30000:global->sleep_time;
       interrupt_enable();
-      os_Sleep(sleep_time);
+      spool_notify_wait(queue_notify, sleep_time);
       interrupt_disable();
       continue;
     }
@@ -1301,6 +1520,8 @@ new_loop(int parallel_mode)
     clear_directory(full_working_dir);
   }
 
+  spool_notify_close(queue_notify);
+  compile_cache = compile_cache_close(compile_cache);
   if (agent) {
     agent->ops->close(agent);
   }
@@ -40,6 +40,7 @@
 #include <sys/sem.h>
 #include <sys/shm.h>
 #include <sys/prctl.h>
+#include <sys/file.h>
 #include <asm/unistd.h>
 #include <asm/param.h>
 #include <linux/audit.h>
@@ -138,6 +139,10 @@ static int enable_seccomp = 1;
 static int enable_sys_execve = 0;
 static int enable_sys_fork = 0;
 
+// cgroup pool: the cgroups ejudge/pool-N are created once and reused
+static int container_pool_size = 0;
+static int cgroup_pool_fd = -1;
+
 static char *working_dir = NULL;
 static char *working_dir_parent = NULL;
 static char *working_dir_name = NULL;
@@ -1269,14 +1274,13 @@ struct CGroupStat
 };
 
 static void
-read_cgroup_stats_v2(struct CGroupStat *ps)
+read_cgroup_stats_v2(const char *dir, struct CGroupStat *ps)
 {
     FILE *f = NULL;
 
     char cpu_stat_path[PATH_MAX];
     if (snprintf(cpu_stat_path, sizeof(cpu_stat_path),
-                 "%s/ejudge/%s/cpu.stat",
-                 cgroup_path, cgroup_name) >= sizeof(cpu_stat_path)) {
+                 "%s/cpu.stat", dir) >= sizeof(cpu_stat_path)) {
         goto fail;
     }
     if (!(f = fopen(cpu_stat_path, "r"))) {
@@ -1310,14 +1314,13 @@ fail:
 }
 
 static void
-read_cgroup_stats_v1(struct CGroupStat *ps)
+read_cgroup_stats_v1(const char *dir, struct CGroupStat *ps)
 {
     FILE *f = NULL;
 
     char cpu_stat_path[PATH_MAX];
     if (snprintf(cpu_stat_path, sizeof(cpu_stat_path),
-                 "%s/ejudge/%s/cpuacct.stat",
-                 cgroup_cpu_base_path, cgroup_name) >= sizeof(cpu_stat_path)) {
+                 "%s/cpuacct.stat", dir) >= sizeof(cpu_stat_path)) {
         goto fail;
     }
     if (!(f = fopen(cpu_stat_path, "r"))) {
@@ -1349,14 +1352,282 @@ fail:
     return;
 }
 
+// CPU usage of the cgroup at the moment it was claimed from the pool
+static struct CGroupStat cgroup_base_stat;
+
 static void
 read_cgroup_stats(struct CGroupStat *ps)
 {
+    char dir[PATH_MAX];
+
+    if (cgroup_v2_detected) {
+        if (snprintf(dir, sizeof(dir), "%s/ejudge/%s", cgroup_path, cgroup_name) >= sizeof(dir)) {
+            return;
+        }
+        read_cgroup_stats_v2(dir, ps);
+    } else {
+        if (snprintf(dir, sizeof(dir), "%s/ejudge/%s", cgroup_cpu_base_path, cgroup_name) >= sizeof(dir)) {
+            return;
+        }
+        read_cgroup_stats_v1(dir, ps);
+    }
+
+    // pooled cgroups keep accumulating usage between runs
+    ps->usage_us -= cgroup_base_stat.usage_us;
+    ps->user_us -= cgroup_base_stat.user_us;
+    ps->system_us -= cgroup_base_stat.system_us;
+    if (ps->usage_us < 0) ps->usage_us = 0;
+    if (ps->user_us < 0) ps->user_us = 0;
+    if (ps->system_us < 0) ps->system_us = 0;
+}
+
+static void
+write_buf_to_file_quiet(const char *path, const char *buf, int len)
+{
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) return;
+    if (write(fd, buf, len) != len) {
+        if (errno != ENOENT) flog("failed to write to %s: %s", path, strerror(errno));
+    }
+    close(fd);
+}
+
+/*
+ * returns the number of processes in the cgroup, or -1 if the cgroup
+ * cannot be inspected
+ */
+static int
+count_cgroup_procs(const char *dir)
+{
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s/cgroup.procs", dir) >= sizeof(path)) {
+        return -1;
+    }
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int count = 0;
+    char buf[64];
+    while (fgets(buf, sizeof(buf), f)) {
+        ++count;
+    }
+    fclose(f);
+    return count;
+}
+
+/*
+ * sends SIGKILL to all the processes of the cgroup, cgroup v1 has
+ * no cgroup.kill
+ */
+static void
+kill_cgroup_procs(const char *dir)
+{
+    char path[PATH_MAX];
+    if (!dir[0]) return;
+    if (snprintf(path, sizeof(path), "%s/cgroup.procs", dir) >= sizeof(path)) {
+        return;
+    }
+    FILE *f = fopen(path, "r");
+    if (!f) return;
+    char buf[64];
+    while (fgets(buf, sizeof(buf), f)) {
+        char *eptr = NULL;
+        errno = 0;
+        long pid = strtol(buf, &eptr, 10);
+        if (errno || eptr == buf || pid <= 1) continue;
+        kill((pid_t) pid, SIGKILL);
+    }
+    fclose(f);
+}
+
+/*
+ * checks that the pooled cgroup is in the same state as a freshly
+ * created one: no processes and no nested cgroups
+ */
+static int
+verify_pool_cgroup(const char *dir)
+{
+    if (!dir[0]) return 1;
+    if (count_cgroup_procs(dir) != 0) {
+        flog("pooled cgroup %s is not empty", dir);
+        return 0;
+    }
+    DIR *d = opendir(dir);
+    if (!d) {
+        flog("cannot open %s: %s", dir, strerror(errno));
+        return 0;
+    }
+    struct dirent *dd;
+    int nested = 0;
+    while ((dd = readdir(d))) {
+        if (dd->d_type == DT_DIR && strcmp(dd->d_name, ".") && strcmp(dd->d_name, "..")) {
+            nested = 1;
+        }
+    }
+    closedir(d);
+    if (nested) {
+        flog("pooled cgroup %s has nested cgroups", dir);
+        return 0;
+    }
+    return 1;
+}
+
+// drops the limits left by the previous run
+static void
+reset_pool_cgroup(void)
+{
+    char path[PATH_MAX];
+
+    if (cgroup_v2_detected) {
+        snprintf(path, sizeof(path), "%s/memory.swap.max", cgroup_unified_path);
+        write_buf_to_file_quiet(path, "max", 3);
+        snprintf(path, sizeof(path), "%s/memory.max", cgroup_unified_path);
+        write_buf_to_file_quiet(path, "max", 3);
+    } else {
+        // memsw limit may not be less than the memory limit
+        snprintf(path, sizeof(path), "%s/memory.memsw.limit_in_bytes", cgroup_memory_path);
+        write_buf_to_file_quiet(path, "-1", 2);
+        snprintf(path, sizeof(path), "%s/memory.limit_in_bytes", cgroup_memory_path);
+        write_buf_to_file_quiet(path, "-1", 2);
+        snprintf(path, sizeof(path), "%s/memory.max_usage_in_bytes", cgroup_memory_path);
+        write_buf_to_file_quiet(path, "0", 1);
+        snprintf(path, sizeof(path), "%s/cpuacct.usage", cgroup_cpu_path);
+        write_buf_to_file_quiet(path, "0", 1);
+    }
+}
+
+static int
+make_pool_cgroup_dir(char *path, size_t size, const char *base)
+{
+    if (snprintf(path, size, "%s/ejudge/%s", base, cgroup_name) >= size) {
+        ffatal("invalid cgroup path");
+    }
+    if (mkdir(path, 0700) < 0 && errno != EEXIST) {
+        flog("failed to create %s: %s", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * claims a free cgroup from the pool, returns 0 if all the cgroups
+ * are busy or dirty, then a fresh cgroup is created as usual
+ */
+static int
+claim_pool_cgroup(void)
+{
+    char path[PATH_MAX];
+
     if (cgroup_v2_detected) {
-        read_cgroup_stats_v2(ps);
+        int r;
+        if ((r = mkdir("/sys/fs/cgroup/ejudge", 0700)) < 0 && errno != EEXIST) {
+            ffatal("cannot create directory /sys/fs/cgroup/ejudge: %s", strerror(errno));
+        }
+        if (r >= 0) {
+            enable_controllers();
+        }
     } else {
-        read_cgroup_stats_v1(ps);
+        snprintf(path, sizeof(path), "%s/ejudge", cgroup_v1_cpu_default_path);
+        if (mkdir(path, 0700) < 0 && errno != EEXIST) {
+            ffatal("cannot create directory %s: %s", path, strerror(errno));
+        }
+        snprintf(path, sizeof(path), "%s/ejudge", cgroup_v1_memory_default_path);
+        if (mkdir(path, 0700) < 0 && errno != EEXIST) {
+            ffatal("cannot create directory %s: %s", path, strerror(errno));
+        }
+    }
+
+    for (int i = 0; i < container_pool_size; ++i) {
+        snprintf(cgroup_name, sizeof(cgroup_name), "pool-%d", i);
+        const char *lock_dir;
+        if (cgroup_v2_detected) {
+            if (make_pool_cgroup_dir(cgroup_unified_path, sizeof(cgroup_unified_path), "/sys/fs/cgroup") < 0) continue;
+            lock_dir = cgroup_unified_path;
+        } else {
+            if (make_pool_cgroup_dir(cgroup_cpu_path, sizeof(cgroup_cpu_path), cgroup_v1_cpu_default_path) < 0) continue;
+            if (make_pool_cgroup_dir(cgroup_memory_path, sizeof(cgroup_memory_path), cgroup_v1_memory_default_path) < 0) continue;
+            lock_dir = cgroup_cpu_path;
+        }
+        int fd = open(lock_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            flog("cannot open %s: %s", lock_dir, strerror(errno));
+            continue;
+        }
+        if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+            // used by another run
+            close(fd);
+            continue;
+        }
+        if (!verify_pool_cgroup(cgroup_unified_path)
+            || !verify_pool_cgroup(cgroup_cpu_path)
+            || !verify_pool_cgroup(cgroup_memory_path)) {
+            close(fd);
+            continue;
+        }
+        reset_pool_cgroup();
+        if (cgroup_v2_detected) {
+            read_cgroup_stats_v2(cgroup_unified_path, &cgroup_base_stat);
+        } else {
+            read_cgroup_stats_v1(cgroup_cpu_path, &cgroup_base_stat);
+        }
+        cgroup_pool_fd = fd;
+        return 1;
     }
+
+    cgroup_name[0] = 0;
+    cgroup_unified_path[0] = 0;
+    cgroup_cpu_path[0] = 0;
+    cgroup_memory_path[0] = 0;
+    return 0;
+}
+
+/*
+ * returns a pooled cgroup to the pool after verifying that nothing
+ * is left running in it, a fresh cgroup is just removed
+ */
+static void
+release_cgroup(void)
+{
+    if (cgroup_pool_fd < 0) {
+        if (cgroup_unified_path[0]) rmdir(cgroup_unified_path);
+        if (cgroup_cpu_path[0]) rmdir(cgroup_cpu_path);
+        if (cgroup_memory_path[0]) rmdir(cgroup_memory_path);
+        return;
+    }
+
+    if (cgroup_unified_path[0]) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/cgroup.kill", cgroup_unified_path);
+        write_buf_to_file_quiet(path, "1", 1);
+    }
+
+    // killed processes may take a while to leave the cgroup
+    int clean = 0;
+    for (int i = 0; i < 50; ++i) {
+        if (!cgroup_unified_path[0]) {
+            // the processes may still be forking, so kill them on each pass
+            kill_cgroup_procs(cgroup_cpu_path);
+            kill_cgroup_procs(cgroup_memory_path);
+        }
+        if (count_cgroup_procs(cgroup_unified_path[0]?cgroup_unified_path:cgroup_cpu_path) == 0
+            && (!cgroup_memory_path[0] || count_cgroup_procs(cgroup_memory_path) == 0)) {
+            clean = 1;
+            break;
+        }
+        usleep(10000);
+    }
+    if (!clean
+        || !verify_pool_cgroup(cgroup_unified_path)
+        || !verify_pool_cgroup(cgroup_cpu_path)
+        || !verify_pool_cgroup(cgroup_memory_path)) {
+        // remove it, so it is recreated by the next run, or skipped
+        // as long as it is populated
+        if (cgroup_unified_path[0]) rmdir(cgroup_unified_path);
+        if (cgroup_cpu_path[0]) rmdir(cgroup_cpu_path);
+        if (cgroup_memory_path[0]) rmdir(cgroup_memory_path);
+    }
+
+    close(cgroup_pool_fd);
+    cgroup_pool_fd = -1;
 }
 
 static struct sock_filter seccomp_filter_default[] =
@@ -2030,6 +2301,15 @@ main(int argc, char *argv[])
                 }
                 control_socket_fd = v;
                 opt = eptr;
+            } else if (*opt == 'p') {
+                char *eptr = NULL;
+                errno = 0;
+                long v = strtol(opt + 1, &eptr, 10);
+                if (errno || eptr == opt + 1 || v < 0 || v > 1024) {
+                    ffatal("invalid container pool size");
+                }
+                container_pool_size = v;
+                opt = eptr;
             } else if (*opt == 'c' && opt[1] == 'u') {
                 char *eptr = NULL;
                 errno = 0;
@@ -2143,7 +2423,9 @@ main(int argc, char *argv[])
     }
 
     if (enable_cgroup) {
-        create_cgroup();
+        if (container_pool_size <= 0 || !claim_pool_cgroup()) {
+            create_cgroup();
+        }
     }
 
     unsigned clone_flags = CLONE_CHILD_CLEARTID | CLONE_CHILD_SETTID | SIGCHLD;
@@ -2156,9 +2438,7 @@ main(int argc, char *argv[])
     int pid = syscall(__NR_clone, clone_flags, NULL, NULL, &tidptr);
     if (pid < 0) {
         change_ownership(primary_uid, primary_gid, slave_uid);
-        if (cgroup_unified_path[0]) rmdir(cgroup_unified_path);
-        if (cgroup_cpu_path[0]) rmdir(cgroup_cpu_path);
-        if (cgroup_memory_path[0]) rmdir(cgroup_memory_path);
+        release_cgroup();
         ffatal("clone failed: %s", strerror(errno));
     }
 
@@ -2652,9 +2932,7 @@ main(int argc, char *argv[])
     }
 
     change_ownership(primary_uid, primary_gid, slave_uid);
-    if (cgroup_unified_path[0]) rmdir(cgroup_unified_path);
-    if (cgroup_cpu_path[0]) rmdir(cgroup_cpu_path);
-    if (cgroup_memory_path[0]) rmdir(cgroup_memory_path);
+    release_cgroup();
 
     if (infop.si_code == CLD_EXITED) {
         if (infop.si_status == 0 || infop.si_status == 1) _exit(infop.si_status);
@@ -32,6 +32,9 @@
 #include "ejudge/ej_uuid.h"
 #include "ejudge/super_run_status.h"
 #include "ejudge/agent_client.h"
+#include "ejudge/spool_notify.h"
+#include "ejudge/test_data_cache.h"
+#include "ejudge/misctext.h"
 
 #include "ejudge/xalloc.h"
 #include "ejudge/osdeps.h"
@@ -95,6 +98,8 @@ static int ignore_rejudge = 0;
 
 static unsigned char **host_names = NULL;
 static unsigned char *mirror_dir = NULL;
+static unsigned char *test_cache_dir = NULL;
+static long long test_cache_size = 0;
 
 #define HEARTBEAT_SAVE_INTERVAL_MS 5000
 static long long last_heartbear_save_time = 0;
@@ -199,6 +204,11 @@ struct super_run_listener
 static void
 do_super_run_status_init(struct super_run_status *prs);
 
+// time the packets spent in the spool queue before testing
+static long long queue_wait_total_ms;
+static long long queue_wait_max_ms;
+static int queue_wait_count;
+
 static void
 super_run_before_tests(struct run_listener *gself, int test_no)
 {
@@ -420,6 +430,14 @@ handle_packet(
     reply_pkt.ts4 = srgp->ts4;
     reply_pkt.ts4_us = srgp->ts4_us;
     get_current_time(&reply_pkt.ts5, &reply_pkt.ts5_us);
+    if (srgp->ts4 > 0) {
+      long long wait_ms = ((long long) reply_pkt.ts5 - srgp->ts4) * 1000
+        + (reply_pkt.ts5_us - srgp->ts4_us) / 1000;
+      if (wait_ms < 0) wait_ms = 0;
+      queue_wait_total_ms += wait_ms;
+      if (wait_ms > queue_wait_max_ms) queue_wait_max_ms = wait_ms;
+      ++queue_wait_count;
+    }
     if (srgp->run_uuid && srgp->run_uuid[0]) {
       ej_uuid_parse(srgp->run_uuid, &reply_pkt.uuid);
     }
@@ -603,6 +621,9 @@ do_super_run_status_init(struct super_run_status *prs)
     prs->super_run_idx = super_run_status_add_str(prs, agent_instance_id);
   }
   prs->super_run_pid = getpid();
+  prs->queue_wait_total_ms = queue_wait_total_ms;
+  prs->queue_wait_max_ms = queue_wait_max_ms;
+  prs->queue_wait_count = queue_wait_count;
   prs->stop_pending = pending_stop_flag;
   prs->down_pending = pending_down_flag;
 }
@@ -639,6 +660,7 @@ do_loop(
   long long last_handled_ms = 0;
   long long current_time_ms = 0;
   struct Future *future = NULL;
+  struct spool_notify *queue_notify = NULL;
 
   if (agent_name && *agent_name) {
     if (!strncmp(agent_name, "ssh:", 4)) {
@@ -668,6 +690,11 @@ do_loop(
 
   if (global->sleep_time <= 0) global->sleep_time = 1000;
 
+  // wake up as soon as a packet is moved to the local spool
+  if (!agent) {
+    queue_notify = spool_notify_open(super_run_spool_path);
+  }
+
   /*
   if (state->global->cr_serialization_key > 0) {
     if (cr_serialize_init(state) < 0) {
@@ -739,7 +766,7 @@ do_loop(
 
       int sleep_time = agent?30000:global->sleep_time;
       interrupt_enable();
-      os_Sleep(sleep_time);
+      spool_notify_wait(queue_notify, sleep_time);
       interrupt_disable();
       continue;
     }
@@ -751,7 +778,7 @@ do_loop(
 
       int sleep_time = agent?30000:global->sleep_time;
       interrupt_enable();
-      os_Sleep(sleep_time);
+      spool_notify_wait(queue_notify, sleep_time);
       interrupt_disable();
       continue;
     }
@@ -772,6 +799,7 @@ do_loop(
 
   super_run_status_remove(agent, super_run_heartbeat_path, status_file_name);
 
+  spool_notify_close(queue_notify);
   if (agent) {
     agent->ops->close(agent);
   }
@@ -798,6 +826,8 @@ write_help(void)
          "    -p DIR       specify alternate name for super-run directory\n"
          "    -a           write log file to an alternate location\n"
          "    -m DIR       specify a directory for file mirroring\n"
+         "    -tc DIR      specify a directory for the test data cache\n"
+         "    -tcs SIZE    specify the size limit of the test data cache\n"
          "    -e DIR1=DIR2 remap directory DIR1 to directory DIR2\n"
          "    -ht TIMEOUT  machine halt timeout (in minutes)\n"
          "    -hc CMD      machine halt command\n"
@@ -1426,6 +1456,22 @@ main(int argc, char *argv[])
       argv_restart[argc_restart++] = argv[cur_arg];
       argv_restart[argc_restart++] = argv[cur_arg + 1];
       cur_arg += 2;
+    } else if (!strcmp(argv[cur_arg], "-tc")) {
+      if (cur_arg + 1 >= argc) fatal("argument expected for -tc");
+      xfree(test_cache_dir); test_cache_dir = NULL;
+      test_cache_dir = xstrdup(argv[cur_arg + 1]);
+      argv_restart[argc_restart++] = argv[cur_arg];
+      argv_restart[argc_restart++] = argv[cur_arg + 1];
+      cur_arg += 2;
+    } else if (!strcmp(argv[cur_arg], "-tcs")) {
+      if (cur_arg + 1 >= argc) fatal("argument expected for -tcs");
+      if (size_str_to_size64_t(argv[cur_arg + 1], &test_cache_size) < 0
+          || test_cache_size < 0) {
+        fatal("invalid value for -tcs");
+      }
+      argv_restart[argc_restart++] = argv[cur_arg];
+      argv_restart[argc_restart++] = argv[cur_arg + 1];
+      cur_arg += 2;
     } else if (!strcmp(argv[cur_arg], "-i")) {
       if (cur_arg + 1 >= argc) fatal("argument expected for -i");
       if (parse_ignored_problem(argv[cur_arg + 1], &ignored_problems[ignored_problems_count++]) < 0) {
@@ -1653,6 +1699,13 @@ main(int argc, char *argv[])
 
   make_super_run_name();
 
+  // the test files are read by the agent in the agent mode
+  struct test_data_cache_state *test_cache = NULL;
+  if (test_cache_dir && *test_cache_dir && (!agent_name || !*agent_name)) {
+    test_cache = test_data_cache_new(test_cache_dir, test_cache_size);
+    test_data_cache_set_default(test_cache);
+  }
+
   fprintf(stderr, "%s %s, compiled %s\n", program_name, compile_version, compile_date);
 
   if (do_loop(state, halt_timeout, &halt_requested) < 0) {
@@ -1666,6 +1719,8 @@ main(int argc, char *argv[])
 
   if (interrupt_restart_requested()) start_restart();
 
+  test_cache = test_data_cache_free(test_cache);
+
 cleanup:
   remove_working_directory(state);
   return retval;
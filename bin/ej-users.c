@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2002-2023 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2002-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -43,6 +43,7 @@
 #include "ejudge/bitset.h"
 #include "ejudge/sha256utils.h"
 #include "ejudge/userlist_bin.h"
+#include "ejudge/userlist_shm.h"
 #include "ejudge/ej_uuid.h"
 
 #include "ejudge/xalloc.h"
@@ -125,11 +126,26 @@ struct contest_extra
   struct userlist_table *tbl;
 };
 
+/* a user changed in a contest */
+struct user_change
+{
+  int user_id;
+  unsigned long long vintage;
+};
+
+/* the longest change log, after that the complete list is sent */
+enum { MAX_USER_CHANGES = 1024 };
+
 /* new extra information about contest */
 struct new_contest_extra
 {
   int id;
   struct observer_info *o_first, *o_last; /* list of observers */
+
+  unsigned long long full_vintage; /* the last change of all the users */
+  struct user_change *changes;     /* users changed since full_vintage */
+  int change_u, change_a;
+  unsigned long long snapshot_vintage; /* the published shared memory image */
 };
 
 struct client_state
@@ -359,6 +375,16 @@ detach_contest_extra(struct contest_extra *ex)
   return 0;
 }
 
+/* the change counter for all the contests, grows across restarts */
+static unsigned long long change_vintage;
+
+static unsigned long long
+next_change_vintage(void)
+{
+  if (!change_vintage) change_vintage = (unsigned long long) time(0) << 20;
+  return ++change_vintage;
+}
+
 static struct new_contest_extra *
 new_contest_extra_get(int contest_id)
 {
@@ -380,6 +406,8 @@ new_contest_extra_get(int contest_id)
   if (!(p = new_contest_extras[contest_id])) {
     XCALLOC(p, 1);
     p->id = contest_id;
+    // the changes before this point are not known
+    p->full_vintage = next_change_vintage();
     new_contest_extras[contest_id] = p;
   }
   return new_contest_extras[contest_id];
@@ -490,13 +518,39 @@ old_update_userlist_table(int cnts_id)
   ntb->vintage++;
 }
 
+/* user_id == 0 means that all the users might have changed */
 static void
-new_update_userlist_table(int cnts_id)
+record_user_change(struct new_contest_extra *ne, int user_id)
+{
+  if (user_id <= 0 || ne->change_u >= MAX_USER_CHANGES) {
+    ne->full_vintage = next_change_vintage();
+    ne->change_u = 0;
+    return;
+  }
+  if (ne->change_u == ne->change_a) {
+    if (!(ne->change_a *= 2)) ne->change_a = 32;
+    XREALLOC(ne->changes, ne->change_a);
+  }
+  ne->changes[ne->change_u].user_id = user_id;
+  ne->changes[ne->change_u].vintage = next_change_vintage();
+  ++ne->change_u;
+}
+
+static unsigned long long
+last_change_vintage(const struct new_contest_extra *ne)
+{
+  if (ne->change_u > 0) return ne->changes[ne->change_u - 1].vintage;
+  return ne->full_vintage;
+}
+
+static void
+new_update_userlist_table(int cnts_id, int user_id)
 {
   struct new_contest_extra *ne;
   struct observer_info *p;
 
   if (!(ne = new_contest_extra_try(cnts_id))) return;
+  record_user_change(ne, user_id);
   for (p = ne->o_first; p; p = p->cnts_next) {
     if (!p->changed) {
       p->changed = 1;
@@ -506,7 +560,7 @@ new_update_userlist_table(int cnts_id)
 }
 
 static void
-update_userlist_table(int cnts_id)
+update_userlist_user(int cnts_id, int user_id)
 {
   int i;
   const struct contest_desc *cnts;
@@ -514,7 +568,7 @@ update_userlist_table(int cnts_id)
   if (cnts_id <= 0) return;
 
   old_update_userlist_table(cnts_id);
-  new_update_userlist_table(cnts_id);
+  new_update_userlist_table(cnts_id, user_id);
 
   for (i = 1; i < new_contest_extras_size; ++i) {
     if (cnts_id == i || !new_contest_extras[i]) continue;
@@ -522,11 +576,28 @@ update_userlist_table(int cnts_id)
     if (contests_get(i, &cnts) < 0 || !cnts) continue;
     if (cnts->user_contest_num == cnts_id) {
       old_update_userlist_table(i);
-      new_update_userlist_table(i);
+      new_update_userlist_table(i, user_id);
     }
   }
 }
 
+static void
+update_userlist_table(int cnts_id)
+{
+  update_userlist_user(cnts_id, 0);
+}
+
+/* the changed users are not known */
+static void
+update_all_contests(void)
+{
+  int i;
+
+  for (i = 1; i < new_contest_extras_size; ++i) {
+    if (new_contest_extras[i]) update_userlist_table(i);
+  }
+}
+
 static void
 link_client_state(struct client_state *p)
 {
@@ -625,7 +696,19 @@ update_all_user_contests(int user_id)
        iter->has_next(iter);
        iter->next(iter)) {
     c = (const struct userlist_contest *) iter->get(iter);
-    update_userlist_table(c->id);
+    update_userlist_user(c->id, user_id);
+  }
+}
+
+/* the contest 0 information is used for all the contests without
+   their own information */
+static void
+update_user_info_contests(int contest_id, int user_id)
+{
+  if (contest_id > 0) {
+    update_userlist_user(contest_id, user_id);
+  } else {
+    update_all_user_contests(user_id);
   }
 }
 
@@ -848,6 +931,7 @@ graceful_exit(void)
 {
   if (config && config->socket_path) {
     unlink(config->socket_path);
+    userlist_shm_remove_all(config->socket_path);
   }
   if (listen_socket >= 0) close(listen_socket);
   cleanup_clients();
@@ -1151,6 +1235,19 @@ check_pk_map_contest(
   return 0;
 }
 
+static int
+check_pk_standings_delta(
+        struct client_state *p,
+        int pkt_len,
+        struct userlist_pk_standings_delta *data)
+{
+  if (pkt_len != sizeof(*data)) {
+    CONN_BAD("packet length mismatch");
+    return -1;
+  }
+  return 0;
+}
+
 static int
 check_pk_edit_field(
         struct client_state *p,
@@ -2618,6 +2715,7 @@ cmd_recover_password_2(struct client_state *p,
   default_remove_user_cookies(user_id);
   default_set_reg_passwd(user_id, USERLIST_PWD_PLAIN, passwd_buf, cur_time);
   default_set_simple_reg(user_id, 0, cur_time);
+  update_all_user_contests(user_id);
 
   // generate a e-mail message
   msg_f = open_memstream(&msg_text, &msg_size);
@@ -2711,7 +2809,7 @@ do_remove_user(const struct userlist_user *u)
        iter->next(iter)) {
     reg = (struct userlist_contest*) iter->get(iter);
     if (reg->status == USERLIST_REG_OK)
-      update_userlist_table(reg->id);
+      update_userlist_user(reg->id, u->id);
   }
 
   //remove_from_system_uid_map(u->id);
@@ -5177,6 +5275,165 @@ cmd_list_standings_users_2(
   info("%s -> OK, size = %u, time = %llu", logbuf, (unsigned) header->pkt_size, (ms2 - ms1));
 }
 
+static int
+int_sort_func(const void *p1, const void *p2)
+{
+  int v1 = *(const int *) p1, v2 = *(const int *) p2;
+  return (v1 > v2) - (v1 < v2);
+}
+
+/* set if the images cannot be published */
+static int snapshot_disabled;
+
+/* removes the published images of the contests which do not exist */
+static void
+remove_stale_snapshots(void)
+{
+  const struct contest_desc *cnts = 0;
+
+  for (size_t i = 1; i < new_contest_extras_size; ++i) {
+    struct new_contest_extra *ne = new_contest_extras[i];
+    if (!ne || !ne->snapshot_vintage) continue;
+    if (contests_get(i, &cnts) >= 0) continue;
+    userlist_shm_remove(config->socket_path, i);
+    ne->snapshot_vintage = 0;
+  }
+}
+
+/* the reply without data, the client maps the published image */
+static void
+reply_standings_snapshot(
+        struct client_state *p,
+        int contest_id,
+        unsigned long long vintage)
+{
+  unsigned char *msg = xcalloc(sizeof(UserlistBinaryHeader) + 4, 1);
+  UserlistBinaryHeader *header = (UserlistBinaryHeader *) (msg + 4);
+
+  header->reply_id = ULS_BIN_DATA;
+  header->endianness = 1;
+  header->ptr_size = sizeof(void*);
+  header->pkt_size = sizeof(*header);
+  header->version = USERLIST_BIN_VERSION;
+  header->contest_id = contest_id;
+  header->flags = USERLIST_BIN_SNAPSHOT;
+  header->vintage = vintage;
+  enqueue_reply_to_client_2(p, header->pkt_size, msg);
+}
+
+/*
+ * like LIST_STANDINGS_USERS_2, but if the client's copy has the vintage
+ * still covered by the change log only the users changed since then
+ * are sent, and the users which are not registered any more.
+ * If the client accepts, the complete list is published in shared memory
+ * once for all the clients until the users of the contest change.
+ */
+static void
+cmd_list_standings_users_3(
+        struct client_state *p,
+        int pkt_len,
+        struct userlist_pk_standings_delta *data)
+{
+  const struct contest_desc *cnts = 0;
+  unsigned char logbuf[1024];
+  ptr_iterator_t iter;
+  const struct userlist_user *u;
+  UserlistBinaryContext cntx;
+  struct timeval ts1, ts2;
+  struct new_contest_extra *ne;
+  int delta_mode = 0, user_count = 0;
+  int *user_ids = NULL;
+
+  snprintf(logbuf, sizeof(logbuf), "PRIV_STANDINGS_USERS_3: %d, %d, %llu",
+           p->user_id, data->contest_id, data->vintage);
+
+  gettimeofday(&ts1, NULL);
+
+  if (is_admin(p, logbuf) < 0) return;
+  if (full_get_contest(p, logbuf, &data->contest_id, &cnts) < 0) return;
+  if (is_cnts_capable(p, cnts, OPCAP_MAP_CONTEST, logbuf) < 0) return;
+
+  ne = new_contest_extra_get(data->contest_id);
+  if (data->vintage > 0 && data->vintage >= ne->full_vintage
+      && data->vintage <= change_vintage) {
+    delta_mode = 1;
+    XCALLOC(user_ids, ne->change_u + 1);
+    for (int i = ne->change_u - 1; i >= 0 && ne->changes[i].vintage > data->vintage; --i) {
+      user_ids[user_count++] = ne->changes[i].user_id;
+    }
+    qsort(user_ids, user_count, sizeof(user_ids[0]), int_sort_func);
+  }
+  if (!delta_mode && (data->flags & ULS_DELTA_ACCEPT_SNAPSHOT)
+      && !snapshot_disabled && ne->snapshot_vintage > 0
+      && ne->snapshot_vintage >= last_change_vintage(ne)) {
+    reply_standings_snapshot(p, data->contest_id, ne->snapshot_vintage);
+    info("%s -> OK, snapshot %llu", logbuf, ne->snapshot_vintage);
+    return;
+  }
+
+  userlist_bin_init_context(&cntx);
+  userlist_bin_marshall_user_list(&cntx, NULL, data->contest_id);
+  if (delta_mode) {
+    for (int i = 0; i < user_count; ++i) {
+      if (i > 0 && user_ids[i] == user_ids[i - 1]) continue;
+      const struct userlist_contest *reg = default_get_contest_reg(user_ids[i], data->contest_id);
+      u = NULL;
+      if (reg && reg->status == USERLIST_REG_OK
+          && default_get_user_info_4(user_ids[i], data->contest_id, &u) >= 0 && u) {
+        userlist_bin_marshall_user(&cntx, u, data->contest_id);
+      } else {
+        userlist_bin_marshall_removed(&cntx, user_ids[i]);
+      }
+      if (u) default_unlock_user(u);
+    }
+  } else {
+    for (iter = default_get_standings_list_iterator(data->contest_id);
+         iter->has_next(iter);
+         iter->next(iter)) {
+      u = (const struct userlist_user*) iter->get(iter);
+      userlist_bin_marshall_user(&cntx, u, data->contest_id);
+      default_unlock_user(u);
+    }
+    iter->destroy(iter);
+  }
+  userlist_bin_finish_context(&cntx);
+  xfree(user_ids);
+
+  unsigned char *msg = xmalloc(cntx.total_size + 4);
+  UserlistBinaryHeader *header = userlist_bin_marshall(msg + 4, &cntx, data->contest_id);
+  header->reply_id = ULS_BIN_DATA;
+  header->vintage = change_vintage;
+  if (delta_mode) {
+    header->flags |= USERLIST_BIN_DELTA;
+    header->base_vintage = data->vintage;
+  }
+  userlist_bin_destroy_context(&cntx);
+
+  if (!delta_mode && (data->flags & ULS_DELTA_ACCEPT_SNAPSHOT)
+      && !snapshot_disabled) {
+    if (userlist_shm_publish(config->socket_path, header) >= 0) {
+      ne->snapshot_vintage = header->vintage;
+      xfree(msg);
+      reply_standings_snapshot(p, data->contest_id, ne->snapshot_vintage);
+      info("%s -> OK, published snapshot %llu", logbuf, ne->snapshot_vintage);
+      return;
+    }
+    err("%s: shared memory images are disabled", logbuf);
+    snapshot_disabled = 1;
+  }
+
+  gettimeofday(&ts2, NULL);
+
+  unsigned long long ms1 = ts1.tv_sec * 1000000ULL;
+  ms1 += ts1.tv_usec;
+  unsigned long long ms2 = ts2.tv_sec * 1000000ULL;
+  ms2 += ts2.tv_usec;
+
+  enqueue_reply_to_client_2(p, header->pkt_size, msg);
+  info("%s -> OK, %s, size = %u, time = %llu", logbuf, delta_mode?"delta":"full",
+       (unsigned) header->pkt_size, (ms2 - ms1));
+}
+
 static void
 cmd_get_user_contests(struct client_state *p,
                       int pkt_len,
@@ -5395,6 +5652,7 @@ cmd_set_passwd(
   passwd_convert(&newint, newint.pwd_nows, NULL, USERLIST_PWD_SHA256);
   default_set_reg_passwd(u->id, USERLIST_PWD_SHA256, newint.encoded, cur_time);
   default_remove_user_cookies(u->id);
+  update_all_user_contests(u->id);
   send_reply(p, ULS_OK);
   info("%s -> OK", logbuf);
 }
@@ -5494,6 +5752,7 @@ cmd_team_set_passwd(
                           &cloned_flag);
   if (cloned_flag) reply_code = ULS_CLONED;
   default_remove_user_cookies(u->id);
+  update_userlist_user(data->contest_id, u->id);
   send_reply(p, reply_code);
   info("%s -> OK", logbuf);
 }
@@ -5558,7 +5817,7 @@ cmd_register_contest(
 
   default_check_user_reg_data(data->user_id, data->contest_id);
   if (r->status == USERLIST_REG_OK) {
-    update_userlist_table(data->contest_id);
+    update_userlist_user(data->contest_id, data->user_id);
   }
   info("%s -> OK", logbuf);
   send_reply(p, ULS_OK);
@@ -5632,7 +5891,7 @@ cmd_register_contest_2(
 
   default_check_user_reg_data(data->user_id, data->contest_id);
   r = default_get_contest_reg(data->user_id, data->contest_id);
-  update_userlist_table(data->contest_id);
+  update_userlist_user(data->contest_id, data->user_id);
   info("%s -> OK", logbuf);
   send_reply(p, ULS_OK);
   return;
@@ -5681,7 +5940,7 @@ cmd_priv_register_contest(
   }
 
   if (r && r->status == USERLIST_REG_OK) {
-    update_userlist_table(data->contest_id);
+    update_userlist_user(data->contest_id, data->user_id);
   }
   info("%s -> OK", logbuf);
   send_reply(p, ULS_OK);
@@ -5736,7 +5995,7 @@ cmd_delete_member(struct client_state *p, int pkt_len,
     return send_reply(p, -ULS_ERR_UNSPECIFIED_ERROR);
   }
 
-  update_userlist_table(data->contest_id);
+  update_user_info_contests(data->contest_id, data->user_id);
   if (cloned_flag) reply_code = ULS_CLONED;
   info("%s -> OK", logbuf);
   send_reply(p, reply_code);
@@ -6813,6 +7072,7 @@ do_generate_passwd(int contest_id, FILE *log)
     memset(buf, 0, sizeof(buf));
     generate_random_password(8, buf);
     default_set_reg_passwd(u->id, USERLIST_PWD_PLAIN, buf, cur_time);
+    update_all_user_contests(u->id);
 
   // html table header
     fprintf(log, "<tr><td><b>User ID</b></td><td><b>User Login</b></td><td><b>User Name</b></td><td><b>New User Login Password</b></td><td><b>Location</b></td></tr>\n");
@@ -6860,6 +7120,7 @@ cmd_generate_register_passwords(
   }
   do_generate_passwd(data->contest_id, f);
   close_memstream(f); f = 0;
+  update_userlist_table(data->contest_id);
 
   q = (struct client_state*) xcalloc(1, sizeof(*q));
   q->client_fds[0] = -1;
@@ -6932,6 +7193,7 @@ cmd_generate_register_passwords_2(
     memset(buf, 0, sizeof(buf));
     generate_random_password(8, buf);
     default_set_reg_passwd(u->id, USERLIST_PWD_PLAIN, buf, cur_time);
+    update_all_user_contests(u->id);
   }
   update_userlist_table(data->contest_id);
   info("%s -> OK", logbuf);
@@ -7080,6 +7342,7 @@ cmd_generate_team_passwords(
   }
   do_generate_team_passwd(data->contest_id, f);
   close_memstream(f); f = 0;
+  update_userlist_table(data->contest_id);
 
   q = (struct client_state*) xcalloc(1, sizeof(*q));
   q->client_fds[0] = -1;
@@ -7151,6 +7414,7 @@ cmd_clear_team_passwords(
   if (full_get_contest(p, logbuf, &data->contest_id, &cnts) < 0) return;
 
   do_clear_team_passwords(data->contest_id);
+  update_userlist_table(data->contest_id);
   info("%s -> OK", logbuf);
   send_reply(p, ULS_OK);
 }
@@ -7263,7 +7527,7 @@ cmd_edit_registration(struct client_state *p, int pkt_len,
     if (!(data->new_flags & USERLIST_UC_PRIVILEGED) && !(data->new_flags & USERLIST_UC_INCOMPLETE))
       default_check_user_reg_data(data->user_id, data->contest_id);
   }
-  update_userlist_table(data->contest_id);
+  update_userlist_user(data->contest_id, data->user_id);
   info("%s -> OK", logbuf);
   send_reply(p, ULS_OK);
 }
@@ -7358,7 +7622,7 @@ cmd_priv_delete_member(struct client_state *p, int pkt_len,
   }
   default_check_user_reg_data(data->user_id, data->contest_id);
   if (r == 1) {
-    update_userlist_table(data->contest_id);
+    update_user_info_contests(data->contest_id, data->user_id);
   }
   if (cloned_flag) reply_code = ULS_CLONED;
   send_reply(p, reply_code);
@@ -7455,7 +7719,7 @@ cmd_delete_user_info(struct client_state *p, int pkt_len,
   if (is_dbcnts_capable(p, cnts, capbit, logbuf) < 0) return;
 
   if ((r=default_remove_user_contest_info(data->user_id, data->contest_id))== 1)
-    update_userlist_table(data->contest_id);
+    update_user_info_contests(data->contest_id, data->user_id);
   default_check_user_reg_data(data->user_id, data->contest_id);
   send_reply(p, ULS_OK);
   info("%s -> OK, %d", logbuf, r);
@@ -7540,7 +7804,7 @@ cmd_delete_field(
       send_reply(p, -ULS_ERR_CANNOT_DELETE);
       return;
     }
-    update_userlist_table(data->contest_id);
+    update_user_info_contests(data->contest_id, data->user_id);
     goto done;
   }
 
@@ -7563,6 +7827,7 @@ cmd_delete_field(
     send_reply(p, -ULS_ERR_CANNOT_DELETE);
     return;
   }
+  update_user_info_contests(data->contest_id, data->user_id);
 
  done:
   default_check_user_reg_data(data->user_id, data->contest_id);
@@ -7631,8 +7896,8 @@ cmd_edit_field(
                                          data->field, data->data, cur_time,
                                          &cloned_flag))<0)
       goto cannot_change;
-    if (r > 0 && data->contest_id > 0)
-      update_userlist_table(data->contest_id);
+    if (r > 0)
+      update_user_info_contests(data->contest_id, data->user_id);
     goto done;
   }
 
@@ -7642,8 +7907,8 @@ cmd_edit_field(
                                            data->data, cur_time,
                                            &cloned_flag)) < 0)
       goto cannot_change;
-    if (r > 0 && data->contest_id > 0)
-      update_userlist_table(data->contest_id);
+    if (r > 0)
+      update_user_info_contests(data->contest_id, data->user_id);
     goto done;
   }
 
@@ -7774,6 +8039,7 @@ cmd_create_member(
     return;
   }
   default_check_user_reg_data(data->user_id, data->contest_id);
+  update_user_info_contests(data->contest_id, data->user_id);
 
   info("%s -> new member %d", logbuf, m);
   memset(&out, 0, sizeof(out));
@@ -8045,6 +8311,7 @@ cmd_user_op(
     return;
   }
 
+  update_all_user_contests(data->user_id);
   if (cloned_flag) reply_code = ULS_CLONED;
   info("%s -> OK", logbuf);
   send_reply(p, reply_code);
@@ -8106,6 +8373,7 @@ cmd_copy_user_info(
                          copy_passwd_flag, cur_time, cnts2);
 
   default_check_user_reg_data(data->user_id, data->contest_id);
+  update_userlist_user(data->serial, data->user_id);
   info("%s -> OK", logbuf);
   send_reply(p, reply_code);
   return;
@@ -8653,6 +8921,7 @@ cmd_priv_set_passwd(
   }
 
   default_remove_user_cookies(data->user_id);
+  update_all_user_contests(data->user_id);
   send_reply(p, reply_code);
   info("%s -> OK, %d", logbuf, cloned_flag);
 }
@@ -8795,6 +9064,7 @@ cmd_priv_set_passwd_2(
   }
 
   default_remove_user_cookies(data->user_id);
+  update_all_user_contests(data->user_id);
   send_reply(p, reply_code);
   info("%s -> OK, %d", logbuf, cloned_flag);
 }
@@ -9291,13 +9561,16 @@ cmd_edit_field_seq(
 
  done:
   default_check_user_reg_data(data->user_id, data->contest_id);
+  update_user_info_contests(data->contest_id, data->user_id);
   if (cloned_flag) reply_code = ULS_CLONED;
   send_reply(p, reply_code);
   info("%s -> OK", logbuf);
   return;
 
  cannot_change:
+  // some of the fields might have been changed
   default_check_user_reg_data(data->user_id, data->contest_id);
+  update_user_info_contests(data->contest_id, data->user_id);
   err("%s -> the fields cannot be changed", logbuf);
   send_reply(p, -ULS_ERR_CANNOT_CHANGE);
   return;
@@ -9354,7 +9627,7 @@ cmd_move_member(struct client_state *p, int pkt_len,
   }
   default_check_user_reg_data(data->user_id, data->contest_id);
   if (r == 1) {
-    update_userlist_table(data->contest_id);
+    update_user_info_contests(data->contest_id, data->user_id);
   }
   if (cloned_flag) reply_code = ULS_CLONED;
   send_reply(p, reply_code);
@@ -9583,6 +9856,8 @@ cmd_import_csv_users(
   // set the fields
   for (i = 1; i < csv->u; i++) {
     user_id = user_ids[i];
+    // recorded in advance, as the loop might stop in the middle of the user
+    update_all_user_contests(user_id);
     u = 0; ui = 0;
     if (default_get_user_info_7(user_id, data->contest_id, &u, &ui, &mm) < 0
         || !u)
@@ -10412,6 +10687,8 @@ cmd_create_user_2(
       return;
     }
   }
+  // the further changes are done before the next request is served
+  update_all_user_contests(user_id);
 
   if (cnts && !cnts->disable_team_password) {
     if (data->cnts_use_reg_passwd_flag) {
@@ -11383,6 +11660,7 @@ static void (*cmd_table[])() =
   [ULS_GET_API_KEYS_FOR_USER] = cmd_get_api_keys_for_user,
   [ULS_DELETE_API_KEY] =        cmd_delete_api_key,
   [ULS_PRIV_CREATE_COOKIE] =    cmd_priv_create_cookie,
+  [ULS_LIST_STANDINGS_USERS_3] =cmd_list_standings_users_3,
 
   [ULS_LAST_CMD] = 0
 };
@@ -11495,6 +11773,7 @@ static int (*check_table[])() =
   [ULS_GET_API_KEYS_FOR_USER] = check_pk_api_key_data,
   [ULS_DELETE_API_KEY] =        check_pk_api_key_data,
   [ULS_PRIV_CREATE_COOKIE] =    NULL,
+  [ULS_LIST_STANDINGS_USERS_3] =check_pk_standings_delta,
 
   [ULS_LAST_CMD] = 0
 };
@@ -11592,6 +11871,8 @@ do_work(void)
     return 1;
   }
   socket_name = config->socket_path;
+  // the images left by the previous run
+  userlist_shm_remove_all(config->socket_path);
 
   if (chmod(config->socket_path, 0777) < 0) {
     err("chmod() failed: %s", os_ErrorMsg());
@@ -11629,7 +11910,17 @@ do_work(void)
 
     // check for user account expiration
     if (cur_time > last_user_check + user_check_interval) {
+      long long count1 = -1, count2 = -1;
+      if (plugin_func(get_user_count)) {
+        default_get_user_count(0, 0, NULL, 0, 0, 0, &count1);
+      }
       default_remove_expired_users(cur_time - 24 * 60 * 60);
+      // the removed users might still be registered somewhere
+      if (count1 >= 0) {
+        default_get_user_count(0, 0, NULL, 0, 0, 0, &count2);
+      }
+      if (count1 < 0 || count1 != count2) update_all_contests();
+      remove_stale_snapshots();
       last_user_check = cur_time;
       user_check_interval = DEFAULT_USER_CHECK_INTERVAL;
     }
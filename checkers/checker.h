@@ -23,6 +23,10 @@
 #ifndef NEED_TGZ
 #define NEED_TGZ 0
 #endif /* NEED_TGZ */
+/* define NEED_SERVER to 1 to support the persistent checker mode */
+#ifndef NEED_SERVER
+#define NEED_SERVER 0
+#endif /* NEED_SERVER */
 
 #include "checker_internal.h"
 
@@ -55,7 +59,11 @@ main(int argc, char **argv)
   testinfo_strerror_func = testinfo_strerror;
 #endif
 
+#if NEED_SERVER == 1
+  return checker_server_main(argc, argv, checker_main, NEED_CORR, NEED_INFO, NEED_TGZ);
+#else
   checker_do_init(argc, argv, NEED_CORR, NEED_INFO, NEED_TGZ);
   return checker_main(argc, argv);
+#endif
 }
 #endif
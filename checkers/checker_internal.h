@@ -412,6 +412,15 @@ checker_stoull(const char *str, int base, unsigned long long *p_value);
 int
 checker_open_control_fd(void);
 
+int
+checker_server_main(
+        int argc,
+        char **argv,
+        int (*main_func)(int, char **),
+        int corr_flag,
+        int info_flag,
+        int tgz_flag);
+
 int
 checker_kill_2(int socket_fd, int signal);
 
@@ -0,0 +1,269 @@
+/* -*- mode: c -*- */
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "checker_internal.h"
+
+#if !defined __MINGW32__
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/*
+ * Persistent checker mode. The request consists of lines
+ *   a ARG      - the next command line argument
+ *   e VAR=VAL  - an environment variable
+ *   d DIR      - the working directory
+ *   o FILE     - the standard output, truncated
+ *   O FILE     - the standard output, appended
+ *   E FILE     - the standard error, appended, by default the same
+ *                as the standard output
+ *   t MS       - the CPU time limit
+ * terminated with an empty line. Each test is checked in a forked
+ * process, so the checker may exit as usual. The reply is
+ * "x CODE CPU_MS" or "s SIGNAL CPU_MS".
+ */
+
+struct server_request
+{
+  char **argv;
+  int argc, arga;
+  char *dir;
+  char *out_path;
+  int out_append;
+  char *err_path;
+  int time_limit_ms;
+  char **envs;
+  int envu, enva;
+};
+
+static void
+free_request(struct server_request *req)
+{
+  for (int i = 1; i < req->argc; ++i) free(req->argv[i]);
+  free(req->argv);
+  for (int i = 0; i < req->envu; ++i) free(req->envs[i]);
+  free(req->envs);
+  free(req->dir);
+  free(req->out_path);
+  free(req->err_path);
+  memset(req, 0, sizeof(*req));
+}
+
+static void
+add_arg(struct server_request *req, char *arg)
+{
+  if (req->argc + 1 >= req->arga) {
+    if (!(req->arga *= 2)) req->arga = 16;
+    XREALLOC(req->argv, req->arga);
+  }
+  req->argv[req->argc++] = arg;
+  req->argv[req->argc] = NULL;
+}
+
+static void
+add_env(struct server_request *req, char *env)
+{
+  if (req->envu == req->enva) {
+    if (!(req->enva *= 2)) req->enva = 16;
+    XREALLOC(req->envs, req->enva);
+  }
+  req->envs[req->envu++] = env;
+}
+
+/* returns 1 if a request is read, 0 on EOF */
+static int
+read_request(FILE *f, char *argv0, struct server_request *req)
+{
+  char *line = NULL;
+  size_t linez = 0;
+  ssize_t len;
+
+  add_arg(req, argv0);
+  while ((len = getline(&line, &linez, f)) > 0) {
+    if (line[len - 1] == '\n') line[--len] = 0;
+    if (!len) {
+      free(line);
+      return 1;
+    }
+    if (len < 2 || line[1] != ' ') {
+      fatal_CF("invalid checker server request '%s'", line);
+    }
+    char *val = line + 2;
+    switch (line[0]) {
+    case 'a':
+      add_arg(req, xstrdup(val));
+      break;
+    case 'e':
+      add_env(req, xstrdup(val));
+      break;
+    case 'd':
+      free(req->dir);
+      req->dir = xstrdup(val);
+      break;
+    case 'o':
+    case 'O':
+      free(req->out_path);
+      req->out_path = xstrdup(val);
+      req->out_append = (line[0] == 'O');
+      break;
+    case 'E':
+      free(req->err_path);
+      req->err_path = xstrdup(val);
+      break;
+    case 't':
+      req->time_limit_ms = strtol(val, NULL, 10);
+      break;
+    default:
+      fatal_CF("invalid checker server request '%s'", line);
+    }
+  }
+  free(line);
+  return 0;
+}
+
+static void
+redirect_fd(int fd, const char *path, int flags)
+{
+  int tfd = open(path, O_WRONLY | O_CREAT | flags, 0600);
+  if (tfd < 0) {
+    fprintf(stderr, "cannot open '%s': %s\n", path, strerror(errno));
+    _exit(RUN_CHECK_FAILED);
+  }
+  if (tfd != fd) {
+    dup2(tfd, fd);
+    close(tfd);
+  }
+}
+
+static void
+run_request(
+        int sock_fd,
+        const struct server_request *req,
+        int (*main_func)(int, char **),
+        int corr_flag,
+        int info_flag,
+        int tgz_flag)
+{
+  close(sock_fd);
+  unsetenv("EJUDGE_CHECKER_SERVER_FD");
+  if (req->out_path) {
+    redirect_fd(1, req->out_path, req->out_append?O_APPEND:O_TRUNC);
+  }
+  if (req->err_path) {
+    redirect_fd(2, req->err_path, O_APPEND);
+  } else {
+    dup2(1, 2);
+  }
+  if (req->dir && chdir(req->dir) < 0) {
+    fatal_CF("cannot change directory to '%s': %s", req->dir, strerror(errno));
+  }
+  for (int i = 0; i < req->envu; ++i) {
+    putenv(req->envs[i]);
+  }
+  if (req->time_limit_ms > 0) {
+    struct rlimit rl;
+    rl.rlim_cur = (req->time_limit_ms + 999) / 1000;
+    rl.rlim_max = rl.rlim_cur + 1;
+    setrlimit(RLIMIT_CPU, &rl);
+  }
+  checker_do_init(req->argc, req->argv, corr_flag, info_flag, tgz_flag);
+  exit(main_func(req->argc, req->argv));
+}
+
+static int
+serve(
+        int sock_fd,
+        char *argv0,
+        int (*main_func)(int, char **),
+        int corr_flag,
+        int info_flag,
+        int tgz_flag)
+{
+  FILE *f = fdopen(sock_fd, "r");
+  if (!f) fatal_CF("fdopen failed: %s", strerror(errno));
+
+  signal(SIGPIPE, SIG_IGN);
+  if (write(sock_fd, "ready\n", 6) != 6) return 0;
+
+  while (1) {
+    struct server_request req;
+    memset(&req, 0, sizeof(req));
+    if (!read_request(f, argv0, &req)) break;
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) fatal_CF("fork failed: %s", strerror(errno));
+    if (!pid) {
+      run_request(sock_fd, &req, main_func, corr_flag, info_flag, tgz_flag);
+    }
+    free_request(&req);
+
+    int status = 0;
+    struct rusage ru;
+    memset(&ru, 0, sizeof(ru));
+    while (wait4(pid, &status, 0, &ru) < 0) {
+      if (errno != EINTR) fatal_CF("wait4 failed: %s", strerror(errno));
+    }
+    long cpu_ms = ru.ru_utime.tv_sec * 1000L + ru.ru_utime.tv_usec / 1000
+      + ru.ru_stime.tv_sec * 1000L + ru.ru_stime.tv_usec / 1000;
+    char reply[128];
+    int len;
+    if (WIFSIGNALED(status)) {
+      len = snprintf(reply, sizeof(reply), "s %d %ld\n", WTERMSIG(status), cpu_ms);
+    } else {
+      len = snprintf(reply, sizeof(reply), "x %d %ld\n", WEXITSTATUS(status), cpu_ms);
+    }
+    if (write(sock_fd, reply, len) != len) break;
+  }
+  fclose(f);
+  return 0;
+}
+#endif /* __MINGW32__ */
+
+int
+checker_server_main(
+        int argc,
+        char **argv,
+        int (*main_func)(int, char **),
+        int corr_flag,
+        int info_flag,
+        int tgz_flag)
+{
+#if !defined __MINGW32__
+  const char *s = getenv("EJUDGE_CHECKER_SERVER_FD");
+  if (s && *s) {
+    char *eptr = NULL;
+    errno = 0;
+    long v = strtol(s, &eptr, 10);
+    if (errno || *eptr || eptr == s || (int) v != v || v < 0) {
+      fatal_CF("EJUDGE_CHECKER_SERVER_FD value '%s' is invalid", s);
+    }
+    fcntl(v, F_SETFD, FD_CLOEXEC);
+    return serve(v, argv[0], main_func, corr_flag, info_flag, tgz_flag);
+  }
+#endif
+
+  // started in the usual way
+  checker_do_init(argc, argv, corr_flag, info_flag, tgz_flag);
+  return main_func(argc, argv);
+}
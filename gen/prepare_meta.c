@@ -443,6 +443,7 @@ static struct meta_info_item meta_info_section_problem_data_data[] =
   [CNTSPROB_enable_extended_info] = { CNTSPROB_enable_extended_info, 'f', XSIZE(struct section_problem_data, enable_extended_info), "enable_extended_info", XOFFSET(struct section_problem_data, enable_extended_info) },
   [CNTSPROB_stop_on_first_fail] = { CNTSPROB_stop_on_first_fail, 'f', XSIZE(struct section_problem_data, stop_on_first_fail), "stop_on_first_fail", XOFFSET(struct section_problem_data, stop_on_first_fail) },
   [CNTSPROB_enable_control_socket] = { CNTSPROB_enable_control_socket, 'f', XSIZE(struct section_problem_data, enable_control_socket), "enable_control_socket", XOFFSET(struct section_problem_data, enable_control_socket) },
+  [CNTSPROB_enable_checker_server] = { CNTSPROB_enable_checker_server, 'f', XSIZE(struct section_problem_data, enable_checker_server), "enable_checker_server", XOFFSET(struct section_problem_data, enable_checker_server) },
   [CNTSPROB_enable_multi_header] = { CNTSPROB_enable_multi_header, 'f', XSIZE(struct section_problem_data, enable_multi_header), "enable_multi_header", XOFFSET(struct section_problem_data, enable_multi_header) },
   [CNTSPROB_use_lang_multi_header] = { CNTSPROB_use_lang_multi_header, 'f', XSIZE(struct section_problem_data, use_lang_multi_header), "use_lang_multi_header", XOFFSET(struct section_problem_data, use_lang_multi_header) },
   [CNTSPROB_notify_on_submit] = { CNTSPROB_notify_on_submit, 'f', XSIZE(struct section_problem_data, notify_on_submit), "notify_on_submit", XOFFSET(struct section_problem_data, notify_on_submit) },
@@ -585,6 +586,7 @@ static struct meta_info_item meta_info_section_problem_data_data[] =
   [CNTSPROB_checker_max_rss_size] = { CNTSPROB_checker_max_rss_size, 'E', XSIZE(struct section_problem_data, checker_max_rss_size), "checker_max_rss_size", XOFFSET(struct section_problem_data, checker_max_rss_size) },
   [CNTSPROB_max_open_file_count] = { CNTSPROB_max_open_file_count, 'i', XSIZE(struct section_problem_data, max_open_file_count), "max_open_file_count", XOFFSET(struct section_problem_data, max_open_file_count) },
   [CNTSPROB_max_process_count] = { CNTSPROB_max_process_count, 'i', XSIZE(struct section_problem_data, max_process_count), "max_process_count", XOFFSET(struct section_problem_data, max_process_count) },
+  [CNTSPROB_parallel_tests] = { CNTSPROB_parallel_tests, 'i', XSIZE(struct section_problem_data, parallel_tests), "parallel_tests", XOFFSET(struct section_problem_data, parallel_tests) },
   [CNTSPROB_extid] = { CNTSPROB_extid, 's', XSIZE(struct section_problem_data, extid), "extid", XOFFSET(struct section_problem_data, extid) },
   [CNTSPROB_unhandled_vars] = { CNTSPROB_unhandled_vars, 's', XSIZE(struct section_problem_data, unhandled_vars), "unhandled_vars", XOFFSET(struct section_problem_data, unhandled_vars) },
   [CNTSPROB_score_view] = { CNTSPROB_score_view, 'x', XSIZE(struct section_problem_data, score_view), "score_view", XOFFSET(struct section_problem_data, score_view) },
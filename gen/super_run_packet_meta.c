@@ -203,6 +203,7 @@ static struct meta_info_item meta_info_super_run_in_problem_packet_data[] =
   [META_SUPER_RUN_IN_PROBLEM_PACKET_max_file_size] = { META_SUPER_RUN_IN_PROBLEM_PACKET_max_file_size, 'E', XSIZE(struct super_run_in_problem_packet, max_file_size), "max_file_size", XOFFSET(struct super_run_in_problem_packet, max_file_size) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_max_open_file_count] = { META_SUPER_RUN_IN_PROBLEM_PACKET_max_open_file_count, 'i', XSIZE(struct super_run_in_problem_packet, max_open_file_count), "max_open_file_count", XOFFSET(struct super_run_in_problem_packet, max_open_file_count) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_max_process_count] = { META_SUPER_RUN_IN_PROBLEM_PACKET_max_process_count, 'i', XSIZE(struct super_run_in_problem_packet, max_process_count), "max_process_count", XOFFSET(struct super_run_in_problem_packet, max_process_count) },
+  [META_SUPER_RUN_IN_PROBLEM_PACKET_parallel_tests] = { META_SUPER_RUN_IN_PROBLEM_PACKET_parallel_tests, 'i', XSIZE(struct super_run_in_problem_packet, parallel_tests), "parallel_tests", XOFFSET(struct super_run_in_problem_packet, parallel_tests) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_spelling] = { META_SUPER_RUN_IN_PROBLEM_PACKET_spelling, 's', XSIZE(struct super_run_in_problem_packet, spelling), "spelling", XOFFSET(struct super_run_in_problem_packet, spelling) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_open_tests] = { META_SUPER_RUN_IN_PROBLEM_PACKET_open_tests, 's', XSIZE(struct super_run_in_problem_packet, open_tests), "open_tests", XOFFSET(struct super_run_in_problem_packet, open_tests) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_enable_process_group] = { META_SUPER_RUN_IN_PROBLEM_PACKET_enable_process_group, 'B', XSIZE(struct super_run_in_problem_packet, enable_process_group), "enable_process_group", XOFFSET(struct super_run_in_problem_packet, enable_process_group) },
@@ -212,6 +213,7 @@ static struct meta_info_item meta_info_super_run_in_problem_packet_data[] =
   [META_SUPER_RUN_IN_PROBLEM_PACKET_enable_extended_info] = { META_SUPER_RUN_IN_PROBLEM_PACKET_enable_extended_info, 'B', XSIZE(struct super_run_in_problem_packet, enable_extended_info), "enable_extended_info", XOFFSET(struct super_run_in_problem_packet, enable_extended_info) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_stop_on_first_fail] = { META_SUPER_RUN_IN_PROBLEM_PACKET_stop_on_first_fail, 'B', XSIZE(struct super_run_in_problem_packet, stop_on_first_fail), "stop_on_first_fail", XOFFSET(struct super_run_in_problem_packet, stop_on_first_fail) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_enable_control_socket] = { META_SUPER_RUN_IN_PROBLEM_PACKET_enable_control_socket, 'B', XSIZE(struct super_run_in_problem_packet, enable_control_socket), "enable_control_socket", XOFFSET(struct super_run_in_problem_packet, enable_control_socket) },
+  [META_SUPER_RUN_IN_PROBLEM_PACKET_enable_checker_server] = { META_SUPER_RUN_IN_PROBLEM_PACKET_enable_checker_server, 'B', XSIZE(struct super_run_in_problem_packet, enable_checker_server), "enable_checker_server", XOFFSET(struct super_run_in_problem_packet, enable_checker_server) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_container_options] = { META_SUPER_RUN_IN_PROBLEM_PACKET_container_options, 's', XSIZE(struct super_run_in_problem_packet, container_options), "container_options", XOFFSET(struct super_run_in_problem_packet, container_options) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_enable_user_input] = { META_SUPER_RUN_IN_PROBLEM_PACKET_enable_user_input, 'B', XSIZE(struct super_run_in_problem_packet, enable_user_input), "enable_user_input", XOFFSET(struct super_run_in_problem_packet, enable_user_input) },
   [META_SUPER_RUN_IN_PROBLEM_PACKET_user_input_file] = { META_SUPER_RUN_IN_PROBLEM_PACKET_user_input_file, 's', XSIZE(struct super_run_in_problem_packet, user_input_file), "user_input_file", XOFFSET(struct super_run_in_problem_packet, user_input_file) },
@@ -3,7 +3,7 @@
 #ifndef __COMMON_PLUGIN_H__
 #define __COMMON_PLUGIN_H__
 
-/* Copyright (C) 2008-2017 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2008-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -66,5 +66,8 @@ const struct common_loaded_plugin *
 plugin_get(
         const unsigned char *type,
         const unsigned char *name);
+/* the number of loaded external plugins (database connections etc) */
+int
+plugin_get_external_count(void);
 
 #endif /* __COMMON_PLUGIN_H__ */
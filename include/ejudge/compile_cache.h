@@ -0,0 +1,52 @@
+/* -*- c -*- */
+
+#ifndef __COMPILE_CACHE_H__
+#define __COMPILE_CACHE_H__
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/* compilation results cache, the entries are looked up by a hex string
+   key computed by the caller from everything affecting the compilation */
+struct compile_cache;
+
+enum { COMPILE_CACHE_KEY_SIZE = 65 };
+
+/* `max_size' is the total size of the cached files, 0 for default */
+struct compile_cache *
+compile_cache_open(const unsigned char *dir, long long max_size);
+struct compile_cache *
+compile_cache_close(struct compile_cache *cc);
+
+/* on hit, the executable (if any) is copied to `exe_path', the compilation
+   log is appended to `log_path', returns 1 on hit, 0 on miss;
+   a successful compilation without the executable is a miss */
+int
+compile_cache_lookup(
+        struct compile_cache *cc,
+        const unsigned char *key,
+        int *p_status,
+        const unsigned char *exe_path,
+        const unsigned char *log_path);
+
+/* `exe_path' may be NULL if there is no executable */
+int
+compile_cache_store(
+        struct compile_cache *cc,
+        const unsigned char *key,
+        int status,
+        const unsigned char *exe_path,
+        const unsigned char *log_path);
+
+#endif /* __COMPILE_CACHE_H__ */
@@ -84,6 +84,15 @@ struct ejudge_cfg
   // max loaded contests count for ej-contests
   int max_loaded_contests;
 
+  // max worker processes for read-only requests in ej-contests
+  int contests_workers;
+
+  // max total size of the compilation results cache
+  long long compile_cache_size;
+
+  // the number of cgroups reused by ej-suid-container
+  int container_pool_size;
+
   // these strings actually point into other strings in XML tree
   unsigned char *socket_path;
   unsigned char *db_path;
@@ -128,6 +137,7 @@ struct ejudge_cfg
   unsigned char *default_status_plugin;
   unsigned char *default_variant_plugin;
   unsigned char *caps_file;
+  unsigned char *compile_cache_dir;
   unsigned char *contest_server_id;
   struct xml_tree *user_map;
   struct xml_tree *oauth_user_map;
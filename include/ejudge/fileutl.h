@@ -2,7 +2,7 @@
 #ifndef __FILEUTL_H__
 #define __FILEUTL_H__
 
-/* Copyright (C) 2000-2017 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2000-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or
@@ -25,6 +25,10 @@
 int   scan_dir(char const *dir, char *result, size_t res_size, int random_mode);
 void  scan_dir_add_ignored(const unsigned char *dir,
                            const unsigned char *filename);
+/* wait at most `timeout_ms' for a change in the spool directory `dir',
+   returns 1 if scan_dir might find something new, 0 on timeout,
+   -1 if the directory cannot be watched */
+int   scan_dir_wait(const unsigned char *dir, int timeout_ms);
 
 int get_file_list(const char *partial_path, strarray_t *files);
 
@@ -40,6 +44,10 @@ int generic_copy_file(int sflags,
                       int dflags,
                       char const *ddir, char const *dname, char const *dsfx);
 int fast_copy_file(const unsigned char *oldname, const unsigned char *newname);
+
+/* stage_file results */
+enum { STAGE_COPIED, STAGE_RANGE, STAGE_CLONED };
+int stage_file(const unsigned char *src, const unsigned char *dst);
 ssize_t generic_file_size(const unsigned char *dir,
                           const unsigned char *name,
                           const unsigned char *sfx);
@@ -3,7 +3,7 @@
 #ifndef __FILTER_EVAL_H__
 #define __FILTER_EVAL_H__
 
-/* Copyright (C) 2002-2018 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2002-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -23,6 +23,8 @@
 #include "ejudge/teamdb.h"
 #include "ejudge/serve_state.h"
 
+struct filter_user_prob_marks;
+
 struct filter_env
 {
   teamdb_state_t teamdb_state;
@@ -39,8 +41,22 @@ struct filter_env
   int rid;
   const struct run_entry *cur;
   time_t cur_time;
+  /* if set, filter programs read the hot run fields from the columns */
+  const struct run_columns *columns;
+
+  /* (user_id, prob_id) indices, built on the first use from rentries */
+  int marks_size;
+  int marks_used;
+  struct filter_user_prob_marks *marks;
 };
 
 int filter_tree_bool_eval(struct filter_env *env, struct filter_tree *t);
 
+/* compiled form of a filter expression, allocated in `mem' */
+struct filter_program;
+struct filter_program *
+filter_program_compile(struct filter_tree_mem *mem, struct filter_tree *t);
+int filter_program_bool_eval(struct filter_env *env,
+                             const struct filter_program *prog);
+
 #endif /* __FILTER_EVAL_H__ */
@@ -3,7 +3,7 @@
 #ifndef __FULL_ARCHIVE_H__
 #define __FULL_ARCHIVE_H__
 
-/* Copyright (C) 2005-2014 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2005-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -24,6 +24,17 @@
 #include <zip.h>
 #endif
 
+/* entry compression methods, version 2 */
+enum
+{
+  FULL_ARCHIVE_CODEC_STORE = 0,   /* no compression */
+  FULL_ARCHIVE_CODEC_DEFLATE = 1, /* zlib stream at the fastest level */
+
+  FULL_ARCHIVE_CODEC_LAST,
+};
+
+struct full_archive_index_slot;
+
 struct full_archive
 {
 #if defined CONF_HAS_LIBZIP
@@ -32,13 +43,21 @@ struct full_archive
   struct zip *hzip;
 #endif
   int fd;
+  int version;                  /* the archive format version */
+  int codec;                    /* FULL_ARCHIVE_CODEC_* */
 
   // for writing
   long cur_size;
+  int write_mode;
+  struct full_archive_index_slot *idx; /* entries written so far */
+  int idx_u, idx_a;
 
   // for reading
   const unsigned char *mptr;    /* memory mapping address */
   long msize;                   /* file size */
+  long entries_end;             /* end of entries (start of the index) */
+  const struct full_archive_index_slot *slots; /* name hash table */
+  unsigned int slot_count;      /* the hash table size, a power of 2 */
 };
 typedef struct full_archive *full_archive_t;
 
@@ -46,7 +65,27 @@ struct full_archive_file_header
 {
   unsigned char sig[8];         /* the file signature */
   unsigned int  version;        /* the archive format version */
-  unsigned char pad[4];         /* padding to 16 bytes */
+  unsigned char codec;          /* compression method (version 2) */
+  unsigned char pad[3];         /* padding to 16 bytes */
+};
+
+/*
+ * Version 2 archives end with an open addressing hash table of
+ * entry offsets followed by the trailer. Archives which were not
+ * closed properly have no index and are scanned sequentially.
+ */
+struct full_archive_index_slot
+{
+  unsigned int hash;            /* hash of the entry name */
+  unsigned int reserved;
+  long long offset;             /* entry header offset, 0 - empty slot */
+};
+
+struct full_archive_index_trailer
+{
+  unsigned char sig[4];         /* the index signature */
+  unsigned int slot_count;      /* the number of hash table slots */
+  long long index_offset;       /* offset of the hash table */
 };
 
 #define FULL_ARCHIVE_MAX_NAME_LEN 255
@@ -61,6 +100,8 @@ typedef struct full_archive_entry_header
 } full_archive_entry_header_t;
 
 full_archive_t full_archive_open_write(const unsigned char *path);
+full_archive_t full_archive_open_write_codec(const unsigned char *path,
+                                             int codec);
 full_archive_t full_archive_open_read(const unsigned char *path);
 full_archive_t full_archive_close(full_archive_t af);
 int full_archive_append_file(full_archive_t af,
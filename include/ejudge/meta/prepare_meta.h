@@ -403,6 +403,7 @@ enum
   CNTSPROB_enable_extended_info,
   CNTSPROB_stop_on_first_fail,
   CNTSPROB_enable_control_socket,
+  CNTSPROB_enable_checker_server,
   CNTSPROB_enable_multi_header,
   CNTSPROB_use_lang_multi_header,
   CNTSPROB_notify_on_submit,
@@ -545,6 +546,7 @@ enum
   CNTSPROB_checker_max_rss_size,
   CNTSPROB_max_open_file_count,
   CNTSPROB_max_process_count,
+  CNTSPROB_parallel_tests,
   CNTSPROB_extid,
   CNTSPROB_unhandled_vars,
   CNTSPROB_score_view,
@@ -163,6 +163,7 @@ enum
   META_SUPER_RUN_IN_PROBLEM_PACKET_max_file_size,
   META_SUPER_RUN_IN_PROBLEM_PACKET_max_open_file_count,
   META_SUPER_RUN_IN_PROBLEM_PACKET_max_process_count,
+  META_SUPER_RUN_IN_PROBLEM_PACKET_parallel_tests,
   META_SUPER_RUN_IN_PROBLEM_PACKET_spelling,
   META_SUPER_RUN_IN_PROBLEM_PACKET_open_tests,
   META_SUPER_RUN_IN_PROBLEM_PACKET_enable_process_group,
@@ -172,6 +173,7 @@ enum
   META_SUPER_RUN_IN_PROBLEM_PACKET_enable_extended_info,
   META_SUPER_RUN_IN_PROBLEM_PACKET_stop_on_first_fail,
   META_SUPER_RUN_IN_PROBLEM_PACKET_enable_control_socket,
+  META_SUPER_RUN_IN_PROBLEM_PACKET_enable_checker_server,
   META_SUPER_RUN_IN_PROBLEM_PACKET_container_options,
   META_SUPER_RUN_IN_PROBLEM_PACKET_enable_user_input,
   META_SUPER_RUN_IN_PROBLEM_PACKET_user_input_file,
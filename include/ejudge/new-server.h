@@ -137,6 +137,17 @@ struct contest_extra
 
   // contest-specific pages
   struct ContestExternalActions *cnts_actions;
+
+  // recently generated standings pages
+  struct standings_cache *standings_cache;
+
+  // inotify watches on the compile and run status directories
+  serve_state_t status_watch_state; // the state the watches are set for
+  int status_wd_u;
+  int *status_wds;
+  unsigned char status_watch_failed;
+  unsigned char status_dirty;       // new packets may be available
+  time_t last_status_scan;
 };
 
 int nsdb_check_role(int user_id, int contest_id, int role);
@@ -504,6 +515,12 @@ ns_list_all_users_callback(
         int contest_id,
         unsigned char **p_xml,
         struct UserlistBinaryHeader **p_header);
+int
+ns_list_changed_users_callback(
+        void *user_data,
+        int contest_id,
+        unsigned long long vintage,
+        struct UserlistBinaryHeader **p_header);
 void
 ns_check_contest_events(
         struct contest_extra *extra,
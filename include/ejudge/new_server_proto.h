@@ -3,7 +3,7 @@
 #ifndef __NEW_SERVER_PROTO_H__
 #define __NEW_SERVER_PROTO_H__
 
-/* Copyright (C) 2006-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2006-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -381,6 +381,12 @@ enum
   NEW_SRV_ACTION_LAST,
 };
 
+// action flags (ns_action_flags_table)
+enum
+{
+  NS_ACTION_READONLY = 1,       // the action does not modify the contest state
+};
+
 // internal page indices
 enum
 {
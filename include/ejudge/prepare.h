@@ -982,6 +982,8 @@ struct section_problem_data
   ejbyteflag_t stop_on_first_fail;
   /** create a controlling socket pair for interactor */
   ejbyteflag_t enable_control_socket;
+  /** keep the checker running for the whole run */
+  ejbyteflag_t enable_checker_server;
 
   /** enable headers/footers specific for each test */
   ejbyteflag_t enable_multi_header;
@@ -1267,6 +1269,8 @@ struct section_problem_data
   int max_open_file_count;
   /** max number of processes per user */
   int max_process_count;
+  /** max number of tests run concurrently */
+  int parallel_tests;
 
   /** external id (for external application binding) */
   unsigned char *extid;
@@ -0,0 +1,80 @@
+/* -*- c -*- */
+
+#ifndef __RUN_TEST_SUMMARY_H__
+#define __RUN_TEST_SUMMARY_H__
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "ejudge/ej_types.h"
+
+#include <stdint.h>
+
+/* compact digest of the testing report of a run */
+struct run_test_summary
+{
+  ej_uuid_t run_uuid;           /* the run the summary belongs to */
+  ej_uuid_t judge_uuid;         /* the judging (run_entry::j) */
+  unsigned int status_mask;     /* 1 << status for each test with status < 32 */
+  int is_valid;
+  int has_other_status;         /* there are tests with status >= 32 */
+  int run_tests;
+  int passed_tests;
+  int max_time;                 /* ms */
+  int max_real_time;            /* ms */
+  int pad;
+  int64_t max_memory_used;
+};
+
+struct run_test_summary_cache
+{
+  int fd;                       /* the backing file, -1, if not available */
+  int size;
+  int reserved;
+  struct run_test_summary *items; /* indexed by run_id */
+};
+
+struct run_entry;
+struct testing_report_xml;
+struct serve_state;
+
+void
+run_test_summary_make(
+        struct run_test_summary *rts,
+        const struct run_entry *re,
+        const struct testing_report_xml *tr);
+
+/* save the summary in memory and in the summary file of the contest */
+void
+run_test_summary_store(
+        struct serve_state *cs,
+        int run_id,
+        const struct run_test_summary *rts);
+
+/* returns the summary, if it was made for the current judging of the run */
+const struct run_test_summary *
+run_test_summary_get(
+        struct serve_state *cs,
+        const struct run_entry *re);
+
+/* returns 1 if some test has the status, 0 if none, -1 if unknown */
+int
+run_test_summary_has_status(
+        const struct run_test_summary *rts,
+        int status);
+
+void
+run_test_summary_free(struct run_test_summary_cache *cache);
+
+#endif /* __RUN_TEST_SUMMARY_H__ */
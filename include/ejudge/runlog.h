@@ -2,7 +2,7 @@
 #ifndef __RUNLOG_H__
 #define __RUNLOG_H__
 
-/* Copyright (C) 2000-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2000-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -455,6 +455,30 @@ int run_get_user_last_run_id(runlog_state_t state, int user_id);
 int run_get_user_first_run_id(runlog_state_t state, int user_id);
 int run_get_user_next_run_id(runlog_state_t state, int run_id);
 int run_get_user_prev_run_id(runlog_state_t state, int run_id);
+int run_get_user_prob_first_run_id(runlog_state_t state, int user_id, int prob_id);
+int run_get_user_prob_next_run_id(runlog_state_t state, int run_id);
+/* the number of (user_id, prob_id) pairs, which ever had runs */
+int run_get_user_prob_count(runlog_state_t state);
+
+/* read-only columns of the most frequently scanned run fields,
+   the arrays are indexed by run_id in range [first, total) */
+struct run_columns
+{
+  int first;
+  int total;
+  const unsigned char *status;
+  const unsigned char *is_hidden;
+  const int *user_id;
+  const int *prob_id;
+  const int *lang_id;
+  const int *score;
+  const ej_time64_t *time;
+};
+void run_get_columns(runlog_state_t state, struct run_columns *out);
+
+/* run change journal for incremental consumers */
+int64_t run_get_change_serial(runlog_state_t state);
+int run_get_changed_run_id(runlog_state_t state, int64_t serial);
 
 int run_get_uuid_hash_state(runlog_state_t state);
 int run_find_run_id_by_uuid(runlog_state_t state, const ej_uuid_t *puuid);
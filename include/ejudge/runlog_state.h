@@ -32,6 +32,17 @@ struct run_entry_extra
 {
   int prev_user_id;            /* previous run with the same user_id, -1, if none*/
   int next_user_id;            /* next run with the same user_id, -1, if none */
+  int prev_user_prob_id;       /* previous run with the same user_id and prob_id, -1, if none */
+  int next_user_prob_id;       /* next run with the same user_id and prob_id, -1, if none */
+};
+
+struct user_prob_hash_entry
+{
+  int user_id;                 /* 0, if the entry is empty */
+  int prob_id;
+  int run_id_first;            /* first run with this user_id and prob_id, -1, if none */
+  int run_id_last;             /* last run with this user_id and prob_id, -1, if none */
+  int run_id_first_ok;         /* first visible OK run, if it is in the first OK index, -1 otherwise */
 };
 
 struct uuid_hash_entry
@@ -40,6 +51,37 @@ struct uuid_hash_entry
   ej_uuid_t uuid;
 };
 
+/* structure-of-arrays copy of the most frequently scanned run fields */
+struct run_columns_state
+{
+  int64_t change_serial;       /* change journal serial the columns are valid for, -1 - not built */
+  int first;                   /* run_id of the element 0 */
+  int size;                    /* the number of mirrored runs */
+  int reserved;
+  unsigned char *status;
+  unsigned char *is_hidden;
+  int *user_id;
+  int *prob_id;
+  int *lang_id;
+  int *score;
+  ej_time64_t *time;
+};
+
+/* first visible OK runs of the users, who are not banned or invisible */
+struct run_first_ok_prob
+{
+  int size;
+  int reserved;
+  int *run_ids;                /* ascending */
+};
+
+struct run_first_ok_state
+{
+  int64_t change_serial;       /* change journal serial the index is valid for, -1 - not built */
+  int prob_size;
+  struct run_first_ok_prob *probs; /* indexed by prob_id */
+};
+
 struct rldb_plugin_iface;
 struct rldb_plugin_data;
 struct rldb_plugin_cnts;
@@ -96,6 +138,11 @@ struct runlog_state
   int run_extra_u, run_extra_a;
   struct run_entry_extra *run_extras; /* run indices */
 
+  // (user_id, prob_id) hash, chains of a user are valid iff user run index is valid
+  int user_prob_hash_size;
+  int user_prob_hash_used;
+  struct user_prob_hash_entry *user_prob_hash;
+
   // UUID hash information
   int uuid_hash_state; // -1 - disabled, 0 - not built, 1 - ok
   int uuid_hash_size;  // the size of the hash table
@@ -104,6 +151,19 @@ struct runlog_state
   int uuid_hash_last_added_run_id;
   int uuid_hash_last_added_index;
 
+  // run change journal: run_ids of changed runs are kept in a ring buffer,
+  // changes before change_reset_serial cannot be replayed
+  int64_t change_serial;
+  int64_t change_reset_serial;
+  int change_ring_size;
+  int *change_ring;
+
+  // hot fields of runs, see run_get_columns
+  struct run_columns_state columns;
+
+  // first OK run for each problem, see run_get_prev_successes
+  struct run_first_ok_state first_ok;
+
   // userrunheader information
   struct user_run_header_state urh;
 
@@ -35,6 +35,7 @@ struct clarlog_state;
 struct teamdb_state;
 struct user_state_info;
 struct user_filter_info;
+struct run_test_summary_cache;
 struct teamdb_db_callbacks;
 struct userlist_clnt;
 struct ejudge_cfg;
@@ -70,6 +71,7 @@ struct user_filter_info
   int prev_mode_clar;           /* 1 - view all, 2 - view unanswered */
   unsigned char *prev_filter_expr;
   struct filter_tree *prev_tree;
+  struct filter_program *prev_prog; /* compiled prev_tree, in tree_mem */
   struct filter_tree_mem *tree_mem;
   unsigned char *error_msgs;
 
@@ -162,6 +164,34 @@ struct serve_user_results
   int total_score;
 };
 
+/** incrementally maintained cell of ACM standings for a (user_id, prob_id) pair */
+struct serve_acm_cell
+{
+  int user_id;                  /* 0, if the hash entry is empty */
+  int prob_id;
+  int calc;                     /* <= 0 - failed attempts, > 0 - solved, 1 + failed attempts */
+  int att_count;                /* attempts counted for the problem statistics */
+  int ok_run_id;                /* the first accepted run, -1, if none */
+  int64_t update_serial;        /* the last runlog change serial this cell was rebuilt at */
+  unsigned char trans_flag;
+  unsigned char pr_flag;
+  unsigned char disq_flag;
+  unsigned char cf_flag;
+};
+
+/** incrementally maintained ACM standings, see do_write_standings */
+struct serve_acm_standings
+{
+  int64_t change_serial;        /* runlog change serial the cells are valid for */
+  time_t start_time;
+  time_t cutoff_dur;            /* runs submitted later are ignored, 0 - no cutoff */
+  time_t ignore_after;          /* stand_ignore_after the cells are built for */
+  time_t max_run_dur;           /* the latest run relative to start_time */
+  int hash_size;
+  int hash_used;
+  struct serve_acm_cell *cells; /* hash table on (user_id, prob_id) */
+};
+
 /** user group information */
 struct serve_user_group
 {
@@ -353,6 +383,15 @@ struct serve_state
 
   // serial number for the testing user
   int exec_user_serial;
+
+  // incremental ACM standings: [0] - privileged, [1] - public
+  struct serve_acm_standings *acm_standings[2];
+
+  // testing report summaries, see run_test_summary.h
+  struct run_test_summary_cache *test_summary;
+
+  // incremented each time the standings files are updated
+  int64_t standings_serial;
 };
 typedef struct serve_state *serve_state_t;
 
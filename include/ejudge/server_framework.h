@@ -93,6 +93,14 @@ struct client_state_operations
   void (*set_client_auth)(struct client_state *, struct client_auth *);
 };
 
+/* epoll registration of a file descriptor */
+struct nsf_poll_entry
+{
+  int kind;
+  int registered;
+  unsigned mask;                /* events currently registered */
+};
+
 struct client_state
 {
   const struct client_state_operations *ops;
@@ -101,6 +109,8 @@ struct client_state
 
   int id;
   int fd;
+
+  struct nsf_poll_entry pe;
 };
 
 struct ht_client_state
@@ -264,6 +274,14 @@ int nsf_add_watch(struct server_framework_state *,
 int nsf_remove_watch(struct server_framework_state *, int);
 int nsf_is_restart_requested(struct server_framework_state *);
 
+/* fork a worker process to complete the current request of `p',
+   returns the worker pid in the parent, 0 in the worker, -1 if the
+   request must be handled in place */
+int nsf_fork_worker(struct server_framework_state *state,
+                    struct client_state *p,
+                    int max_workers);
+int nsf_is_worker(const struct server_framework_state *state);
+
 void nsf_err_bad_packet_length(struct server_framework_state *,
                                struct client_state *, size_t, size_t);
 void nsf_err_invalid_command(struct server_framework_state *,
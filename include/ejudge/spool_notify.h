@@ -0,0 +1,35 @@
+/* -*- c -*- */
+
+#ifndef __SPOOL_NOTIFY_H__
+#define __SPOOL_NOTIFY_H__
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/* wake-up notifications for packets arriving to a local spool directory */
+struct spool_notify;
+
+/* start watching `queue_dir'/dir, NULL if notifications are not available */
+struct spool_notify *
+spool_notify_open(const unsigned char *queue_dir);
+struct spool_notify *
+spool_notify_close(struct spool_notify *sn);
+
+/* wait at most `timeout_ms' for a new packet, without notifications
+   just sleep for `timeout_ms', returns 1 if a packet might have arrived,
+   0 on timeout or signal */
+int
+spool_notify_wait(struct spool_notify *sn, int timeout_ms);
+
+#endif /* __SPOOL_NOTIFY_H__ */
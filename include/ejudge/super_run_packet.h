@@ -177,6 +177,7 @@ struct super_run_in_problem_packet
   ej_size64_t max_file_size;
   int max_open_file_count;
   int max_process_count;
+  int parallel_tests;
   unsigned char *spelling;
   unsigned char *open_tests;
   ejintbool_t enable_process_group;
@@ -186,6 +187,7 @@ struct super_run_in_problem_packet
   ejintbool_t enable_extended_info;
   ejintbool_t stop_on_first_fail;
   ejintbool_t enable_control_socket;
+  ejintbool_t enable_checker_server;
   unsigned char *container_options;
   ejintbool_t enable_user_input;
   unsigned char *user_input_file;
@@ -63,8 +63,11 @@ struct super_run_status
     unsigned char  pad5[2];
     int            super_run_pid;// 96: pid of ej-super-run
     int            test_count;   // 100: total test count
+    long long      queue_wait_total_ms; // 104: total time packets waited in the queue
+    long long      queue_wait_max_ms;   // 112: max time a packet waited in the queue
+    int            queue_wait_count;    // 120: number of packets accounted
 
-    unsigned char  pad6[88];
+    unsigned char  pad6[68];
 
     unsigned char  strings[320]; // string pool
 };
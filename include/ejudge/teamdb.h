@@ -42,6 +42,8 @@ struct teamdb_db_callbacks
 {
   void *user_data;
   int (*list_all_users)(void *, int, unsigned char **, struct UserlistBinaryHeader **p_header);
+  // the users changed since the vintage, or all the users, may be NULL
+  int (*list_changed_users)(void *, int, unsigned long long vintage, struct UserlistBinaryHeader **p_header);
 };
 struct userlist_user;
 
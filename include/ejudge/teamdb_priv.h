@@ -2,7 +2,7 @@
 #ifndef __TEAMDB_PRIV_H__
 #define __TEAMDB_PRIV_H__
 
-/* Copyright (C) 2010-2017 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2010-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -64,11 +64,21 @@ struct teamdb_state
 
   struct UserlistBinaryHeader *header;
   struct userlist_list *users;
+  unsigned long long users_vintage;     /* the change vintage of the users */
+  struct UserlistBinaryHeader **deltas; /* applied changes of the users */
+  int delta_u, delta_a;
+  struct userlist_user **own_user_map;  /* replaces the map in header */
 
   int total_participants;
   struct userlist_user **participants;
   struct userlist_contest **u_contests;
 
+  /* hash indexes of participants by login, name and cypher,
+     built lazily on the first lookup, 0 - empty slot,
+     otherwise index in participants + 1 */
+  int *key_index;
+  int key_index_size;                   /* power of 2, slots per key */
+
   int extra_out_of_sync;
   int extra_num;
   struct teamdb_extra **extra_info;
@@ -0,0 +1,60 @@
+/* -*- mode: c; c-basic-offset: 4 -*- */
+
+#ifndef __TEST_DATA_CACHE_H__
+#define __TEST_DATA_CACHE_H__
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdlib.h>
+
+/*
+ * Local content-addressed cache of the problem test data.
+ * The files are stored as DIR/objects/XX/SHA256, the list of files
+ * for each directory and file name pattern is kept in DIR/manifests.
+ * The least recently used objects are removed when the total size
+ * of the objects exceeds the limit.
+ */
+
+struct test_data_cache_state;
+
+struct test_data_cache_state *
+test_data_cache_new(const unsigned char *cache_dir, long long max_size);
+struct test_data_cache_state *
+test_data_cache_free(struct test_data_cache_state *s);
+
+/* set the state used when NULL state is passed */
+void
+test_data_cache_set_default(struct test_data_cache_state *s);
+
+/* number of the files matching the pattern, -1 if the cache is not
+   enabled or the directory is not available */
+int
+test_data_cache_count(
+        struct test_data_cache_state *s,
+        const unsigned char *dir,
+        const unsigned char *pattern);
+
+/* replace the path in buf with the path to the cached copy of file
+   number num, returns -1 if the file is not in the cache */
+int
+test_data_cache_lookup(
+        struct test_data_cache_state *s,
+        const unsigned char *dir,
+        const unsigned char *pattern,
+        int num,
+        unsigned char *buf,
+        size_t size);
+
+#endif /* __TEST_DATA_CACHE_H__ */
@@ -3,7 +3,7 @@
 #ifndef __USERLIST_BIN_H__
 #define __USERLIST_BIN_H__
 
-/* Copyright (C) 2017 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2017-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -21,7 +21,15 @@
 
 #include <stdint.h>
 
-#define USERLIST_BIN_VERSION 1
+#define USERLIST_BIN_VERSION 2
+
+/* flags in UserlistBinaryHeader */
+enum
+{
+    USERLIST_BIN_DELTA = 1,        // only the users changed since base_vintage
+    USERLIST_BIN_SNAPSHOT = 2,     // no data, the complete list is published in shared memory
+    USERLIST_BIN_MAPPED = 4,       // local: the header is mapped from shared memory
+};
 
 /* binary transfer protocol indended for data transfer between ej-users and ej-contests */
 
@@ -42,7 +50,11 @@ typedef struct UserlistBinaryHeader
     uint32_t max_user_id;          // maximum user_id in the data
     uint32_t root_offset;          // offset from data[] to the root of the tree, currently 16
     int32_t contest_id;
-    unsigned char pad3[12];
+    uint32_t flags;                // USERLIST_BIN_DELTA, USERLIST_BIN_SNAPSHOT
+    uint32_t removed_count;        // the number of users removed since base_vintage
+    uint32_t removed_offset;       // offset from data[] to int32_t user_id array
+    uint64_t vintage;              // the change vintage of the data
+    uint64_t base_vintage;         // the vintage the delta is relative to
     unsigned char data[];
 } UserlistBinaryHeader;
 
@@ -61,6 +73,9 @@ typedef struct UserlistBinaryContext
     size_t *user_offsets;
     uint32_t root_offset;
     size_t total_size;
+    int32_t *removed;     // users which are not in the list any more
+    size_t removed_u, removed_a;
+    uint32_t removed_offset;
 } UserlistBinaryContext;
 
 void
@@ -81,6 +96,11 @@ userlist_bin_marshall(
         const UserlistBinaryContext *cntx,
         int contest_id);
 
+void
+userlist_bin_marshall_removed(
+        UserlistBinaryContext *cntx,
+        int user_id);
+
 void
 userlist_bin_init_context(
         UserlistBinaryContext *cntx);
@@ -95,5 +115,7 @@ const struct userlist_list *
 userlist_bin_unmarshall(UserlistBinaryHeader *header);
 const struct userlist_list *
 userlist_bin_get_root(const UserlistBinaryHeader *header);
+const int32_t *
+userlist_bin_get_removed(const UserlistBinaryHeader *header);
 
 #endif /* __USERLIST_BIN_H__ */
@@ -3,7 +3,7 @@
 #ifndef __USERLIST_CLNT_H__
 #define __USERLIST_CLNT_H__
 
-/* Copyright (C) 2002-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2002-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -501,6 +501,15 @@ userlist_clnt_bin_data(
         int contest_id,
         unsigned char **p_data);
 
+int
+userlist_clnt_bin_data_delta(
+        struct userlist_clnt *clnt,
+        int cmd,
+        int contest_id,
+        int flags,
+        unsigned long long vintage,
+        unsigned char **p_data);
+
 struct userlist_cookie;
 int
 userlist_clnt_create_cookie(
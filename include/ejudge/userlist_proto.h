@@ -3,7 +3,7 @@
 #ifndef __USERLIST_PROTO_H__
 #define __USERLIST_PROTO_H__
 
-/* Copyright (C) 2002-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2002-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -130,6 +130,7 @@ enum
     ULS_GET_API_KEYS_FOR_USER,
     ULS_DELETE_API_KEY,
     ULS_PRIV_CREATE_COOKIE,
+    ULS_LIST_STANDINGS_USERS_3,
 
     ULS_LAST_CMD
   };
@@ -365,6 +366,21 @@ struct userlist_pk_map_contest
   int   contest_id;
 };
 
+/* flags in userlist_pk_standings_delta */
+enum
+{
+  ULS_DELTA_ACCEPT_SNAPSHOT = 1, /* the client can map the shared memory image */
+};
+
+/* request for the users changed since the given vintage */
+struct userlist_pk_standings_delta
+{
+  short request_id;
+  int   contest_id;
+  int   flags;
+  unsigned long long vintage;
+};
+
 struct userlist_pk_edit_registration
 {
   short          request_id;
@@ -0,0 +1,49 @@
+/* -*- c -*- */
+
+#ifndef __USERLIST_SHM_H__
+#define __USERLIST_SHM_H__
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/* complete binary userlists of contests, published by ej-users
+   in shared memory files and mapped by ej-contests */
+
+struct UserlistBinaryHeader;
+
+/* the images are kept per userlist server, identified by its socket */
+int
+userlist_shm_publish(
+        const unsigned char *socket_path,
+        const struct UserlistBinaryHeader *header);
+
+struct UserlistBinaryHeader *
+userlist_shm_map(
+        const unsigned char *socket_path,
+        int contest_id,
+        unsigned long long vintage);
+
+/* removes the image of the contest */
+void
+userlist_shm_remove(const unsigned char *socket_path, int contest_id);
+
+/* removes all the images and the directory */
+void
+userlist_shm_remove_all(const unsigned char *socket_path);
+
+/* frees the header either received from ej-users or mapped */
+void
+userlist_shm_free(struct UserlistBinaryHeader *header);
+
+#endif /* __USERLIST_SHM_H__ */
@@ -1,7 +1,7 @@
 /* -*- mode: c -*- */
 /* $Id$ */
 
-/* Copyright (C) 2008-2014 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2008-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -25,6 +25,7 @@
 static int plugins_num = 0;
 static int plugins_size = 0;
 static struct common_loaded_plugin *plugins = 0;
+static int external_plugins_num = 0;
 
 const struct common_loaded_plugin *
 plugin_register_builtin(
@@ -145,10 +146,17 @@ plugin_load_external(
   plugins[plugins_num].name = xstrdup(name);
   plugins[plugins_num].iface = common_iface;
   plugins[plugins_num].data = data;
+  ++external_plugins_num;
 
   return &plugins[plugins_num++];
 }
 
+int
+plugin_get_external_count(void)
+{
+  return external_plugins_num;
+}
+
 const struct common_loaded_plugin *
 plugin_get(
         const unsigned char *type,
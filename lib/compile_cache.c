@@ -0,0 +1,346 @@
+/* -*- mode: c -*- */
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "ejudge/compile_cache.h"
+#include "ejudge/fileutl.h"
+#include "ejudge/errlog.h"
+#include "ejudge/runlog.h"
+
+#include "ejudge/xalloc.h"
+#include "ejudge/osdeps.h"
+#include "ejudge/logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+/*
+ * Each entry is a directory DIR/XX/KEY, where XX are the first two
+ * characters of KEY. The directory contains the files "status",
+ * "log" and optionally "exe". The entries are created in DIR/tmp and
+ * renamed into place, so several compilation servers may share
+ * the cache. The mtime of the entry directory is updated on each hit,
+ * and the least recently used entries are removed when the total size
+ * exceeds the limit.
+ */
+
+#define COMPILE_CACHE_DEFAULT_SIZE (1024LL * 1024 * 1024)
+
+struct compile_cache
+{
+  unsigned char *dir;
+  long long max_size;
+  long long total_size;         /* estimate, updated on rescan */
+  long long hits;
+  long long misses;
+};
+
+struct compile_cache_entry
+{
+  unsigned char path[PATH_MAX];
+  long long size;
+  time_t mtime;
+};
+
+static int
+is_valid_key(const unsigned char *key)
+{
+  int i;
+
+  if (!key) return 0;
+  for (i = 0; key[i]; ++i) {
+    if (!isxdigit(key[i])) return 0;
+  }
+  return i == COMPILE_CACHE_KEY_SIZE - 1;
+}
+
+static long long
+get_entry_size(const unsigned char *path)
+{
+  static const char * const names[] = { "status", "log", "exe", NULL };
+  unsigned char fpath[PATH_MAX];
+  struct stat stb;
+  long long size = 0;
+  int i;
+
+  for (i = 0; names[i]; ++i) {
+    snprintf(fpath, sizeof(fpath), "%s/%s", path, names[i]);
+    if (stat(fpath, &stb) >= 0) size += stb.st_size;
+  }
+  return size;
+}
+
+static int
+entry_sort_func(const void *p1, const void *p2)
+{
+  const struct compile_cache_entry *e1 = (const struct compile_cache_entry *) p1;
+  const struct compile_cache_entry *e2 = (const struct compile_cache_entry *) p2;
+  if (e1->mtime < e2->mtime) return -1;
+  if (e1->mtime > e2->mtime) return 1;
+  return 0;
+}
+
+/* collect all the cache entries */
+static long long
+scan_entries(
+        struct compile_cache *cc,
+        struct compile_cache_entry **p_entries,
+        size_t *p_count)
+{
+  struct compile_cache_entry *entries = NULL;
+  size_t a = 0, u = 0;
+  long long total = 0;
+  unsigned char path[PATH_MAX];
+  DIR *d1, *d2;
+  struct dirent *dd1, *dd2;
+  struct stat stb;
+
+  if (!(d1 = opendir(cc->dir))) {
+    err("compile_cache: cannot open %s: %s", cc->dir, os_ErrorMsg());
+    goto done;
+  }
+  while ((dd1 = readdir(d1))) {
+    if (strlen(dd1->d_name) != 2 || !isxdigit(dd1->d_name[0])
+        || !isxdigit(dd1->d_name[1])) continue;
+    snprintf(path, sizeof(path), "%s/%s", cc->dir, dd1->d_name);
+    if (!(d2 = opendir(path))) continue;
+    while ((dd2 = readdir(d2))) {
+      if (!is_valid_key(dd2->d_name)) continue;
+      if (u == a) {
+        if (!(a *= 2)) a = 64;
+        XREALLOC(entries, a);
+      }
+      snprintf(entries[u].path, sizeof(entries[u].path), "%s/%s", path, dd2->d_name);
+      if (stat(entries[u].path, &stb) < 0) continue;
+      entries[u].mtime = stb.st_mtime;
+      entries[u].size = get_entry_size(entries[u].path);
+      total += entries[u].size;
+      ++u;
+    }
+    closedir(d2);
+  }
+  closedir(d1);
+
+done:
+  if (p_entries) {
+    *p_entries = entries;
+    *p_count = u;
+  } else {
+    xfree(entries);
+  }
+  return total;
+}
+
+static void
+evict_entries(struct compile_cache *cc)
+{
+  struct compile_cache_entry *entries = NULL;
+  size_t count = 0, i;
+  long long total, target;
+  int removed = 0;
+
+  total = scan_entries(cc, &entries, &count);
+  // leave some room to avoid rescanning on each store
+  target = cc->max_size - cc->max_size / 8;
+  if (total > cc->max_size) {
+    qsort(entries, count, sizeof(entries[0]), entry_sort_func);
+    for (i = 0; i < count && total > target; ++i) {
+      remove_directory_recursively(entries[i].path, 0);
+      total -= entries[i].size;
+      ++removed;
+    }
+    info("compile_cache: %d entries removed, size is %lld", removed, total);
+  }
+  cc->total_size = total;
+  xfree(entries);
+}
+
+struct compile_cache *
+compile_cache_open(const unsigned char *dir, long long max_size)
+{
+  struct compile_cache *cc = NULL;
+  unsigned char path[PATH_MAX];
+
+  if (!dir || !*dir) return NULL;
+  snprintf(path, sizeof(path), "%s/tmp", dir);
+  if (os_MakeDirPath(path, 0755) < 0) {
+    err("compile_cache: cannot create %s", path);
+    return NULL;
+  }
+
+  XCALLOC(cc, 1);
+  cc->dir = xstrdup(dir);
+  cc->max_size = max_size;
+  if (cc->max_size <= 0) cc->max_size = COMPILE_CACHE_DEFAULT_SIZE;
+  cc->total_size = scan_entries(cc, NULL, NULL);
+  info("compile_cache: %s, size %lld, limit %lld", cc->dir, cc->total_size, cc->max_size);
+  if (cc->total_size > cc->max_size) evict_entries(cc);
+  return cc;
+}
+
+struct compile_cache *
+compile_cache_close(struct compile_cache *cc)
+{
+  if (!cc) return NULL;
+  info("compile_cache: %lld hits, %lld misses", cc->hits, cc->misses);
+  xfree(cc->dir);
+  xfree(cc);
+  return NULL;
+}
+
+static int
+copy_file_mode(const unsigned char *src, const unsigned char *dst)
+{
+  struct stat stb;
+
+  if (stat(src, &stb) < 0) return -1;
+  if (generic_copy_file(0, NULL, src, "", 0, NULL, dst, "") < 0) return -1;
+  // generic_copy_file does not preserve the permissions
+  chmod(dst, stb.st_mode & 0777);
+  return 0;
+}
+
+int
+compile_cache_lookup(
+        struct compile_cache *cc,
+        const unsigned char *key,
+        int *p_status,
+        const unsigned char *exe_path,
+        const unsigned char *log_path)
+{
+  unsigned char entry_path[PATH_MAX];
+  unsigned char path[PATH_MAX];
+  char *text = NULL;
+  size_t size = 0;
+  char *eptr = NULL;
+  long status;
+  FILE *f = NULL;
+
+  if (!cc || !is_valid_key(key)) return 0;
+  snprintf(entry_path, sizeof(entry_path), "%s/%.2s/%s", cc->dir, key, key);
+
+  snprintf(path, sizeof(path), "%s/status", entry_path);
+  if (access(path, R_OK) < 0) goto miss;
+  if (generic_read_file(&text, 0, &size, 0, NULL, path, "") < 0) goto miss;
+  errno = 0;
+  status = strtol(text, &eptr, 10);
+  if (errno || eptr == text || (*eptr && !isspace((unsigned char) *eptr)) || status < 0) {
+    err("compile_cache: invalid entry %s", entry_path);
+    goto miss;
+  }
+  xfree(text); text = NULL;
+
+  snprintf(path, sizeof(path), "%s/exe", entry_path);
+  if (access(path, R_OK) >= 0) {
+    if (copy_file_mode(path, exe_path) < 0) {
+      err("compile_cache: failed to copy %s to %s", path, exe_path);
+      goto miss;
+    }
+  } else if (status == RUN_OK) {
+    // the entry is broken, remove it so that it can be stored again
+    err("compile_cache: no executable in %s", entry_path);
+    cc->total_size -= get_entry_size(entry_path);
+    remove_directory_recursively(entry_path, 0);
+    goto miss;
+  }
+
+  snprintf(path, sizeof(path), "%s/log", entry_path);
+  if (generic_read_file(&text, 0, &size, 0, NULL, path, "") >= 0 && size > 0) {
+    if ((f = fopen(log_path, "a"))) {
+      fwrite(text, 1, size, f);
+      fclose(f);
+    }
+  }
+  xfree(text); text = NULL;
+
+  // mark as recently used
+  utimes(entry_path, NULL);
+  ++cc->hits;
+  info("compile_cache: hit %s, status %ld (%lld hits, %lld misses)",
+       key, status, cc->hits, cc->misses);
+  *p_status = status;
+  return 1;
+
+miss:
+  xfree(text);
+  ++cc->misses;
+  return 0;
+}
+
+int
+compile_cache_store(
+        struct compile_cache *cc,
+        const unsigned char *key,
+        int status,
+        const unsigned char *exe_path,
+        const unsigned char *log_path)
+{
+  unsigned char entry_path[PATH_MAX];
+  unsigned char tmp_path[PATH_MAX];
+  unsigned char path[PATH_MAX];
+  unsigned char buf[64];
+  long long size;
+  struct stat stb;
+
+  if (!cc || !is_valid_key(key)) return -1;
+  snprintf(entry_path, sizeof(entry_path), "%s/%.2s/%s", cc->dir, key, key);
+  if (stat(entry_path, &stb) >= 0) return 0;
+
+  snprintf(tmp_path, sizeof(tmp_path), "%s/tmp/%s.%d", cc->dir, key, (int) getpid());
+  if (lstat(tmp_path, &stb) >= 0) remove_directory_recursively(tmp_path, 0);
+  if (make_dir(tmp_path, 0755) < 0) {
+    err("compile_cache: cannot create %s", tmp_path);
+    return -1;
+  }
+
+  if (exe_path) {
+    snprintf(path, sizeof(path), "%s/exe", tmp_path);
+    if (copy_file_mode(exe_path, path) < 0) goto fail;
+  }
+  snprintf(path, sizeof(path), "%s/log", tmp_path);
+  if (generic_copy_file(0, NULL, log_path, "", 0, NULL, path, "") < 0) goto fail;
+  snprintf(buf, sizeof(buf), "%d\n", status);
+  if (generic_write_file(buf, strlen(buf), 0, tmp_path, "status", "") < 0) goto fail;
+  size = get_entry_size(tmp_path);
+
+  snprintf(path, sizeof(path), "%s/%.2s", cc->dir, key);
+  if (make_dir(path, 0755) < 0) goto fail;
+  if (rename(tmp_path, entry_path) < 0) {
+    // stored concurrently by another process
+    if (errno != EEXIST && errno != ENOTEMPTY) {
+      err("compile_cache: rename %s -> %s failed: %s", tmp_path, entry_path, os_ErrorMsg());
+    }
+    remove_directory_recursively(tmp_path, 0);
+    return 0;
+  }
+
+  cc->total_size += size;
+  if (cc->total_size > cc->max_size) evict_entries(cc);
+  return 0;
+
+fail:
+  err("compile_cache: failed to store %s", key);
+  remove_directory_recursively(tmp_path, 0);
+  return -1;
+}
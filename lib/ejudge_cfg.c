@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2002-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2002-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -24,6 +24,7 @@
 #include "ejudge/expat_iface.h"
 #include "ejudge/errlog.h"
 #include "ejudge/xml_utils.h"
+#include "ejudge/misctext.h"
 
 #include "ejudge/xalloc.h"
 #include "ejudge/logger.h"
@@ -114,6 +115,10 @@ enum
     TG_OAUTH_ENTRY,
     TG_COMPILER_OPTIONS,
     TG_COMPILER_OPTION,
+    TG_CONTESTS_WORKERS,
+    TG_COMPILE_CACHE_DIR,
+    TG_COMPILE_CACHE_SIZE,
+    TG_CONTAINER_POOL_SIZE,
 
     TG__BARRIER,
     TG__DEFAULT,
@@ -221,6 +226,10 @@ static char const * const elem_map[] =
   "oauth_entry",
   "compiler_options",
   "compiler_option",
+  "contests_workers",
+  "compile_cache_dir",
+  "compile_cache_size",
+  "container_pool_size",
   0,
   "_default",
 
@@ -331,6 +340,7 @@ node_free(struct xml_tree *t)
       xfree(p->default_content_url_prefix);
       xfree(p->default_status_plugin);
       xfree(p->caps_file);
+      xfree(p->compile_cache_dir);
     }
     break;
   case TG_MAP:
@@ -650,6 +660,7 @@ static const size_t cfg_final_offsets[TG_LAST_TAG] =
   [TG_DEFAULT_CONTENT_URL_PREFIX] = CONFIG_OFFSET(default_content_url_prefix),
   [TG_DEFAULT_STATUS_PLUGIN] = CONFIG_OFFSET(default_status_plugin),
   [TG_CAPS_FILE] = CONFIG_OFFSET(caps_file),
+  [TG_COMPILE_CACHE_DIR] = CONFIG_OFFSET(compile_cache_dir),
 };
 
 static struct ejudge_cfg *
@@ -659,6 +670,7 @@ ejudge_cfg_do_parse(char const *path, FILE *in_file, int no_system_lookup)
   struct ejudge_cfg *cfg = 0;
   struct xml_attr *a;
   unsigned char **p_str;
+  int contests_workers_set = 0;
 
   xml_err_path = path;
   xml_err_spec = &ejudge_config_parse_spec;
@@ -802,6 +814,59 @@ ejudge_cfg_do_parse(char const *path, FILE *in_file, int no_system_lookup)
         }
       }
       break;
+    case TG_CONTESTS_WORKERS:
+      {
+        if (contests_workers_set) {
+          xml_err_elem_redefined(p);
+          goto failed;
+        }
+        if (p->text && p->text[0]) {
+          errno = 0;
+          char *eptr = NULL;
+          long k = strtol(p->text, &eptr, 10);
+          if (errno || *eptr || eptr == p->text || k < 0 || k > 256) {
+            xml_err_elem_invalid(p);
+            goto failed;
+          }
+          cfg->contests_workers = k;
+        }
+        contests_workers_set = 1;
+      }
+      break;
+    case TG_COMPILE_CACHE_SIZE:
+      {
+        if (cfg->compile_cache_size > 0) {
+          xml_err_elem_redefined(p);
+          goto failed;
+        }
+        if (p->text && p->text[0]) {
+          long long k = 0;
+          if (size_str_to_size64_t(p->text, &k) < 0 || k < 0) {
+            xml_err_elem_invalid(p);
+            goto failed;
+          }
+          cfg->compile_cache_size = k;
+        }
+      }
+      break;
+    case TG_CONTAINER_POOL_SIZE:
+      {
+        if (cfg->container_pool_size > 0) {
+          xml_err_elem_redefined(p);
+          goto failed;
+        }
+        if (p->text && p->text[0]) {
+          errno = 0;
+          char *eptr = NULL;
+          long k = strtol(p->text, &eptr, 10);
+          if (errno || *eptr || eptr == p->text || k < 0 || k > 1024) {
+            xml_err_elem_invalid(p);
+            goto failed;
+          }
+          cfg->container_pool_size = k;
+        }
+      }
+      break;
     default:
       xml_err_elem_not_allowed(p);
       break;
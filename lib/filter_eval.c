@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2002-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2002-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -27,6 +27,7 @@
 #include "ejudge/testing_report_xml.h"
 #include "ejudge/fileutl.h"
 #include "ejudge/misctext.h"
+#include "ejudge/run_test_summary.h"
 
 #include "ejudge/logger.h"
 #include "ejudge/mempage.h"
@@ -44,74 +45,137 @@ static unsigned char *envdup(struct filter_env *env,
   return s;
 }
 
-/* FIXME: dumb :( */
-static int
-is_latest(struct filter_env *env, int rid)
+struct filter_user_prob_marks
 {
-  int r;
+  int user_id;                 /* 0, if the entry is empty */
+  int prob_id;
+  int last_accepted;           /* last run with "accepted" status, -1, if none */
+  int last_marked;             /* last marked run, -1, if none */
+  int first_ok;                /* first OK run, -1, if none */
+};
 
-  if (rid < env->rbegin || rid >= env->rtotal) return 0;
-  switch (env->rentries[rid].status) {
+static int
+is_accepted_status(int status)
+{
+  switch (status) {
   case RUN_OK:
   case RUN_PARTIAL:
   case RUN_ACCEPTED:
   case RUN_PENDING_REVIEW:
   case RUN_SUMMONED:
-    break;
-  default:
-    return 0;
+    return 1;
+  }
+  return 0;
+}
+
+static struct filter_user_prob_marks *
+get_marks(struct filter_env *env, int user_id, int prob_id)
+{
+  unsigned index = ((unsigned) user_id * 2654435761U + (unsigned) prob_id * 40503U) & (env->marks_size - 1);
+  while (env->marks[index].user_id > 0) {
+    struct filter_user_prob_marks *m = &env->marks[index];
+    if (m->user_id == user_id && m->prob_id == prob_id) return m;
+    index = (index + 1) & (env->marks_size - 1);
+  }
+  return &env->marks[index];
+}
+
+static void
+alloc_marks(struct filter_env *env, int count)
+{
+  struct filter_user_prob_marks *old_marks = env->marks;
+  int old_size = env->marks_size;
+
+  env->marks_size = 16;
+  while (env->marks_size < 2 * (count + 1)) env->marks_size *= 2;
+  env->marks = filter_tree_alloc(env->mem, env->marks_size * sizeof(env->marks[0]));
+  for (int i = 0; i < old_size; ++i) {
+    if (old_marks[i].user_id > 0) {
+      *get_marks(env, old_marks[i].user_id, old_marks[i].prob_id) = old_marks[i];
+    }
   }
-  for (r = rid + 1; r < env->rtotal; r++) {
-    if (!run_is_normal_status(env->rentries[r].status)) continue;
-    if (env->rentries[rid].user_id != env->rentries[r].user_id
-        || env->rentries[rid].prob_id != env->rentries[r].prob_id)
-      continue;
-    switch (env->rentries[r].status) {
-    case RUN_OK:
-    case RUN_PARTIAL:
-    case RUN_ACCEPTED:
-    case RUN_PENDING_REVIEW:
-    case RUN_SUMMONED:
-      return 0;
+}
+
+/* one pass over the runs to collect the per (user_id, prob_id) markers */
+static void
+build_marks(struct filter_env *env)
+{
+  int r, count = 0;
+
+  // the table is sized by the number of (user_id, prob_id) pairs
+  if (env->serve_state && env->serve_state->runlog_state) {
+    count = run_get_user_prob_count(env->serve_state->runlog_state);
+  }
+  env->marks_used = 0;
+  alloc_marks(env, count);
+
+  for (r = env->rbegin; r < env->rtotal; r++) {
+    const struct run_entry *re = &env->rentries[r];
+    if (re->user_id <= 0) continue;
+    struct filter_user_prob_marks *m = get_marks(env, re->user_id, re->prob_id);
+    if (!m->user_id) {
+      if (2 * (env->marks_used + 1) >= env->marks_size) {
+        alloc_marks(env, 2 * env->marks_used);
+        m = get_marks(env, re->user_id, re->prob_id);
+      }
+      ++env->marks_used;
+      m->user_id = re->user_id;
+      m->prob_id = re->prob_id;
+      m->last_accepted = -1;
+      m->last_marked = -1;
+      m->first_ok = -1;
     }
+    if (run_is_normal_status(re->status) && is_accepted_status(re->status))
+      m->last_accepted = r;
+    if (re->is_marked) m->last_marked = r;
+    if (re->status == RUN_OK && m->first_ok < 0) m->first_ok = r;
   }
-  return 1;
 }
 
-/* FIXME: dumb :( */
+static const struct filter_user_prob_marks *
+find_marks(struct filter_env *env, int rid)
+{
+  if (!env->marks) build_marks(env);
+  const struct run_entry *re = &env->rentries[rid];
+  if (re->user_id <= 0) return NULL;
+  const struct filter_user_prob_marks *m = get_marks(env, re->user_id, re->prob_id);
+  if (!m->user_id) return NULL;
+  return m;
+}
+
+static int
+is_latest(struct filter_env *env, int rid)
+{
+  const struct filter_user_prob_marks *m;
+
+  if (rid < env->rbegin || rid >= env->rtotal) return 0;
+  if (!is_accepted_status(env->rentries[rid].status)) return 0;
+  if (!(m = find_marks(env, rid))) return 1;
+  return m->last_accepted <= rid;
+}
+
 static int
 is_latestmarked(struct filter_env *env, int rid)
 {
-  int r;
+  const struct filter_user_prob_marks *m;
 
   if (rid < env->rbegin || rid >= env->rtotal) return 0;
   if (!env->rentries[rid].is_marked) return 0;
-  for (r = rid + 1; r < env->rtotal; r++) {
-    if (env->rentries[rid].user_id == env->rentries[r].user_id
-        && env->rentries[rid].prob_id == env->rentries[r].prob_id
-        && env->rentries[r].is_marked) return 0;
-  }
-  return 1;
+  if (!(m = find_marks(env, rid))) return 1;
+  return m->last_marked <= rid;
 }
 
-/* FIXME: dumb :( */
 static int
 is_afterok(struct filter_env *env, int rid)
 {
-  int r;
+  const struct filter_user_prob_marks *m;
 
   if (rid < env->rbegin || rid >= env->rtotal) return 0;
   if (env->rentries[rid].status >= RUN_PSEUDO_FIRST
       && env->rentries[rid].status <= RUN_PSEUDO_LAST)
     return 0;
-  for (r = rid - 1; r >= 0; r--) {
-    if (env->rentries[r].status != RUN_OK) continue;
-    if (env->rentries[rid].user_id != env->rentries[r].user_id
-        || env->rentries[rid].prob_id != env->rentries[r].prob_id)
-      continue;
-    return 1;
-  }
-  return 0;
+  if (!(m = find_marks(env, rid))) return 0;
+  return m->first_ok >= 0 && m->first_ok < rid;
 }
 
 static int
@@ -160,6 +224,10 @@ has_test_result(
   if (!env || !(cs = env->serve_state) || !(g = cs->global)) goto cleanup;
   if (!run_is_normal_or_transient_status(re->status)) goto cleanup;
 
+  if ((retval = run_test_summary_has_status(run_test_summary_get(cs, re), result)) >= 0)
+    return retval;
+  retval = 0;
+
   rep_flag = serve_make_xml_report_read_path(cs, rep_path, sizeof(rep_path), re);
   if (rep_flag < 0) goto cleanup;
   if (re->store_flags == STORE_FLAGS_UUID_BSON) {
@@ -169,6 +237,10 @@ has_test_result(
     if (get_content_type(rep_txt, &start_ptr) != CONTENT_TYPE_XML) goto cleanup;
     if (!(rep_xml = testing_report_parse_xml(start_ptr))) goto cleanup;
   }
+  // remember the summary, so the report is not parsed again
+  struct run_test_summary rts;
+  run_test_summary_make(&rts, re, rep_xml);
+  run_test_summary_store(cs, re->run_id, &rts);
   if (rep_xml->run_tests <= 0) goto cleanup;
   for (int i = 0; i < rep_xml->run_tests; ++i) {
     const struct testing_report_test *rep_tst = rep_xml->tests[i];
@@ -1131,3 +1203,310 @@ filter_tree_bool_eval(struct filter_env *env,
   ASSERT(res->kind == TOK_BOOL_L);
   return res->v.b;
 }
+
+/*
+ * filter programs: the tree is flattened into the postfix order,
+ * so the evaluation needs no recursion and no memory allocation
+ * except for string values
+ */
+enum
+{
+  FILTER_OP_CONST = 1,          /* push the literal node */
+  FILTER_OP_EVAL,               /* evaluate the node over arity stack values */
+  FILTER_OP_JUMP_FALSE,         /* jump if the top is false, pop otherwise */
+  FILTER_OP_JUMP_TRUE,          /* jump if the top is true, pop otherwise */
+  FILTER_OP_INUSERGROUP,        /* check the user group given by name */
+  FILTER_OP_COLUMN,             /* the field of the current run */
+};
+
+struct filter_insn
+{
+  int op;
+  int arg;                      /* arity or jump target */
+  struct filter_tree *node;
+};
+
+struct filter_program
+{
+  int size;
+  int max_depth;
+  struct filter_insn *insns;
+};
+
+static int
+node_arity(int kind)
+{
+  switch (kind) {
+  case TOK_LOGOR: case TOK_LOGAND:
+  case '^': case '|': case '&': case '*': case '/': case '%': case '+':
+  case '-': case '>': case '<': case TOK_EQ: case TOK_NE: case TOK_LE:
+  case TOK_GE: case TOK_ASL: case TOK_ASR: case TOK_REGEXP:
+  case TOK_EXAMINATOR:
+    return 2;
+
+  case '~': case '!': case TOK_UN_MINUS:
+  case TOK_INT: case TOK_STRING: case TOK_BOOL: case TOK_TIME_T:
+  case TOK_DUR_T: case TOK_SIZE_T: case TOK_RESULT_T: case TOK_HASH_T:
+  case TOK_IP_T:
+  case TOK_TIME: case TOK_DUR: case TOK_SIZE: case TOK_HASH: case TOK_UUID:
+  case TOK_IP: case TOK_PROB: case TOK_UID: case TOK_LOGIN: case TOK_NAME:
+  case TOK_GROUP: case TOK_LANG: case TOK_ARCH: case TOK_RESULT:
+  case TOK_SCORE: case TOK_SCORE_ADJ: case TOK_TEST: case TOK_IMPORTED:
+  case TOK_HIDDEN: case TOK_READONLY: case TOK_MARKED: case TOK_SAVED:
+  case TOK_VARIANT: case TOK_RAWVARIANT: case TOK_USERINVISIBLE:
+  case TOK_USERBANNED: case TOK_USERLOCKED: case TOK_USERINCOMPLETE:
+  case TOK_USERDISQUALIFIED: case TOK_USERPRIVILEGED:
+  case TOK_USERREG_READONLY: case TOK_LATEST: case TOK_LATESTMARKED:
+  case TOK_AFTEROK: case TOK_EXAMINABLE: case TOK_CYPHER:
+  case TOK_MISSINGSOURCE: case TOK_JUDGE_ID: case TOK_PASSED_MODE:
+  case TOK_EOLN_TYPE: case TOK_STORE_FLAGS: case TOK_TOKEN_FLAGS:
+  case TOK_TOKEN_COUNT:
+  case TOK_CUREXAMINATOR: case TOK_CURHAS_TEST_RESULT:
+  case TOK_INUSERGROUP: case TOK_INUSERGROUPINT:
+    return 1;
+  }
+  return 0;
+}
+
+static int
+is_literal(const struct filter_tree *t)
+{
+  switch (t->kind) {
+  case TOK_INT_L: case TOK_STRING_L: case TOK_BOOL_L: case TOK_TIME_L:
+  case TOK_DUR_L: case TOK_SIZE_L: case TOK_RESULT_L: case TOK_HASH_L:
+  case TOK_IP_L:
+    return 1;
+  }
+  return 0;
+}
+
+/* the operations, which do not depend on the run and the environment */
+static int
+is_pure_operation(int kind)
+{
+  switch (kind) {
+  case '^': case '|': case '&': case '*': case '/': case '%': case '+':
+  case '-': case '>': case '<': case TOK_EQ: case TOK_NE: case TOK_LE:
+  case TOK_GE: case TOK_ASL: case TOK_ASR: case TOK_REGEXP:
+  case '~': case '!': case TOK_UN_MINUS:
+  case TOK_INT: case TOK_STRING: case TOK_BOOL: case TOK_TIME_T:
+  case TOK_DUR_T: case TOK_SIZE_T: case TOK_RESULT_T: case TOK_HASH_T:
+  case TOK_IP_T:
+    return 1;
+  }
+  return 0;
+}
+
+/* the fields of the current run, which are kept in the run columns */
+static int
+is_column_field(int kind)
+{
+  switch (kind) {
+  case TOK_CURTIME: case TOK_CURDUR: case TOK_CURUID: case TOK_CURRESULT:
+  case TOK_CURSCORE: case TOK_CURHIDDEN:
+    return 1;
+  }
+  return 0;
+}
+
+/* like do_eval, but reads the field from the run columns */
+static void
+eval_column(const struct filter_env *env, int kind, struct filter_tree *res)
+{
+  const struct run_columns *rc = env->columns;
+  int rid = env->rid;
+
+  memset(res, 0, sizeof(*res));
+  switch (kind) {
+  case TOK_CURTIME:
+    res->kind = TOK_TIME_L;
+    res->type = FILTER_TYPE_TIME;
+    res->v.a = rc->time[rid];
+    break;
+  case TOK_CURDUR:
+    res->kind = TOK_DUR_L;
+    res->type = FILTER_TYPE_DUR;
+    res->v.u = rc->time[rid] - env->rhead.start_time;
+    break;
+  case TOK_CURUID:
+    res->kind = TOK_INT_L;
+    res->type = FILTER_TYPE_INT;
+    res->v.i = rc->user_id[rid];
+    break;
+  case TOK_CURRESULT:
+    res->kind = TOK_RESULT_L;
+    res->type = FILTER_TYPE_RESULT;
+    res->v.r = rc->status[rid];
+    break;
+  case TOK_CURSCORE:
+    res->kind = TOK_INT_L;
+    res->type = FILTER_TYPE_INT;
+    res->v.i = rc->score[rid];
+    break;
+  case TOK_CURHIDDEN:
+    res->kind = TOK_BOOL_L;
+    res->type = FILTER_TYPE_BOOL;
+    res->v.b = rc->is_hidden[rid];
+    break;
+  default:
+    SWERR(("unhandled kind: %d", kind));
+  }
+}
+
+static int
+count_nodes(const struct filter_tree *t)
+{
+  int arity = node_arity(t->kind), count = 1;
+  for (int i = 0; i < arity; ++i)
+    count += count_nodes(t->v.t[i]);
+  return count;
+}
+
+/* returns the tree with the constant subexpressions folded into literals */
+static struct filter_tree *
+fold_constants(struct filter_tree_mem *mem, struct filter_tree *t)
+{
+  int arity = node_arity(t->kind);
+  struct filter_tree *a[2] = { 0, 0 };
+  struct filter_tree res;
+
+  if (!arity) return t;
+  for (int i = 0; i < arity; ++i)
+    a[i] = fold_constants(mem, t->v.t[i]);
+
+  if (t->kind == TOK_LOGAND || t->kind == TOK_LOGOR) {
+    if (a[0]->kind == TOK_BOOL_L) {
+      if (!!a[0]->v.b == (t->kind == TOK_LOGOR)) return a[0];
+      return a[1];
+    }
+  } else if (is_pure_operation(t->kind)
+             && is_literal(a[0]) && (arity < 2 || is_literal(a[1]))) {
+    // on error the expression is left as is to report it at run time
+    if (filter_tree_eval_node(mem, t->kind, &res, a[0], a[1]) >= 0) {
+      struct filter_tree *p = filter_tree_alloc(mem, sizeof(*p));
+      *p = res;
+      return p;
+    }
+  }
+
+  if (a[0] == t->v.t[0] && (arity < 2 || a[1] == t->v.t[1])) return t;
+  struct filter_tree *p = filter_tree_alloc(mem, sizeof(*p));
+  *p = *t;
+  for (int i = 0; i < arity; ++i)
+    p->v.t[i] = a[i];
+  return p;
+}
+
+static void
+emit_code(struct filter_program *prog, struct filter_tree *t, int depth)
+{
+  int arity = node_arity(t->kind);
+  struct filter_insn *insn;
+
+  if (depth + 1 > prog->max_depth) prog->max_depth = depth + 1;
+  if (is_literal(t)) {
+    insn = &prog->insns[prog->size++];
+    insn->op = FILTER_OP_CONST;
+    insn->node = t;
+    return;
+  }
+  if (t->kind == TOK_LOGAND || t->kind == TOK_LOGOR) {
+    emit_code(prog, t->v.t[0], depth);
+    int jump = prog->size++;
+    prog->insns[jump].op = (t->kind == TOK_LOGAND)?FILTER_OP_JUMP_FALSE:FILTER_OP_JUMP_TRUE;
+    emit_code(prog, t->v.t[1], depth);
+    prog->insns[jump].arg = prog->size;
+    return;
+  }
+
+  for (int i = 0; i < arity; ++i)
+    emit_code(prog, t->v.t[i], depth + i);
+  insn = &prog->insns[prog->size++];
+  if (t->kind == TOK_INUSERGROUP) {
+    insn->op = FILTER_OP_INUSERGROUP;
+  } else if (is_column_field(t->kind)) {
+    insn->op = FILTER_OP_COLUMN;
+  } else {
+    insn->op = FILTER_OP_EVAL;
+  }
+  insn->arg = arity;
+  insn->node = t;
+}
+
+struct filter_program *
+filter_program_compile(struct filter_tree_mem *mem, struct filter_tree *t)
+{
+  struct filter_program *prog;
+
+  ASSERT(t);
+  ASSERT(t->type == FILTER_TYPE_BOOL);
+  t = fold_constants(mem, t);
+  prog = filter_tree_alloc(mem, sizeof(*prog));
+  prog->insns = filter_tree_alloc(mem, count_nodes(t) * sizeof(prog->insns[0]));
+  emit_code(prog, t, 0);
+  return prog;
+}
+
+int
+filter_program_bool_eval(struct filter_env *env,
+                         const struct filter_program *prog)
+{
+  struct filter_tree *stack, node, res;
+  int sp = 0, pc = 0, c;
+
+  XALLOCA(stack, prog->max_depth);
+  env->cur = &env->rentries[env->rid];
+  while (pc < prog->size) {
+    const struct filter_insn *insn = &prog->insns[pc++];
+    switch (insn->op) {
+    case FILTER_OP_CONST:
+      stack[sp++] = *insn->node;
+      break;
+    case FILTER_OP_EVAL:
+      if (!insn->arg) {
+        if ((c = do_eval(env, insn->node, &res)) < 0) return c;
+      } else {
+        // the arguments are literals on the stack, do_eval just copies them
+        node = *insn->node;
+        sp -= insn->arg;
+        for (int i = 0; i < insn->arg; ++i)
+          node.v.t[i] = &stack[sp + i];
+        if ((c = do_eval(env, &node, &res)) < 0) return c;
+      }
+      stack[sp++] = res;
+      break;
+    case FILTER_OP_JUMP_FALSE:
+      ASSERT(stack[sp - 1].kind == TOK_BOOL_L);
+      if (!stack[sp - 1].v.b) pc = insn->arg;
+      else --sp;
+      break;
+    case FILTER_OP_JUMP_TRUE:
+      ASSERT(stack[sp - 1].kind == TOK_BOOL_L);
+      if (stack[sp - 1].v.b) pc = insn->arg;
+      else --sp;
+      break;
+    case FILTER_OP_INUSERGROUP:
+      ASSERT(stack[sp - 1].kind == TOK_STRING_L);
+      if ((c = find_user_group(env, stack[sp - 1].v.s)) < 0) return c;
+      memset(&res, 0, sizeof(res));
+      res.kind = TOK_BOOL_L;
+      res.type = FILTER_TYPE_BOOL;
+      res.v.b = check_user_group(env, env->cur->user_id, c);
+      stack[sp - 1] = res;
+      break;
+    case FILTER_OP_COLUMN:
+      if (env->columns) {
+        eval_column(env, insn->node->kind, &res);
+      } else if ((c = do_eval(env, insn->node, &res)) < 0) {
+        return c;
+      }
+      stack[sp++] = res;
+      break;
+    default:
+      SWERR(("unhandled op: %d", insn->op));
+    }
+  }
+  ASSERT(sp == 1);
+  ASSERT(stack[0].kind == TOK_BOOL_L);
+  return stack[0].v.b;
+}
@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2000-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2000-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -1104,6 +1104,16 @@ get_problem_map(
   *p_p_tot = p_tot;
 }
 
+/*
+ * Unlike the ACM standings (see acm_standings_update), the cells are
+ * recomputed from the whole runlog for each page. A cell depends on
+ * the viewer and the page time, not only on the runs of the cell:
+ * the own tokens and the saved scores in user_mode, accepting_mode,
+ * the per-user durations of virtual contests, the upsolving rules and
+ * the run filter. Cached cells would have to be kept for each such
+ * combination, so only the run scan itself is made cheaper by reading
+ * the run columns.
+ */
 void
 do_write_kirov_standings(
         const serve_state_t state,
@@ -1164,6 +1174,7 @@ do_write_kirov_standings(
   unsigned char *head_style;
   struct teamdb_export u_info;
   const struct run_entry *runs;
+  struct run_columns rc;
   int ttot_att, ttot_succ, perc, t;
   const struct team_extra *t_extra;
   const unsigned char *row_attr = 0;
@@ -1281,6 +1292,7 @@ do_write_kirov_standings(
   r_beg = run_get_first(state->runlog_state);
   r_tot = run_get_total(state->runlog_state);
   runs = run_get_entries_ptr(state->runlog_state);
+  run_get_columns(state->runlog_state, &rc);
 
   /* prune participants, which did not send any solution */
   /* t_runs - 1, if the participant should remain */
@@ -1292,12 +1304,12 @@ do_write_kirov_standings(
   t_runs = alloca(t_max);
   if (global->prune_empty_users || global->disable_user_database > 0) {
     memset(t_runs, 0, t_max);
-    for (k = r_beg; k < r_tot; k++) {
-      if (runs[k].status == RUN_EMPTY || runs[k].status == RUN_VIRTUAL_START
-          || runs[k].status == RUN_VIRTUAL_STOP) continue;
-      if (runs[k].is_hidden) continue;
-      if(runs[k].user_id <= 0 && runs[k].user_id >= t_max) continue;
-      t_runs[runs[k].user_id] = 1;
+    for (k = rc.first; k < rc.total; k++) {
+      if (rc.status[k] == RUN_EMPTY || rc.status[k] == RUN_VIRTUAL_START
+          || rc.status[k] == RUN_VIRTUAL_STOP) continue;
+      if (rc.is_hidden[k]) continue;
+      if (rc.user_id[k] <= 0 || rc.user_id[k] >= t_max) continue;
+      t_runs[rc.user_id[k]] = 1;
     }
   } else {
     memset(t_runs, 1, t_max);
@@ -1446,13 +1458,16 @@ do_write_kirov_standings(
     int pind;
     int score, run_score, run_tests, run_status;
     int run_virtual_upsolved = 0;
-    const struct run_entry *pe = &runs[k];
 
-    if (pe->status == RUN_VIRTUAL_START || pe->status == RUN_VIRTUAL_STOP
-        || pe->status == RUN_EMPTY) continue;
-    if (pe->user_id <= 0 || pe->user_id >= t_max) continue;
-    if (pe->prob_id <= 0 || pe->prob_id > state->max_prob) continue;
-    if (pe->is_hidden) continue;
+    // the runs which do not count are skipped using the columns only
+    if (rc.status[k] == RUN_VIRTUAL_START || rc.status[k] == RUN_VIRTUAL_STOP
+        || rc.status[k] == RUN_EMPTY) continue;
+    if (rc.user_id[k] <= 0 || rc.user_id[k] >= t_max) continue;
+    if (rc.prob_id[k] <= 0 || rc.prob_id[k] > state->max_prob) continue;
+    if (rc.is_hidden[k]) continue;
+    if (t_rev[rc.user_id[k]] < 0 || p_rev[rc.prob_id[k]] < 0) continue;
+
+    const struct run_entry *pe = &runs[k];
     if (user_filter && user_filter->stand_run_tree) {
       env.rid = k;
       if (filter_tree_bool_eval(&env, user_filter->stand_run_tree) <= 0)
@@ -2830,6 +2845,11 @@ write_moscow_page_table(const struct standings_style *pss,
   fprintf(f, "</tr></table>\n");
 }
 
+/*
+ * The cells are recomputed from the whole runlog for each page, as in
+ * do_write_kirov_standings: the results depend on the viewer (user_mode,
+ * the per-user virtual durations) and on the run filter.
+ */
 void
 do_write_moscow_standings(
         const serve_state_t state,
@@ -2863,6 +2883,7 @@ do_write_moscow_standings(
   int r_beg;                    /* the first available run */
   int r_tot;                    /* total number of runs */
   const struct run_entry *runs; /* the pointer to the PRIMARY runs storage */
+  struct run_columns rc;        /* the hot fields of the runs */
   int u_max;                    /* maximal user_id + 1 */
   int u_tot;                    /* total active users */
   unsigned char *u_runs = 0;    /* whether user submitted runs (on stack) */
@@ -3002,6 +3023,7 @@ do_write_moscow_standings(
   r_beg = run_get_first(state->runlog_state);
   r_tot = run_get_total(state->runlog_state);
   runs = run_get_entries_ptr(state->runlog_state);
+  run_get_columns(state->runlog_state, &rc);
 
   if (global->disable_user_database > 0) {
     u_max = run_get_max_user_id(state->runlog_state) + 1;
@@ -3011,11 +3033,11 @@ do_write_moscow_standings(
   u_runs = (unsigned char*) alloca(u_max);
   if (global->prune_empty_users || global->disable_user_database > 0) {
     memset(u_runs, 0, u_max);
-    for (i = r_beg; i < r_tot; i++)
-      if (runs[i].status != RUN_EMPTY
-          && runs[i].user_id > 0 && runs[i].user_id < u_max
-          && !runs[i].is_hidden)
-        u_runs[runs[i].user_id] = 1;
+    for (i = rc.first; i < rc.total; i++)
+      if (rc.status[i] != RUN_EMPTY
+          && rc.user_id[i] > 0 && rc.user_id[i] < u_max
+          && !rc.is_hidden[i])
+        u_runs[rc.user_id[i]] = 1;
   } else {
     memset(u_runs, 1, u_max);
   }
@@ -3116,15 +3138,17 @@ do_write_moscow_standings(
   }
 
   for (i = r_beg; i < r_tot; i++) {
-    const struct run_entry *pe = &runs[i];
-    time_t run_time = pe->time;
     int up_ind;
 
-    if (pe->is_hidden) continue;
-    if (!run_is_normal_or_transient_status(pe->status)) continue;
-    if (pe->user_id <= 0 || pe->user_id >= u_max || (u = u_rev[pe->user_id]) < 0) continue;
-    if (pe->prob_id <= 0 || pe->prob_id > state->max_prob) continue;
-    if ((p = p_rev[pe->prob_id]) < 0) continue;
+    // the runs which do not count are skipped using the columns only
+    if (rc.is_hidden[i]) continue;
+    if (!run_is_normal_or_transient_status(rc.status[i])) continue;
+    if (rc.user_id[i] <= 0 || rc.user_id[i] >= u_max || (u = u_rev[rc.user_id[i]]) < 0) continue;
+    if (rc.prob_id[i] <= 0 || rc.prob_id[i] > state->max_prob) continue;
+    if ((p = p_rev[rc.prob_id[i]]) < 0) continue;
+
+    const struct run_entry *pe = &runs[i];
+    time_t run_time = pe->time;
     if (user_filter && user_filter->stand_run_tree) {
       env.rid = i;
       if (filter_tree_bool_eval(&env, user_filter->stand_run_tree) <= 0)
@@ -3772,6 +3796,199 @@ do_write_moscow_standings(
 /*
  * ACM-style standings
  */
+static struct serve_acm_cell *
+acm_cell_get(struct serve_acm_standings *as, int user_id, int prob_id)
+{
+  if (2 * (as->hash_used + 1) >= as->hash_size) {
+    int new_size = as->hash_size * 2;
+    if (!new_size) new_size = 1024;
+    struct serve_acm_cell *new_cells = NULL;
+    XCALLOC(new_cells, new_size);
+    for (int i = 0; i < as->hash_size; ++i) {
+      const struct serve_acm_cell *cur = &as->cells[i];
+      if (cur->user_id <= 0) continue;
+      unsigned index = ((unsigned) cur->user_id * 2654435761U + (unsigned) cur->prob_id) & (new_size - 1);
+      while (new_cells[index].user_id > 0) {
+        index = (index + 1) & (new_size - 1);
+      }
+      new_cells[index] = *cur;
+    }
+    xfree(as->cells);
+    as->cells = new_cells;
+    as->hash_size = new_size;
+  }
+
+  unsigned index = ((unsigned) user_id * 2654435761U + (unsigned) prob_id) & (as->hash_size - 1);
+  while (as->cells[index].user_id > 0) {
+    struct serve_acm_cell *c = &as->cells[index];
+    if (c->user_id == user_id && c->prob_id == prob_id) return c;
+    index = (index + 1) & (as->hash_size - 1);
+  }
+  struct serve_acm_cell *c = &as->cells[index];
+  c->user_id = user_id;
+  c->prob_id = prob_id;
+  c->ok_run_id = -1;
+  c->update_serial = -1;
+  ++as->hash_used;
+  return c;
+}
+
+static void
+acm_cell_reset(struct serve_acm_cell *c)
+{
+  c->calc = 0;
+  c->att_count = 0;
+  c->ok_run_id = -1;
+  c->trans_flag = 0;
+  c->pr_flag = 0;
+  c->disq_flag = 0;
+  c->cf_flag = 0;
+}
+
+/* the same as the run scanning loop of do_write_standings for one run */
+static void
+acm_cell_fold_run(
+        const serve_state_t state,
+        struct serve_acm_standings *as,
+        struct serve_acm_cell *c,
+        const struct run_entry *pe,
+        int run_id)
+{
+  const struct section_problem_data *prob = state->probs[pe->prob_id];
+  time_t run_time = pe->time;
+
+  if (pe->status == RUN_VIRTUAL_START || pe->status == RUN_VIRTUAL_STOP
+      || pe->status == RUN_EMPTY) return;
+  if (pe->is_hidden) return;
+  if (!prob) return;
+
+  if (run_time < as->start_time) run_time = as->start_time;
+  if (run_time - as->start_time > as->max_run_dur) {
+    as->max_run_dur = run_time - as->start_time;
+  }
+  if (as->cutoff_dur > 0 && run_time - as->start_time > as->cutoff_dur) return;
+  if (as->ignore_after > 0 && pe->time >= as->ignore_after) return;
+
+  if (pe->status == RUN_OK) {
+    if (c->calc > 0) return;
+    c->calc = 1 - c->calc;
+    c->att_count++;
+    c->ok_run_id = run_id;
+  } else if (pe->status == RUN_COMPILE_ERR && !prob->ignore_compile_errors) {
+    if (c->calc <= 0) {
+      c->calc--;
+      c->att_count++;
+    }
+  } else if (run_is_failed_attempt(pe->status)) {
+    if (c->calc <= 0) {
+      c->calc--;
+      c->att_count++;
+    }
+  } else if (pe->status == RUN_DISQUALIFIED) {
+    c->disq_flag = 1;
+  } else if (pe->status == RUN_PENDING_REVIEW || pe->status == RUN_SUMMONED) {
+    c->pr_flag = 1;
+  } else if (pe->status == RUN_PENDING || pe->status == RUN_ACCEPTED) {
+    c->trans_flag = 1;
+  } else if (pe->status >= RUN_TRANSIENT_FIRST
+             && pe->status <= RUN_TRANSIENT_LAST) {
+    c->trans_flag = 1;
+  } else if (pe->status == RUN_CHECK_FAILED) {
+    c->cf_flag = 1;
+  }
+}
+
+/*
+ * brings the ACM standings cells up to date with the runlog:
+ * only the cells of the runs changed since the last call are rebuilt,
+ * everything is rebuilt if the change journal is not available or
+ * the view parameters change
+ */
+static struct serve_acm_standings *
+acm_standings_update(
+        const serve_state_t state,
+        int is_public,
+        time_t start_time,
+        time_t current_dur)
+{
+  const struct section_global_data *global = state->global;
+  runlog_state_t rs = state->runlog_state;
+  time_t ignore_after = 0;
+  int full_update = 0;
+
+  if (is_public) {
+    if (global->stand_ignore_after > 0) ignore_after = global->stand_ignore_after;
+  } else {
+    current_dur = 0;
+  }
+
+  struct serve_acm_standings *as = state->acm_standings[is_public];
+  if (!as) {
+    XCALLOC(as, 1);
+    as->change_serial = -1;
+    state->acm_standings[is_public] = as;
+  }
+
+  int64_t cur_serial = run_get_change_serial(rs);
+  if (as->change_serial < 0 || as->start_time != start_time
+      || as->ignore_after != ignore_after) {
+    full_update = 1;
+  } else {
+    // the cutoff does not matter, if no run is after it
+    time_t old_cutoff = as->cutoff_dur;
+    time_t new_cutoff = current_dur;
+    if (old_cutoff > 0 && old_cutoff >= as->max_run_dur) old_cutoff = 0;
+    if (new_cutoff > 0 && new_cutoff >= as->max_run_dur) new_cutoff = 0;
+    if (old_cutoff != new_cutoff) full_update = 1;
+  }
+  for (int64_t serial = as->change_serial; !full_update && serial < cur_serial; ++serial) {
+    if (run_get_changed_run_id(rs, serial) < 0) full_update = 1;
+  }
+
+  as->start_time = start_time;
+  as->cutoff_dur = current_dur;
+  as->ignore_after = ignore_after;
+
+  int r_beg = run_get_first(rs);
+  int r_tot = run_get_total(rs);
+  const struct run_entry *runs = run_get_entries_ptr(rs);
+
+  if (full_update) {
+    if (as->cells) memset(as->cells, 0, as->hash_size * sizeof(as->cells[0]));
+    as->hash_used = 0;
+    as->max_run_dur = 0;
+    struct run_columns rc;
+    run_get_columns(rs, &rc);
+    for (int k = r_beg; k < r_tot; ++k) {
+      if (rc.user_id[k] <= 0 || rc.prob_id[k] <= 0 || rc.prob_id[k] > state->max_prob) continue;
+      if (rc.status[k] == RUN_VIRTUAL_START || rc.status[k] == RUN_VIRTUAL_STOP
+          || rc.status[k] == RUN_EMPTY) continue;
+      const struct run_entry *pe = &runs[k];
+      struct serve_acm_cell *c = acm_cell_get(as, pe->user_id, pe->prob_id);
+      c->update_serial = cur_serial;
+      acm_cell_fold_run(state, as, c, pe, k);
+    }
+  } else {
+    for (int64_t serial = as->change_serial; serial < cur_serial; ++serial) {
+      int run_id = run_get_changed_run_id(rs, serial);
+      if (run_id < r_beg || run_id >= r_tot) continue;
+      const struct run_entry *pe = &runs[run_id];
+      if (pe->user_id <= 0 || pe->prob_id <= 0 || pe->prob_id > state->max_prob) continue;
+      struct serve_acm_cell *c = acm_cell_get(as, pe->user_id, pe->prob_id);
+      if (c->update_serial == cur_serial) continue;
+      c->update_serial = cur_serial;
+      acm_cell_reset(c);
+      for (int k = run_get_user_prob_first_run_id(rs, pe->user_id, pe->prob_id);
+           k >= r_beg; k = run_get_user_prob_next_run_id(rs, k)) {
+        acm_cell_fold_run(state, as, c, &runs[k], k);
+      }
+    }
+  }
+  as->change_serial = cur_serial;
+
+  return as;
+}
+
 void
 do_write_standings(
         const serve_state_t state,
@@ -3826,6 +4043,7 @@ do_write_standings(
   unsigned char *head_style;
   struct teamdb_export ttt;
   const struct run_entry *runs, *pe;
+  struct run_columns rc;
   unsigned char *t_runs = 0;
   int last_success_run = -1;
   time_t last_success_time = 0;
@@ -3847,6 +4065,7 @@ do_write_standings(
   struct html_armor_buffer ab = HTML_ARMOR_INITIALIZER;
   struct filter_env env;
   struct xuser_team_extras *extras = NULL;
+  struct serve_acm_standings *as = NULL;
 
   memset(&env, 0, sizeof(env));
 
@@ -3913,6 +4132,7 @@ do_write_standings(
   r_beg = run_get_first(state->runlog_state);
   r_tot = run_get_total(state->runlog_state);
   runs = run_get_entries_ptr(state->runlog_state);
+  run_get_columns(state->runlog_state, &rc);
 
   if (global->disable_user_database > 0) {
     t_max = run_get_max_user_id(state->runlog_state) + 1;
@@ -3922,11 +4142,11 @@ do_write_standings(
   t_runs = alloca(t_max);
   if (global->prune_empty_users || global->disable_user_database > 0) {
     memset(t_runs, 0, t_max);
-    for (k = r_beg; k < r_tot; k++) {
-      if (runs[k].status == RUN_EMPTY) continue;
-      if (runs[k].user_id <= 0 || runs[k].user_id >= t_max) continue;
-      if (runs[k].is_hidden) continue;
-      t_runs[runs[k].user_id] = 1;
+    for (k = rc.first; k < rc.total; k++) {
+      if (rc.status[k] == RUN_EMPTY) continue;
+      if (rc.user_id[k] <= 0 || rc.user_id[k] >= t_max) continue;
+      if (rc.is_hidden[k]) continue;
+      t_runs[rc.user_id[k]] = 1;
     }
   } else {
     memset(t_runs, 1, t_max);
@@ -4010,98 +4230,147 @@ do_write_standings(
     env.rid = 0;
   }
 
-  /* now scan runs log */
-  for (k = r_beg; k < r_tot; k++) {
-    pe = &runs[k];
-    run_time = pe->time;
-    if (pe->status == RUN_VIRTUAL_START || pe->status == RUN_VIRTUAL_STOP
-        || pe->status == RUN_EMPTY) continue;
-    if (pe->user_id <= 0 || pe->user_id >= t_max || t_rev[pe->user_id] < 0) continue;
-    if (pe->prob_id <= 0 || pe->prob_id > state->max_prob || p_rev[pe->prob_id] < 0)
-      continue;
-    if (!state->probs[pe->prob_id] || state->probs[pe->prob_id]->hidden) continue;
-    if (pe->is_hidden) continue;
-    if (user_filter && user_filter->stand_run_tree) {
-      env.rid = k;
-      if (filter_tree_bool_eval(&env, user_filter->stand_run_tree) <= 0)
-        continue;
+  /* ACM standings cells are maintained incrementally, if possible */
+  if (!global->is_virtual && !(user_filter && user_filter->stand_run_tree)) {
+    for (i = 1; i < p_max; i++) {
+      if (state->probs[i] && state->probs[i]->stand_column) break;
+    }
+    if (i >= p_max) {
+      as = acm_standings_update(state, client_flag != 1 || user_id, start_time, current_dur);
+    }
+  }
+  if (as) {
+    for (i = 0; i < as->hash_size; i++) {
+      const struct serve_acm_cell *c = &as->cells[i];
+      if (c->user_id <= 0) continue;
+      if (c->user_id >= t_max || t_rev[c->user_id] < 0) continue;
+      if (p_rev[c->prob_id] < 0) continue;
+      if (!state->probs[c->prob_id] || state->probs[c->prob_id]->hidden) continue;
+      prob = state->probs[c->prob_id];
+      tt = t_rev[c->user_id];
+      pp = p_rev[c->prob_id];
+      up_ind = (tt << row_sh) + pp;
+
+      calc[up_ind] = c->calc;
+      trans_flag[up_ind] = c->trans_flag;
+      pr_flag[up_ind] = c->pr_flag;
+      disq_flag[up_ind] = c->disq_flag;
+      cf_flag[up_ind] = c->cf_flag;
+      tot_att[pp] += c->att_count;
+      if (c->calc <= 0) continue;
+
+      t_pen[tt] += prob->acm_run_penalty * (c->calc - 1);
+      t_prob[tt]++;
+      succ_att[pp]++;
+      run_time = runs[c->ok_run_id].time;
+      if (run_time < start_time) run_time = start_time;
+      ok_time[up_ind] = sec_to_min(global->rounding_mode, run_time - start_time);
+      if (!global->ignore_success_time) t_pen[tt] += ok_time[up_ind];
+      if (c->ok_run_id > last_success_run) {
+        last_success_run = c->ok_run_id;
+        last_success_time = run_time;
+        last_success_start = start_time;
+      }
     }
-    prob = state->probs[pe->prob_id];
+  }
 
-    if (global->is_virtual) {
-      // filter "future" virtual runs
-      tstart = run_get_virtual_start_time(state->runlog_state, pe->user_id);
-      ASSERT(run_time >= tstart);
-      tdur = run_time - tstart;
-      ASSERT(tdur <= contest_dur);
-      if (user_id > 0 && tdur > current_dur) continue;
-    } else {
-      // for a regular contest --- filter future runs for
-      // unprivileged standings
-      // client_flag == 1 && user_id == 0 --- privileged standings
-      if (client_flag != 1 || user_id) {
-        if (run_time < start_time) run_time = start_time;
-        if (current_dur > 0 && run_time - start_time > current_dur) continue;
-        if (global->stand_ignore_after > 0
-            && pe->time >= global->stand_ignore_after)
+  /* now scan runs log */
+  if (!as) {
+    for (k = r_beg; k < r_tot; k++) {
+      // the runs which do not count are skipped using the columns only
+      if (rc.status[k] == RUN_VIRTUAL_START || rc.status[k] == RUN_VIRTUAL_STOP
+          || rc.status[k] == RUN_EMPTY) continue;
+      if (rc.user_id[k] <= 0 || rc.user_id[k] >= t_max || t_rev[rc.user_id[k]] < 0) continue;
+      if (rc.prob_id[k] <= 0 || rc.prob_id[k] > state->max_prob || p_rev[rc.prob_id[k]] < 0)
+        continue;
+      if (!state->probs[rc.prob_id[k]] || state->probs[rc.prob_id[k]]->hidden) continue;
+      if (rc.is_hidden[k]) continue;
+      pe = &runs[k];
+      run_time = pe->time;
+      if (user_filter && user_filter->stand_run_tree) {
+        env.rid = k;
+        if (filter_tree_bool_eval(&env, user_filter->stand_run_tree) <= 0)
           continue;
       }
-    }
-    tt = t_rev[pe->user_id];
-    pp = p_rev[pe->prob_id];
-    up_ind = (tt << row_sh) + pp;
+      prob = state->probs[pe->prob_id];
 
-    if (pe->status == RUN_OK) {
-      /* program accepted */
-      if (calc[up_ind] > 0) continue;
-
-      last_success_run = k;
-      t_pen[tt] += state->probs[pe->prob_id]->acm_run_penalty * - calc[up_ind];
-      calc[up_ind] = 1 - calc[up_ind];
-      t_prob[tt]++;
-      succ_att[pp]++;
-      tot_att[pp]++;
       if (global->is_virtual) {
-        ok_time[up_ind] = sec_to_min(global->rounding_mode, tdur);
-        if (!global->ignore_success_time) t_pen[tt] += ok_time[up_ind];
-        last_success_time = run_time;
-        last_success_start = tstart;
+        // filter "future" virtual runs
+        tstart = run_get_virtual_start_time(state->runlog_state, pe->user_id);
+        ASSERT(run_time >= tstart);
+        tdur = run_time - tstart;
+        ASSERT(tdur <= contest_dur);
+        if (user_id > 0 && tdur > current_dur) continue;
       } else {
-        if (run_time < start_time) run_time = start_time;
-        ok_time[up_ind] = sec_to_min(global->rounding_mode, run_time - start_time);
-        if (!global->ignore_success_time) t_pen[tt] += ok_time[up_ind];
-        last_success_time = run_time;
-        last_success_start = start_time;
-      }
-    } else if ((pe->status == RUN_COMPILE_ERR)
-               && !prob->ignore_compile_errors) {
-      if (calc[up_ind] <= 0) {
-        calc[up_ind]--;
-        tot_att[pp]++;
+        // for a regular contest --- filter future runs for
+        // unprivileged standings
+        // client_flag == 1 && user_id == 0 --- privileged standings
+        if (client_flag != 1 || user_id) {
+          if (run_time < start_time) run_time = start_time;
+          if (current_dur > 0 && run_time - start_time > current_dur) continue;
+          if (global->stand_ignore_after > 0
+              && pe->time >= global->stand_ignore_after)
+            continue;
+        }
       }
-    } else if (run_is_failed_attempt(pe->status)) {
-      /* some error */
-      if (calc[up_ind] <= 0) {
-        calc[up_ind]--;
+      tt = t_rev[pe->user_id];
+      pp = p_rev[pe->prob_id];
+      up_ind = (tt << row_sh) + pp;
+
+      if (pe->status == RUN_OK) {
+        /* program accepted */
+        if (calc[up_ind] > 0) continue;
+
+        last_success_run = k;
+        t_pen[tt] += state->probs[pe->prob_id]->acm_run_penalty * - calc[up_ind];
+        calc[up_ind] = 1 - calc[up_ind];
+        t_prob[tt]++;
+        succ_att[pp]++;
         tot_att[pp]++;
+        if (global->is_virtual) {
+          ok_time[up_ind] = sec_to_min(global->rounding_mode, tdur);
+          if (!global->ignore_success_time) t_pen[tt] += ok_time[up_ind];
+          last_success_time = run_time;
+          last_success_start = tstart;
+        } else {
+          if (run_time < start_time) run_time = start_time;
+          ok_time[up_ind] = sec_to_min(global->rounding_mode, run_time - start_time);
+          if (!global->ignore_success_time) t_pen[tt] += ok_time[up_ind];
+          last_success_time = run_time;
+          last_success_start = start_time;
+        }
+      } else if ((pe->status == RUN_COMPILE_ERR)
+                 && !prob->ignore_compile_errors) {
+        if (calc[up_ind] <= 0) {
+          calc[up_ind]--;
+          tot_att[pp]++;
+        }
+      } else if (run_is_failed_attempt(pe->status)) {
+        /* some error */
+        if (calc[up_ind] <= 0) {
+          calc[up_ind]--;
+          tot_att[pp]++;
+        }
+      } else if (pe->status == RUN_DISQUALIFIED) {
+        disq_flag[up_ind] = 1;
+      } else if (pe->status == RUN_PENDING_REVIEW || pe->status == RUN_SUMMONED) {
+        pr_flag[up_ind] = 1;
+      } else if (pe->status == RUN_PENDING || pe->status == RUN_ACCEPTED) {
+        trans_flag[up_ind] = 1;
+      } else if (pe->status >= RUN_TRANSIENT_FIRST
+                 && pe->status <= RUN_TRANSIENT_LAST) {
+        trans_flag[up_ind] = 1;
+      } else if (pe->status == RUN_CHECK_FAILED) {
+        cf_flag[up_ind] = 1;
+      } else if (pe->status == RUN_STYLE_ERR || pe->status == RUN_REJECTED) {
       }
-    } else if (pe->status == RUN_DISQUALIFIED) {
-      disq_flag[up_ind] = 1;
-    } else if (pe->status == RUN_PENDING_REVIEW || pe->status == RUN_SUMMONED) {
-      pr_flag[up_ind] = 1;
-    } else if (pe->status == RUN_PENDING || pe->status == RUN_ACCEPTED) {
-      trans_flag[up_ind] = 1;
-    } else if (pe->status >= RUN_TRANSIENT_FIRST
-               && pe->status <= RUN_TRANSIENT_LAST) {
-      trans_flag[up_ind] = 1;
-    } else if (pe->status == RUN_CHECK_FAILED) {
-      cf_flag[up_ind] = 1;
-    } else if (pe->status == RUN_STYLE_ERR || pe->status == RUN_REJECTED) {
     }
   }
 
   /* now sort the teams in the descending order */
   /* t_sort: sorted->unsorted index map */
+  /* this is a counting sort, linear in the number of teams, so all
+     the rows are sorted again instead of moving the changed ones */
   /* ties are resolved in the order of the team's ids */
   if (t_tot > 0) {
     max_pen = -1;
@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2002-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2002-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -474,9 +474,10 @@ html_lock_filter(serve_state_t cs, int user_id, ej_cookie_t session_id)
   env.cur_time = time(NULL);
   env.rentries = run_get_entries_ptr(cs->runlog_state);
 
+  if (!u->prev_prog) u->prev_prog = filter_program_compile(u->tree_mem, u->prev_tree);
   for (int i = env.rbegin; i < env.rtotal; i++) {
     env.rid = i;
-    if (filter_tree_bool_eval(&env, u->prev_tree) > 0) {
+    if (filter_program_bool_eval(&env, u->prev_prog) > 0) {
       if (count > 0) fprintf(new_filter_f, "||");
       fprintf(new_filter_f, "id==%d", i);
       ++count;
@@ -496,6 +497,7 @@ html_lock_filter(serve_state_t cs, int user_id, ej_cookie_t session_id)
   u->error_msgs = 0;
   u->prev_filter_expr = 0;
   u->prev_tree = 0;
+  u->prev_prog = 0;
   u->tree_mem = 0;
   u->prev_filter_expr = new_filter_s; new_filter_s = NULL;
   u->tree_mem = filter_tree_new();
@@ -526,6 +528,7 @@ html_reset_filter(serve_state_t state, int user_id, ej_cookie_t session_id)
     u->tree_mem = 0;
   }
   u->prev_tree = 0;
+  u->prev_prog = 0;
 }
 
 void
@@ -758,7 +761,7 @@ generate_daily_statistics(
   int row_sz, row_sh;
   unsigned char *solved = 0;
   int r_beg, r_tot, u, p, idx, max_u_total;
-  const struct run_entry *runs, *rcur;
+  struct run_columns rc;
   int *u_total = 0, *u_ok = 0, *u_failed = 0, *u_afterok = 0, *u_errors = 0;
   int *u_trans = 0, *u_cf = 0, *u_ac = 0, *u_ign = 0, *u_disq = 0, *u_pend = 0;
   int *u_ce = 0, *u_sort = 0;
@@ -837,7 +840,7 @@ generate_daily_statistics(
 
   r_beg = run_get_first(state->runlog_state);
   r_tot = run_get_total(state->runlog_state);
-  runs = run_get_entries_ptr(state->runlog_state);
+  run_get_columns(state->runlog_state, &rc);
 
   if (!u_tot || !p_tot || !r_tot) return;
 
@@ -868,46 +871,46 @@ generate_daily_statistics(
   XALLOCAZ(p_total, p_tot);
   XALLOCAZ(p_ok, p_tot);
 
-  for (i = r_beg, rcur = runs; i < r_tot; i++, rcur++) {
-    if (rcur->time >= to_time) break;
-    if (rcur->time < from_time) {
-      if (rcur->status == RUN_EMPTY) continue;
-      if (rcur->status != RUN_OK) continue;
-      if (rcur->user_id <= 0 || rcur->user_id >= u_max || u_rev[rcur->user_id] < 0)
+  for (i = r_beg; i < r_tot; i++) {
+    if (rc.time[i] >= to_time) break;
+    if (rc.time[i] < from_time) {
+      if (rc.status[i] == RUN_EMPTY) continue;
+      if (rc.status[i] != RUN_OK) continue;
+      if (rc.user_id[i] <= 0 || rc.user_id[i] >= u_max || u_rev[rc.user_id[i]] < 0)
         continue;
-      if (rcur->prob_id <= 0 || rcur->prob_id >= p_max
-          || p_rev[rcur->prob_id] < 0)
+      if (rc.prob_id[i] <= 0 || rc.prob_id[i] >= p_max
+          || p_rev[rc.prob_id[i]] < 0)
         continue;
-      solved[(u_rev[rcur->user_id] << row_sh) + p_rev[rcur->prob_id]] = 1;
+      solved[(u_rev[rc.user_id[i]] << row_sh) + p_rev[rc.prob_id[i]]] = 1;
       continue;
     }
 
     // ok, collect statistics
-    if (run_is_invalid_status(rcur->status)) {
-      fprintf(f, "error: run %d has invalid status %d\n", i, rcur->status);
+    if (run_is_invalid_status(rc.status[i])) {
+      fprintf(f, "error: run %d has invalid status %d\n", i, rc.status[i]);
       total_errors++;
       continue;
     }
-    if (rcur->status == RUN_EMPTY) {
+    if (rc.status[i] == RUN_EMPTY) {
       total_empty++;
       continue;
     }
-    if (rcur->user_id <= 0 || rcur->user_id >= u_max || (u = u_rev[rcur->user_id]) < 0) {
+    if (rc.user_id[i] <= 0 || rc.user_id[i] >= u_max || (u = u_rev[rc.user_id[i]]) < 0) {
       fprintf(f, "error: run %d has invalid user_id %d\n",
-              i, rcur->user_id);
+              i, rc.user_id[i]);
       total_errors++;
       continue;
     }
-    if (rcur->status >= RUN_PSEUDO_FIRST && rcur->status <= RUN_PSEUDO_LAST) {
-      total_status[rcur->status]++;
+    if (rc.status[i] >= RUN_PSEUDO_FIRST && rc.status[i] <= RUN_PSEUDO_LAST) {
+      total_status[rc.status[i]]++;
       total_pseudo++;
       u_total[u]++;
       continue;
     }
-    if (rcur->prob_id <= 0 || rcur->prob_id >= p_max
-        || (p = p_rev[rcur->prob_id]) < 0) {
+    if (rc.prob_id[i] <= 0 || rc.prob_id[i] >= p_max
+        || (p = p_rev[rc.prob_id[i]]) < 0) {
       fprintf(f, "error: run %d has invalid prob_id %d\n",
-              i, rcur->prob_id);
+              i, rc.prob_id[i]);
       total_errors++;
       u_errors[u]++;
       u_total[u]++;
@@ -920,32 +923,32 @@ generate_daily_statistics(
       total_afterok++;
       continue;
     }
-    if (rcur->lang_id) {
-      if (rcur->lang_id < 0 || rcur->lang_id > state->max_lang
-          || !state->langs[rcur->lang_id]) {
+    if (rc.lang_id[i]) {
+      if (rc.lang_id[i] < 0 || rc.lang_id[i] > state->max_lang
+          || !state->langs[rc.lang_id[i]]) {
         fprintf(f, "error: run %d has invalid lang_id %d\n",
-                i, rcur->lang_id);
+                i, rc.lang_id[i]);
         total_errors++;
         u_errors[u]++;
         u_total[u]++;
         continue;
       }
     }
-    if (rcur->status >= RUN_TRANSIENT_FIRST
-        && rcur->status <= RUN_TRANSIENT_LAST) {
+    if (rc.status[i] >= RUN_TRANSIENT_FIRST
+        && rc.status[i] <= RUN_TRANSIENT_LAST) {
       total_trans++;
       u_total[u]++;
       u_trans[u]++;
       continue;
     }
 
-    switch (rcur->status) {
+    switch (rc.status[i]) {
     case RUN_OK:
       total_ok++;
       u_ok[u]++;
       u_total[u]++;
-      l_total[rcur->lang_id]++;
-      l_ok[rcur->lang_id]++;
+      l_total[rc.lang_id[i]]++;
+      l_ok[rc.lang_id[i]]++;
       p_total[p]++;
       p_ok[p]++;
       solved[idx] = 1;
@@ -957,8 +960,8 @@ generate_daily_statistics(
       total_ce++;
       u_ce[u]++;
       u_total[u]++;
-      l_total[rcur->lang_id]++;
-      l_ce[rcur->lang_id]++;
+      l_total[rc.lang_id[i]]++;
+      l_ce[rc.lang_id[i]]++;
       p_total[p]++;
       break;
 
@@ -974,9 +977,9 @@ generate_daily_statistics(
       total_failed++;
       u_failed[u]++;
       u_total[u]++;
-      l_total[rcur->lang_id]++;
+      l_total[rc.lang_id[i]]++;
       p_total[p]++;
-      total_status[rcur->status]++;
+      total_status[rc.status[i]]++;
       break;
 
     case RUN_CHECK_FAILED:
@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2006-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2006-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -62,9 +62,11 @@
 #include "ejudge/random.h"
 #include "ejudge/avatar_plugin.h"
 #include "ejudge/content_plugin.h"
+#include "ejudge/common_plugin.h"
 #include "ejudge/imagemagick.h"
 #include "ejudge/base32.h"
 #include "ejudge/userlist_bin.h"
+#include "ejudge/userlist_shm.h"
 #include "ejudge/testing_report_xml.h"
 #include "ejudge/cJSON.h"
 #include "ejudge/filter_tree.h"
@@ -88,6 +90,8 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/inotify.h>
 
 #if CONF_HAS_LIBINTL - 0 == 1
 #include <libintl.h>
@@ -120,6 +124,7 @@ static struct contest_extra **extras = 0;
 static size_t extra_a = 0, extra_u = 0;
 
 extern const unsigned char * const ns_symbolic_action_table[];
+extern const unsigned char ns_action_flags_table[];
 
 static ContestExternalActionVector cnts_ext_actions;
 
@@ -451,6 +456,9 @@ ns_client_destroy_callback(struct client_state *p)
   cs->destroy_callback = 0;
 }
 
+static void standings_cache_free(struct standings_cache *sc);
+static void status_unwatch_contest(struct contest_extra *e);
+
 static void
 do_unload_contest(int idx)
 {
@@ -485,6 +493,8 @@ do_unload_contest(int idx)
 
   avatar_plugin_destroy(extra->main_avatar_plugin);
   content_plugin_destroy(extra->main_content_plugin);
+  standings_cache_free(extra->standings_cache);
+  status_unwatch_contest(extra);
 
   memset(extra, 0, sizeof(*extra));
   xfree(extra);
@@ -603,6 +613,155 @@ handle_pending_xml_import(
 
 enum { MAX_WORK_BATCH = 10 };
 
+/* the status directories are watched with inotify, so only the contests
+   which received new packets are scanned, all the contests are rescanned
+   every STATUS_RESCAN_INTERVAL seconds just in case */
+enum { STATUS_RESCAN_INTERVAL = 10 };
+
+static int status_inotify_fd = -1;
+static int status_inotify_failed;
+static int status_wd_map_a;
+static int *status_wd_map;      // watch descriptor -> contest_id
+
+static void
+status_inotify_callback(
+        struct server_framework_state *state,
+        struct server_framework_watch *pw,
+        int events)
+{
+  unsigned char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  const unsigned char *p, *bend;
+  const struct inotify_event *ev;
+  struct contest_extra *e;
+  int r, eind;
+
+  while (1) {
+    errno = 0;
+    r = read(status_inotify_fd, buf, sizeof(buf));
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0 && errno == EAGAIN) break;
+    if (r < 0) {
+      err("status_inotify_callback: read failed: %s", os_ErrorMsg());
+      break;
+    }
+    if (!r) {
+      err("status_inotify_callback: read returned 0");
+      break;
+    }
+    p = buf;
+    bend = buf + r;
+    while (p < bend) {
+      ev = (const struct inotify_event *) p;
+      p += sizeof(*ev) + ev->len;
+      if ((ev->mask & IN_Q_OVERFLOW)) {
+        for (eind = 0; eind < extra_u; ++eind) {
+          extras[eind]->status_dirty = 1;
+        }
+        continue;
+      }
+      if (ev->wd <= 0 || ev->wd >= status_wd_map_a) continue;
+      if (status_wd_map[ev->wd] <= 0) continue;
+      if ((e = ns_try_contest_extra(status_wd_map[ev->wd]))) {
+        e->status_dirty = 1;
+      }
+    }
+  }
+}
+
+static void
+status_inotify_init(struct server_framework_state *state)
+{
+  struct server_framework_watch w;
+
+  if (status_inotify_fd >= 0 || status_inotify_failed) return;
+
+  if ((status_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0) {
+    err("inotify_init1 failed: %s", os_ErrorMsg());
+    status_inotify_failed = 1;
+    return;
+  }
+
+  memset(&w, 0, sizeof(w));
+  w.fd = status_inotify_fd;
+  w.mode = NSF_READ;
+  w.callback = status_inotify_callback;
+  if (nsf_add_watch(state, &w) < 0) {
+    err("status_inotify_init: cannot add watch");
+    close(status_inotify_fd);
+    status_inotify_fd = -1;
+    status_inotify_failed = 1;
+  }
+}
+
+static int
+status_watch_dir(struct contest_extra *e, const unsigned char *status_dir)
+{
+  path_t path;
+  int wd;
+
+  snprintf(path, sizeof(path), "%s/dir", status_dir);
+  if ((wd = inotify_add_watch(status_inotify_fd, path,
+                              IN_MOVED_TO | IN_CLOSE_WRITE)) < 0) {
+    err("inotify_add_watch failed for %s: %s", path, os_ErrorMsg());
+    return -1;
+  }
+
+  if (wd >= status_wd_map_a) {
+    int new_a = status_wd_map_a;
+    if (!new_a) new_a = 64;
+    while (wd >= new_a) new_a *= 2;
+    XREALLOC(status_wd_map, new_a);
+    memset(status_wd_map + status_wd_map_a, 0,
+           (new_a - status_wd_map_a) * sizeof(status_wd_map[0]));
+    status_wd_map_a = new_a;
+  }
+  status_wd_map[wd] = e->contest_id;
+
+  XREALLOC(e->status_wds, e->status_wd_u + 1);
+  e->status_wds[e->status_wd_u++] = wd;
+  return 0;
+}
+
+static void
+status_unwatch_contest(struct contest_extra *e)
+{
+  int i, wd;
+
+  for (i = 0; i < e->status_wd_u; ++i) {
+    wd = e->status_wds[i];
+    if (status_inotify_fd >= 0) inotify_rm_watch(status_inotify_fd, wd);
+    if (wd > 0 && wd < status_wd_map_a && status_wd_map[wd] == e->contest_id)
+      status_wd_map[wd] = 0;
+  }
+  xfree(e->status_wds);
+  e->status_wds = NULL;
+  e->status_wd_u = 0;
+  e->status_watch_state = NULL;
+  e->status_watch_failed = 0;
+}
+
+static void
+status_watch_contest(struct contest_extra *e)
+{
+  serve_state_t cs = e->serve_state;
+  int i;
+
+  if (status_inotify_fd < 0 || !cs) return;
+  if (e->status_watch_state == cs) return;
+
+  status_unwatch_contest(e);
+  for (i = 0; i < cs->compile_dirs_u; i++) {
+    if (status_watch_dir(e, cs->compile_dirs[i].status_dir) < 0)
+      e->status_watch_failed = 1;
+  }
+  for (i = 0; i < cs->run_dirs_u; i++) {
+    if (status_watch_dir(e, cs->run_dirs[i].status_dir) < 0)
+      e->status_watch_failed = 1;
+  }
+  e->status_watch_state = cs;
+  e->status_dirty = 1;
+}
+
 int
 ns_loop_callback(struct server_framework_state *state)
 {
@@ -610,12 +769,13 @@ ns_loop_callback(struct server_framework_state *state)
   struct contest_extra *e;
   serve_state_t cs;
   const struct contest_desc *cnts;
-  int contest_id, i, eind;
+  int contest_id, i, j, eind;
   strarray_t files;
   int count = 0;
   struct server_framework_job *job = nsf_get_first_job(state);
 
   memset(&files, 0, sizeof(files));
+  status_inotify_init(state);
 
   if (job) {
     if (job->contest_id > 0) {
@@ -641,17 +801,31 @@ ns_loop_callback(struct server_framework_state *state)
     serve_update_external_xml_log(e->serve_state, cnts);
     serve_update_internal_xml_log(e->serve_state, cnts);
 
+    status_watch_contest(e);
+    if (status_inotify_fd >= 0 && !e->status_watch_failed && !e->status_dirty
+        && cur_time < e->last_status_scan + STATUS_RESCAN_INTERVAL) {
+      goto skip_status_dirs;
+    }
+    if (count >= MAX_WORK_BATCH) {
+      // no more work on this pass
+      e->status_dirty = 1;
+      goto skip_status_dirs;
+    }
+    e->status_dirty = 0;
+    e->last_status_scan = cur_time;
+
     for (i = 0; i < cs->compile_dirs_u; i++) {
       if (get_file_list(cs->compile_dirs[i].status_dir, &files) < 0)
         continue;
       if (files.u <= 0) continue;
-      for (int j = 0; j < files.u && count < MAX_WORK_BATCH; ++j) {
+      for (j = 0; j < files.u && count < MAX_WORK_BATCH; ++j) {
         ++count;
         serve_read_compile_packet(e, ejudge_config, cs, cnts,
                                   cs->compile_dirs[i].status_dir,
                                   cs->compile_dirs[i].report_dir,
                                   files.v[j]);
       }
+      if (j < files.u) e->status_dirty = 1;
       e->last_access_time = cur_time;
       xstrarrayfree(&files);
     }
@@ -660,7 +834,7 @@ ns_loop_callback(struct server_framework_state *state)
       if (get_file_list(cs->run_dirs[i].status_dir, &files) < 0
           || files.u <= 0)
         continue;
-      for (int j = 0; j < files.u && count < MAX_WORK_BATCH; ++j) {
+      for (j = 0; j < files.u && count < MAX_WORK_BATCH; ++j) {
         ++count;
         serve_read_run_packet(e, ejudge_config, cs, cnts,
                               cs->run_dirs[i].status_dir,
@@ -668,10 +842,13 @@ ns_loop_callback(struct server_framework_state *state)
                               cs->run_dirs[i].full_report_dir,
                               files.v[j]);
       }
+      if (j < files.u) e->status_dirty = 1;
       e->last_access_time = cur_time;
       xstrarrayfree(&files);
     }
 
+  skip_status_dirs:
+
     if (cs->pending_xml_import && !serve_count_transient_runs(cs))
       handle_pending_xml_import(e, cnts, cs);
 
@@ -814,6 +991,70 @@ ns_open_ul_connection(struct server_framework_state *state)
   return 0;
 }
 
+/* the userlist-server connection inherited by a worker process is
+   shared with the main process, so it is replaced with a private one
+   under the same descriptor */
+static void
+worker_reopen_ul_connection(void)
+{
+  struct userlist_clnt *c;
+  int r, uid = 0;
+  unsigned char *login = NULL;
+
+  if (!ul_conn) return;
+
+  if (!(c = userlist_clnt_open(ejudge_config->socket_path))) {
+    err("worker_reopen_ul_connection: connect to server failed");
+    close(userlist_clnt_get_fd(ul_conn));
+    return;
+  }
+  if ((r = userlist_clnt_admin_process(c, &uid, &login, 0)) < 0) {
+    err("worker_reopen_ul_connection: cannot became an admin process: %s",
+        userlist_strerror(-r));
+    close(userlist_clnt_get_fd(ul_conn));
+    userlist_clnt_close(c);
+    return;
+  }
+  xfree(login);
+  dup2(userlist_clnt_get_fd(c), userlist_clnt_get_fd(ul_conn));
+  userlist_clnt_close(c);
+}
+
+/* hand a read-only action (NS_ACTION_READONLY in new_server_at.c)
+   over to a worker process, returns 1 in the main process if the request
+   is handed over. The worker runs on a copy of the server memory:
+   it uses the lazily filled caches of the main process, but whatever
+   it adds to them is lost when it exits, so only requests served by
+   the main process fill these caches. The standings are always served
+   by the main process, which keeps the standings page cache.
+   Only the userlist connection is reopened in the worker, so no request
+   is handed over while any external (database) plugin is loaded. */
+static int
+offload_readonly_action(struct http_request_info *phr)
+{
+  int pid;
+
+  if (phr->action <= 0 || phr->action >= NEW_SRV_ACTION_LAST) return 0;
+  if (!(ns_action_flags_table[phr->action] & NS_ACTION_READONLY)) return 0;
+  if (phr->action == NEW_SRV_ACTION_STANDINGS) return 0;
+  if (!ejudge_config || ejudge_config->contests_workers <= 0) return 0;
+  if (!phr->fw_state || !phr->client_state) return 0;
+  // the worker would share the database connections of the external
+  // plugins (mysql, mongo) with the main process
+  if (plugin_get_external_count() > 0) return 0;
+
+  pid = nsf_fork_worker(phr->fw_state, phr->client_state,
+                        ejudge_config->contests_workers);
+  if (pid < 0) return 0;
+  if (!pid) {
+    // the worker continues with the request
+    worker_reopen_ul_connection();
+    return 0;
+  }
+  phr->no_reply = 1;
+  return 1;
+}
+
 static void
 load_problem_plugin(serve_state_t cs, int prob_id)
 {
@@ -933,6 +1174,58 @@ fail:
   return -1;
 }
 
+/* set if a shared memory image cannot be mapped */
+static int snapshot_map_failed;
+
+int
+ns_list_changed_users_callback(
+        void *user_data,
+        int contest_id,
+        unsigned long long vintage,
+        UserlistBinaryHeader **p_header)
+{
+  struct server_framework_state *state = (struct server_framework_state *) user_data;
+  UserlistBinaryHeader *header = NULL;
+  unsigned char *data = NULL;
+  int flags, r;
+
+  if (ns_open_ul_connection(state) < 0) return -ULS_ERR_NO_CONNECT;
+
+retry:
+  flags = snapshot_map_failed?0:ULS_DELTA_ACCEPT_SNAPSHOT;
+  r = userlist_clnt_bin_data_delta(ul_conn, ULS_LIST_STANDINGS_USERS_3,
+                                   contest_id, flags, vintage, &data);
+  if (r < 0) return r;
+  if (r != ULS_BIN_DATA) {
+    xfree(data);
+    return -ULS_ERR_PROTOCOL;
+  }
+  header = (UserlistBinaryHeader*) data;
+  if ((header->flags & USERLIST_BIN_SNAPSHOT)) {
+    // the complete list is shared with the other processes
+    UserlistBinaryHeader *mapped = userlist_shm_map(ejudge_config->socket_path,
+                                                    header->contest_id,
+                                                    header->vintage);
+    xfree(header);
+    if (!mapped && snapshot_map_failed) return -ULS_ERR_PROTOCOL;
+    if (!mapped) {
+      // receive the complete lists from now on, keeping the deltas
+      err("shared memory userlist images are disabled");
+      snapshot_map_failed = 1;
+      data = NULL;
+      goto retry;
+    }
+    *p_header = mapped;
+    return 0;
+  }
+  if (!userlist_bin_unmarshall(header)) {
+    xfree(header);
+    return -ULS_ERR_PROTOCOL;
+  }
+  *p_header = header;
+  return 0;
+}
+
 static const unsigned char *role_strs[] =
   {
     __("Contestant"),
@@ -8572,6 +8865,7 @@ priv_list_runs_json(
     r = filter_expr_parse();
     if (r + filter_expr_nerrs == 0 && filter_expr_lval && filter_expr_lval->type == FILTER_TYPE_BOOL && !u->error_msgs) {
       u->prev_tree = filter_expr_lval;
+      u->prev_prog = filter_program_compile(u->tree_mem, u->prev_tree);
     } else {
       error_page(fout, phr, 0, NEW_SRV_ERR_INV_FILTER_EXPR);
       goto cleanup;
@@ -8605,8 +8899,8 @@ priv_list_runs_json(
       transient_tot++;
     }
     env.rid = i;
-    if (u->prev_tree) {
-      r = filter_tree_bool_eval(&env, u->prev_tree);
+    if (u->prev_prog) {
+      r = filter_program_bool_eval(&env, u->prev_prog);
       if (r < 0) {
         parse_error_func(cs, "run %d: %s", i, filter_strerror(-r));
         continue;
@@ -9636,6 +9930,7 @@ privileged_entry_point(
   memset(&callbacks, 0, sizeof(callbacks));
   callbacks.user_data = (void*) phr->fw_state;
   callbacks.list_all_users = ns_list_all_users_callback;
+  callbacks.list_changed_users = ns_list_changed_users_callback;
 
   // invoke the contest
   if (serve_state_load_contest(extra, ejudge_config, phr->contest_id,
@@ -9666,6 +9961,8 @@ privileged_entry_point(
     phr->action = NEW_SRV_ACTION_MAIN_PAGE;
   }
 
+  if (offload_readonly_action(phr)) goto cleanup;
+
   if (priv_external_action(fout, phr) > 0) goto cleanup;
 
   if (phr->action > 0 && phr->action < NEW_SRV_ACTION_LAST && actions_table[phr->action]) {
@@ -16145,6 +16442,7 @@ unpriv_gitlab_webhook(
 
   callbacks.user_data = (void*) phr->fw_state;
   callbacks.list_all_users = ns_list_all_users_callback;
+  callbacks.list_changed_users = ns_list_changed_users_callback;
 
   if (serve_state_load_contest(phr->extra, phr->config, phr->contest_id,
                                ul_conn, &callbacks, 0, 0) < 0) {
@@ -16481,6 +16779,7 @@ unprivileged_entry_point(
   memset(&callbacks, 0, sizeof(callbacks));
   callbacks.user_data = (void*) phr->fw_state;
   callbacks.list_all_users = ns_list_all_users_callback;
+  callbacks.list_changed_users = ns_list_changed_users_callback;
 
   // invoke the contest
   if (serve_state_load_contest(extra, ejudge_config, phr->contest_id,
@@ -16559,6 +16858,7 @@ unprivileged_entry_point(
   if (phr->action <= 0 || phr->action >= NEW_SRV_ACTION_LAST) {
     phr->action = NEW_SRV_ACTION_MAIN_PAGE;
   }
+  if (offload_readonly_action(phr)) goto cleanup;
   if (external_unpriv_action_aliases[phr->action] > 0 || external_unpriv_action_names[phr->action]) {
     if (unpriv_external_action(fout, phr)) goto cleanup;
   }
@@ -16727,8 +17027,8 @@ do_write_moscow_standings(
         int charset_id,
         struct user_filter_info *u);
 
-void
-ns_write_standings(
+static void
+do_ns_write_standings(
         struct http_request_info *phr,
         struct contest_extra *extra,
         const struct contest_desc *cnts,
@@ -16883,6 +17183,251 @@ ns_write_standings(
   }
 }
 
+/* the parameters the generated standings page depends on */
+struct standings_cache_key
+{
+  serve_state_t state;
+  time_t load_time;
+  int64_t run_serial;
+  int64_t standings_serial;
+  int teamdb_vintage;
+  int fog_period;
+  int locale_id;
+  int user_id;
+  int users_on_page;
+  int page_index;
+  int client_flag;
+  int only_table_flag;
+  int accepting_mode;
+  int force_fancy_style;
+  int charset_id;
+  int user_mode;
+  int compat_mode;
+  time_t stand_time;
+  const unsigned char *header_str;
+  const unsigned char *footer_str;
+  unsigned char *user_name;
+  unsigned char *filter;        /* standings filter expressions */
+};
+
+struct standings_cache_entry
+{
+  struct standings_cache_key key;
+  time_t last_use;
+  char *text;
+  size_t size;
+};
+
+enum { STANDINGS_CACHE_SIZE = 16 };
+
+struct standings_cache
+{
+  struct standings_cache_entry entries[STANDINGS_CACHE_SIZE];
+};
+
+static void
+standings_cache_clear_entry(struct standings_cache_entry *e)
+{
+  xfree(e->key.user_name);
+  xfree(e->key.filter);
+  xfree(e->text);
+  memset(e, 0, sizeof(*e));
+}
+
+static void
+standings_cache_free(struct standings_cache *sc)
+{
+  if (!sc) return;
+  for (int i = 0; i < STANDINGS_CACHE_SIZE; ++i)
+    standings_cache_clear_entry(&sc->entries[i]);
+  xfree(sc);
+}
+
+static int
+standings_cache_key_equal(
+        const struct standings_cache_key *k1,
+        const struct standings_cache_key *k2)
+{
+  if (k1->state != k2->state || k1->load_time != k2->load_time
+      || k1->run_serial != k2->run_serial
+      || k1->standings_serial != k2->standings_serial
+      || k1->teamdb_vintage != k2->teamdb_vintage
+      || k1->fog_period != k2->fog_period
+      || k1->locale_id != k2->locale_id
+      || k1->user_id != k2->user_id
+      || k1->users_on_page != k2->users_on_page
+      || k1->page_index != k2->page_index
+      || k1->client_flag != k2->client_flag
+      || k1->only_table_flag != k2->only_table_flag
+      || k1->accepting_mode != k2->accepting_mode
+      || k1->force_fancy_style != k2->force_fancy_style
+      || k1->charset_id != k2->charset_id
+      || k1->user_mode != k2->user_mode
+      || k1->compat_mode != k2->compat_mode
+      || k1->stand_time != k2->stand_time
+      || k1->header_str != k2->header_str
+      || k1->footer_str != k2->footer_str)
+    return 0;
+  if (strcmp(k1->user_name, k2->user_name) != 0) return 0;
+  if (strcmp(k1->filter, k2->filter) != 0) return 0;
+  return 1;
+}
+
+static int
+standings_has_session_links(
+        const struct http_request_info *phr,
+        struct contest_extra *extra,
+        const struct contest_desc *cnts)
+{
+  const struct section_global_data *global = extra->serve_state->global;
+  struct content_loaded_plugin *cp;
+
+  if (!global || global->stand_show_avatar <= 0) return 0;
+  if ((cp = content_plugin_get(extra, cnts, phr->config, NULL))
+      && cp->iface->is_enabled(cp->data, cnts) > 0)
+    return 0;
+  return 1;
+}
+
+void
+ns_write_standings(
+        struct http_request_info *phr,
+        struct contest_extra *extra,
+        const struct contest_desc *cnts,
+        FILE *f,
+        const unsigned char *stand_dir,
+        const unsigned char *file_name,
+        const unsigned char *file_name2,
+        int users_on_page,
+        int page_index,
+        int client_flag,
+        int only_table_flag,
+        int user_id,
+        const unsigned char *header_str,
+        const unsigned char *footer_str,
+        int accepting_mode,
+        const unsigned char *user_name,
+        int force_fancy_style,
+        int charset_id,
+        struct user_filter_info *user_filter,
+        int user_mode,
+        time_t stand_time,
+        int compat_mode)
+{
+  if (phr && !extra) extra = phr->extra;
+
+  // only the pages sent to the client are cached, not the standings files,
+  // and not the pages with session-specific links (avatars served
+  // by ej-contests itself contain the SID of the session)
+  if (!phr || !f || f != phr->out_f || file_name || !extra || !extra->serve_state
+      || standings_has_session_links(phr, extra, cnts)) {
+    do_ns_write_standings(phr, extra, cnts, f, stand_dir, file_name, file_name2,
+                          users_on_page, page_index, client_flag,
+                          only_table_flag, user_id, header_str, footer_str,
+                          accepting_mode, user_name, force_fancy_style,
+                          charset_id, user_filter, user_mode, stand_time,
+                          compat_mode);
+    return;
+  }
+
+  serve_state_t cs = extra->serve_state;
+  const struct section_global_data *global = cs->global;
+  struct standings_cache_key key;
+  time_t eff_time = stand_time;
+  char *filter_s = NULL;
+  size_t filter_z = 0;
+  FILE *filter_f = NULL;
+
+  if (eff_time <= 0) eff_time = cs->current_time;
+  memset(&key, 0, sizeof(key));
+  key.state = cs;
+  key.load_time = cs->load_time;
+  key.run_serial = run_get_change_serial(cs->runlog_state);
+  key.standings_serial = cs->standings_serial;
+  key.teamdb_vintage = teamdb_get_vintage(cs->teamdb_state);
+  if (global) {
+    key.fog_period = run_get_fog_period(cs->runlog_state, eff_time,
+                                        global->board_fog_time,
+                                        global->board_unfog_time);
+  }
+  key.locale_id = phr->locale_id;
+  key.user_id = user_id;
+  key.users_on_page = users_on_page;
+  key.page_index = page_index;
+  key.client_flag = client_flag;
+  key.only_table_flag = only_table_flag;
+  key.accepting_mode = accepting_mode;
+  key.force_fancy_style = force_fancy_style;
+  key.charset_id = charset_id;
+  key.user_mode = user_mode;
+  key.compat_mode = compat_mode;
+  key.stand_time = eff_time;
+  key.header_str = header_str;
+  key.footer_str = footer_str;
+  key.user_name = (unsigned char *) (user_name?user_name:(const unsigned char*) "");
+
+  filter_f = open_memstream(&filter_s, &filter_z);
+  if (user_filter) {
+    fprintf(filter_f, "%d\n%s\n%s\n%s\n%s\n", user_filter->stand_user_mode,
+            user_filter->stand_user_expr?user_filter->stand_user_expr:(unsigned char*) "",
+            user_filter->stand_prob_expr?user_filter->stand_prob_expr:(unsigned char*) "",
+            user_filter->stand_run_expr?user_filter->stand_run_expr:(unsigned char*) "",
+            user_filter->stand_time_expr?user_filter->stand_time_expr:(unsigned char*) "");
+  }
+  fclose(filter_f); filter_f = NULL;
+  key.filter = filter_s;
+
+  if (!extra->standings_cache) {
+    XCALLOC(extra->standings_cache, 1);
+  }
+  struct standings_cache *sc = extra->standings_cache;
+  struct standings_cache_entry *victim = &sc->entries[0];
+  for (int i = 0; i < STANDINGS_CACHE_SIZE; ++i) {
+    struct standings_cache_entry *e = &sc->entries[i];
+    if (e->text && standings_cache_key_equal(&e->key, &key)) {
+      e->last_use = cs->current_time;
+      fwrite(e->text, 1, e->size, f);
+      xfree(filter_s);
+      return;
+    }
+    if (!e->text) {
+      if (victim->text) victim = e;
+    } else if (victim->text && e->last_use < victim->last_use) {
+      victim = e;
+    }
+  }
+
+  // render into memory and remember the result
+  char *page_s = NULL;
+  size_t page_z = 0;
+  FILE *page_f = open_memstream(&page_s, &page_z);
+  phr->out_f = page_f;
+  do_ns_write_standings(phr, extra, cnts, page_f, stand_dir, file_name,
+                        file_name2, users_on_page, page_index, client_flag,
+                        only_table_flag, user_id, header_str, footer_str,
+                        accepting_mode, user_name, force_fancy_style,
+                        charset_id, user_filter, user_mode, stand_time,
+                        compat_mode);
+  phr->out_f = f;
+  fclose(page_f); page_f = NULL;
+  fwrite(page_s, 1, page_z, f);
+
+  if (user_filter && user_filter->stand_error_msgs) {
+    // do not cache the pages with filter errors
+    xfree(page_s);
+    xfree(filter_s);
+    return;
+  }
+
+  standings_cache_clear_entry(victim);
+  victim->key = key;
+  victim->key.user_name = xstrdup(key.user_name);
+  victim->key.filter = filter_s;
+  victim->last_use = cs->current_time;
+  victim->text = page_s;
+  victim->size = page_z;
+}
+
 void
 ns_write_public_log(
         struct http_request_info *phr,
@@ -17091,6 +17636,7 @@ do_load_contest(struct http_request_info *phr, const struct contest_desc *cnts)
   memset(&callbacks, 0, sizeof(callbacks));
   callbacks.user_data = (void*) phr->fw_state;
   callbacks.list_all_users = ns_list_all_users_callback;
+  callbacks.list_changed_users = ns_list_changed_users_callback;
 
   // invoke the contest
   if (serve_state_load_contest(extra, ejudge_config, phr->contest_id,
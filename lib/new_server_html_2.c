@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2006-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2006-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -106,6 +106,7 @@ ns_write_priv_all_runs(
 {
   struct user_filter_info *u = 0;
   struct filter_env env;
+  struct run_columns rc;
   int i, r;
   int *match_idx = 0;
   int match_tot = 0;
@@ -164,6 +165,7 @@ ns_write_priv_all_runs(
     u->error_msgs = 0;
     u->prev_filter_expr = 0;
     u->prev_tree = 0;
+    u->prev_prog = 0;
     u->tree_mem = 0;
 
     u->prev_filter_expr = xstrdup(filter_expr);
@@ -193,6 +195,9 @@ ns_write_priv_all_runs(
       u->tree_mem = 0;
     }
   }
+  if (u->prev_tree && !u->prev_prog) {
+    u->prev_prog = filter_program_compile(u->tree_mem, u->prev_tree);
+  }
 
   if (!u->error_msgs) {
     memset(&env, 0, sizeof(env));
@@ -208,18 +213,20 @@ ns_write_priv_all_runs(
     run_get_header(cs->runlog_state, &env.rhead);
     env.cur_time = time(0);
     env.rentries = run_get_entries_ptr(cs->runlog_state);
+    run_get_columns(cs->runlog_state, &rc);
+    env.columns = &rc;
 
     XCALLOC(match_idx, env.rtotal + 1 - env.rbegin);
     match_tot = 0;
     transient_tot = 0;
 
     for (i = env.rbegin; i < env.rtotal; i++) {
-      if (env.rentries[i].status >= RUN_TRANSIENT_FIRST
-          && env.rentries[i].status <= RUN_TRANSIENT_LAST)
+      if (rc.status[i] >= RUN_TRANSIENT_FIRST
+          && rc.status[i] <= RUN_TRANSIENT_LAST)
         transient_tot++;
       env.rid = i;
-      if (u->prev_tree) {
-        r = filter_tree_bool_eval(&env, u->prev_tree);
+      if (u->prev_prog) {
+        r = filter_program_bool_eval(&env, u->prev_prog);
         if (r < 0) {
           parse_error_func(cs, "run %d: %s", i, filter_strerror(-r));
           continue;
@@ -1506,6 +1506,7 @@ do_dump_master_runs(
   u->error_msgs = 0;
   u->prev_filter_expr = 0;
   u->prev_tree = 0;
+  u->prev_prog = 0;
   u->tree_mem = 0;
   u->prev_filter_expr = xstrdup(filter_expr);
   u->tree_mem = filter_tree_new();
@@ -1517,6 +1518,7 @@ do_dump_master_runs(
         filter_expr_lval->type == FILTER_TYPE_BOOL) {
       // parsing successful
       u->prev_tree = filter_expr_lval;
+      u->prev_prog = filter_program_compile(u->tree_mem, u->prev_tree);
       xfree(u->error_msgs); u->error_msgs = 0;
     } else {
       // parsing failed
@@ -1550,8 +1552,8 @@ do_dump_master_runs(
         && env.rentries[i].status <= RUN_TRANSIENT_LAST)
       transient_tot++;
     env.rid = i;
-    if (u->prev_tree) {
-      r = filter_tree_bool_eval(&env, u->prev_tree);
+    if (u->prev_prog) {
+      r = filter_program_bool_eval(&env, u->prev_prog);
       if (r < 0) {
         parse_error_func(cs, "run %d: %s", i, filter_strerror(-r));
         continue;
@@ -2208,6 +2210,7 @@ new_server_cmd_handler(FILE *fout, struct http_request_info *phr)
   memset(&callbacks, 0, sizeof(callbacks));
   callbacks.user_data = (void*) phr->fw_state;
   callbacks.list_all_users = ns_list_all_users_callback;
+  callbacks.list_changed_users = ns_list_changed_users_callback;
 
   // invoke the contest
   if (serve_state_load_contest(extra, ejudge_config, phr->contest_id,
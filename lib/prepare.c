@@ -458,6 +458,7 @@ static const struct config_parse_info section_problem_params[] =
   PROBLEM_PARAM(enable_extended_info, "L"),
   PROBLEM_PARAM(stop_on_first_fail, "L"),
   PROBLEM_PARAM(enable_control_socket, "L"),
+  PROBLEM_PARAM(enable_checker_server, "L"),
   PROBLEM_PARAM(hide_variant, "L"),
   PROBLEM_PARAM(autoassign_variants, "L"),
   PROBLEM_PARAM(enable_text_form, "L"),
@@ -477,6 +478,7 @@ static const struct config_parse_info section_problem_params[] =
   PROBLEM_PARAM(max_file_size, "E"),
   PROBLEM_PARAM(max_open_file_count, "d"),
   PROBLEM_PARAM(max_process_count, "d"),
+  PROBLEM_PARAM(parallel_tests, "d"),
   PROBLEM_PARAM_2(type, do_problem_parse_type),
   PROBLEM_PARAM(interactor_time_limit, "d"),
   PROBLEM_PARAM(interactor_real_time_limit, "d"),
@@ -1354,6 +1356,7 @@ prepare_problem_init_func(struct generic_section_config *gp)
   p->enable_extended_info = -1;
   p->stop_on_first_fail = -1;
   p->enable_control_socket = -1;
+  p->enable_checker_server = -1;
   p->hide_variant = -1;
   p->autoassign_variants = -1;
   p->enable_text_form = -1;
@@ -1370,6 +1373,7 @@ prepare_problem_init_func(struct generic_section_config *gp)
   p->max_file_size = -1LL;
   p->max_open_file_count = -1;
   p->max_process_count = -1;
+  p->parallel_tests = -1;
   p->interactor_time_limit = -1;
   p->interactor_real_time_limit = -1;
   p->max_user_run_count = -1;
@@ -3738,6 +3742,7 @@ set_defaults(
     prepare_set_prob_value(CNTSPROB_enable_extended_info, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_stop_on_first_fail, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_enable_control_socket, prob, aprob, g);
+    prepare_set_prob_value(CNTSPROB_enable_checker_server, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_enable_user_input, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_enable_vcs, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_hide_variant, prob, aprob, g);
@@ -3805,6 +3810,7 @@ set_defaults(
     prepare_set_prob_value(CNTSPROB_max_file_size, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_max_open_file_count, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_max_process_count, prob, aprob, g);
+    prepare_set_prob_value(CNTSPROB_parallel_tests, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_checker_max_vm_size, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_checker_max_stack_size, prob, aprob, g);
     prepare_set_prob_value(CNTSPROB_checker_max_rss_size, prob, aprob, g);
@@ -6132,6 +6138,7 @@ prepare_copy_problem(const struct section_problem_data *in)
   out->enable_extended_info = in->enable_extended_info;
   out->stop_on_first_fail = in->stop_on_first_fail;
   out->enable_control_socket = in->enable_control_socket;
+  out->enable_checker_server = in->enable_checker_server;
   out->enable_user_input = in->enable_user_input;
   out->enable_vcs = in->enable_vcs;
   xstrdup3(&out->test_pat, in->test_pat);
@@ -6213,6 +6220,7 @@ prepare_copy_problem(const struct section_problem_data *in)
   out->max_file_size = in->max_file_size;
   out->max_open_file_count = in->max_open_file_count;
   out->max_process_count = in->max_process_count;
+  out->parallel_tests = in->parallel_tests;
   out->checker_max_vm_size = in->checker_max_vm_size;
   out->checker_max_stack_size = in->checker_max_stack_size;
   out->checker_max_rss_size = in->checker_max_rss_size;
@@ -6433,6 +6441,7 @@ prepare_set_prob_value(
   INHERIT_BOOLEAN(enable_extended_info);
   INHERIT_BOOLEAN(stop_on_first_fail);
   INHERIT_BOOLEAN(enable_control_socket);
+  INHERIT_BOOLEAN(enable_checker_server);
   INHERIT_BOOLEAN(enable_user_input);
   INHERIT_BOOLEAN(enable_vcs);
   INHERIT_BOOLEAN(hide_variant);
@@ -6483,6 +6492,10 @@ prepare_set_prob_value(
     if (out->max_process_count < 0 && abstr) out->max_process_count = abstr->max_process_count;
     break;
 
+  case CNTSPROB_parallel_tests:
+    if (out->parallel_tests < 0 && abstr) out->parallel_tests = abstr->parallel_tests;
+    break;
+
   case CNTSPROB_checker_max_vm_size:
     if (out->checker_max_vm_size < 0 && abstr) out->checker_max_vm_size = abstr->checker_max_vm_size;
     break;
@@ -7042,6 +7055,7 @@ prepare_set_all_prob_values(
     CNTSPROB_enable_extended_info,
     CNTSPROB_stop_on_first_fail,
     CNTSPROB_enable_control_socket,
+    CNTSPROB_enable_checker_server,
     CNTSPROB_enable_user_input,
     CNTSPROB_enable_vcs,
     CNTSPROB_hide_variant,
@@ -7101,6 +7115,7 @@ prepare_set_all_prob_values(
     CNTSPROB_max_file_size,
     CNTSPROB_max_open_file_count,
     CNTSPROB_max_process_count,
+    CNTSPROB_parallel_tests,
     CNTSPROB_checker_max_vm_size,
     CNTSPROB_checker_max_stack_size,
     CNTSPROB_checker_max_rss_size,
@@ -1325,6 +1325,9 @@ prepare_unparse_prob(
   if (prob->max_process_count >= 0) {
     fprintf(f, "max_process_count = %d\n", prob->max_process_count);
   }
+  if (prob->parallel_tests >= 0) {
+    fprintf(f, "parallel_tests = %d\n", prob->parallel_tests);
+  }
   if (prob->umask && prob->umask[0])
     fprintf(f, "umask = \"%s\"\n", CARMOR(prob->umask));
 
@@ -1602,6 +1605,10 @@ prepare_unparse_prob(
       || (!prob->abstract && prob->enable_control_socket >= 0)) {
     unparse_bool(f, "enable_control_socket", prob->enable_control_socket);
   }
+  if ((prob->abstract > 0 && prob->enable_checker_server > 0)
+      || (!prob->abstract && prob->enable_checker_server >= 0)) {
+    unparse_bool(f, "enable_checker_server", prob->enable_checker_server);
+  }
   if ((prob->abstract > 0 && prob->hide_variant > 0)
       || (!prob->abstract && prob->hide_variant >= 0)) {
     unparse_bool(f, "hide_variant", prob->hide_variant);
@@ -1811,6 +1818,9 @@ prepare_unparse_actual_prob(
   if (prob->max_process_count > 0) {
     fprintf(f, "max_process_count = %d\n", prob->max_process_count);
   }
+  if (prob->parallel_tests > 0) {
+    fprintf(f, "parallel_tests = %d\n", prob->parallel_tests);
+  }
   if (prob->umask && prob->umask[0])
     fprintf(f, "umask = \"%s\"\n", CARMOR(prob->umask));
 
@@ -2038,6 +2048,8 @@ prepare_unparse_actual_prob(
     unparse_bool(f, "stop_on_first_fail", prob->stop_on_first_fail);
   if (prob->enable_control_socket > 0)
     unparse_bool(f, "enable_control_socket", prob->enable_control_socket);
+  if (prob->enable_checker_server > 0)
+    unparse_bool(f, "enable_checker_server", prob->enable_checker_server);
   if (prob->hide_variant > 0)
     unparse_bool(f, "hide_variant", prob->hide_variant);
   if (prob->enable_text_form > 0)
@@ -40,6 +40,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <errno.h>
 
 enum
@@ -51,6 +52,7 @@ enum
 struct rldb_file_state
 {
   int nref;
+  int use_mmap;         /* map the runlog file instead of reading it */
 };
 
 struct rldb_file_cnts
@@ -58,7 +60,14 @@ struct rldb_file_cnts
   struct rldb_file_state *plugin_state;
   struct runlog_state *rl_state;
   int run_fd;
+  int readonly;
   unsigned char *runlog_path;
+
+  /* if the runlog is mapped, rl_state->runs points into the mapping,
+     rl_state->run_a is the number of records in the file */
+  unsigned char *map_addr;
+  size_t map_size;
+  int dirty_low, dirty_high; /* records changed since the last flush */
 };
 
 static struct common_plugin_data *
@@ -280,6 +289,23 @@ prepare_func(
         const struct ejudge_cfg *config,
         struct xml_tree *plugin_config)
 {
+  struct rldb_file_state *state = (struct rldb_file_state*) data;
+  const struct xml_parse_spec *spec = ejudge_cfg_get_spec();
+  const struct xml_attr *a = 0;
+
+  if (!plugin_config) return 0;
+
+  ASSERT(plugin_config->tag == spec->default_elem);
+  ASSERT(!strcmp(plugin_config->name[0], "config"));
+
+  for (a = plugin_config->first; a; a = a->next) {
+    ASSERT(a->tag == spec->default_attr);
+    if (!strcmp(a->name[0], "use_mmap")) {
+      if (xml_attr_bool(a, &state->use_mmap) < 0) return -1;
+    } else {
+      return xml_err_attr_not_allowed(plugin_config, a);
+    }
+  }
   return 0;
 }
 
@@ -517,9 +543,103 @@ do_truncate(struct rldb_file_cnts *cs)
     err("%s: ftruncate failed: %s", __FILE__, os_ErrorMsg());
     return -1;
   }
+  if (cs->map_addr) {
+    rls->run_a = rls->run_u;
+    if (cs->dirty_high > rls->run_u) cs->dirty_high = rls->run_u;
+  }
+  return 0;
+}
+
+/* map the runlog file, the records are accessed directly in the page cache */
+static int
+map_runlog(struct rldb_file_cnts *cs)
+{
+  struct runlog_state *rls = cs->rl_state;
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t need = sizeof(rls->head) + sizeof(rls->runs[0]) * rls->run_u;
+  size_t size = 1024 * 1024;
+
+  // reserve the address space for the growth of the runlog
+  while (size < 2 * need) size *= 2;
+  size = (size + page_size - 1) & ~(page_size - 1);
+
+  void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, cs->run_fd, 0);
+  if (addr == MAP_FAILED) {
+    err("map_runlog: mmap failed: %s", os_ErrorMsg());
+    return -1;
+  }
+  cs->map_addr = (unsigned char *) addr;
+  cs->map_size = size;
+  cs->dirty_low = cs->dirty_high = 0;
+  rls->runs = (struct run_entry *) (cs->map_addr + sizeof(rls->head));
+  rls->run_a = rls->run_u;
+  info("runlog is mapped, %d entries, %zu bytes reserved", rls->run_u, size);
+  return 0;
+}
+
+/* change the size of the mapped runlog file to hold `count' records */
+static int
+map_resize(struct rldb_file_cnts *cs, int count)
+{
+  struct runlog_state *rls = cs->rl_state;
+  size_t need = sizeof(rls->head) + sizeof(rls->runs[0]) * count;
+
+  if (ftruncate(cs->run_fd, need) < 0) {
+    err("map_resize: ftruncate failed: %s", os_ErrorMsg());
+    return -1;
+  }
+  if (need > cs->map_size) {
+    size_t new_size = cs->map_size;
+    while (new_size < need) new_size *= 2;
+    void *addr = mremap(cs->map_addr, cs->map_size, new_size, MREMAP_MAYMOVE);
+    if (addr == MAP_FAILED) {
+      err("map_resize: mremap failed: %s", os_ErrorMsg());
+      return -1;
+    }
+    cs->map_addr = (unsigned char *) addr;
+    cs->map_size = new_size;
+    rls->runs = (struct run_entry *) (cs->map_addr + sizeof(rls->head));
+  }
+  rls->run_a = count;
+  return 0;
+}
+
+/* write back the changed records of the mapped runlog at once */
+static int
+map_sync(struct rldb_file_cnts *cs)
+{
+  struct runlog_state *rls = cs->rl_state;
+  size_t page_size = sysconf(_SC_PAGESIZE);
+
+  if (cs->dirty_low >= cs->dirty_high) return 0;
+  size_t low = sizeof(rls->head) + sizeof(rls->runs[0]) * cs->dirty_low;
+  size_t high = sizeof(rls->head) + sizeof(rls->runs[0]) * cs->dirty_high;
+  low &= ~(page_size - 1);
+  cs->dirty_low = cs->dirty_high = 0;
+  if (msync(cs->map_addr + low, high - low, MS_SYNC) < 0) {
+    err("map_sync: msync failed: %s", os_ErrorMsg());
+    return -1;
+  }
   return 0;
 }
 
+static void
+free_runs(struct rldb_file_cnts *cs)
+{
+  struct runlog_state *rls = cs->rl_state;
+
+  if (cs->map_addr) {
+    map_sync(cs);
+    munmap(cs->map_addr, cs->map_size);
+    cs->map_addr = NULL;
+    cs->map_size = 0;
+  } else {
+    xfree(rls->runs);
+  }
+  rls->runs = 0;
+  rls->run_u = rls->run_a = 0;
+}
+
 static int
 write_full_runlog_current_version(
         struct rldb_file_cnts *cs,
@@ -946,6 +1066,10 @@ read_runlog(
   if (rem != 0) ERR_C("bad runs file size: remainder %d", rem);
 
   rls->run_u = (filesize - sizeof(struct run_header))/sizeof(struct run_entry);
+  if (cs->plugin_state->use_mmap > 0 && !cs->readonly) {
+    if (map_runlog(cs) < 0) goto _cleanup;
+    goto done;
+  }
   rls->run_a = 128;
   while (rls->run_u > rls->run_a) rls->run_a *= 2;
   XCALLOC(rls->runs, rls->run_a);
@@ -956,6 +1080,7 @@ read_runlog(
       return -1;
   }
 
+done:
   if (init_finish_time > 0 && rls->head.finish_time != init_finish_time) {
     rls->head.finish_time = init_finish_time;
     run_flush_header(cs);
@@ -993,13 +1118,13 @@ do_run_open(
   info("run_open: opening database %s", path);
 
   if (rls->runs) {
-    xfree(rls->runs); rls->runs = 0;
-    rls->run_u = rls->run_a = 0;
+    free_runs(cs);
   }
   if (cs->run_fd >= 0) {
     close(cs->run_fd);
     cs->run_fd = -1;
   }
+  cs->readonly = (flags == RUN_LOG_READONLY);
   if (flags == RUN_LOG_READONLY) {
     oflags = O_RDONLY;
   } else if (flags == RUN_LOG_CREATE) {
@@ -1103,8 +1228,7 @@ close_func(struct rldb_plugin_cnts *cdata)
   if (!cs) return 0;
   rls = cs->rl_state;
   if (rls) {
-    xfree(rls->runs); rls->runs = 0;
-    rls->run_a = rls->run_u = 0;
+    free_runs(cs);
   }
   if (cs->plugin_state) cs->plugin_state->nref--;
   if (cs->run_fd >= 0) close(cs->run_fd);
@@ -1142,6 +1266,10 @@ reset_func(
     err("ftruncate failed: %s", os_ErrorMsg());
     return -1;
   }
+  if (cs->map_addr) {
+    rls->run_a = 0;
+    cs->dirty_low = cs->dirty_high = 0;
+  }
   return run_flush_header(cs);
 }
 
@@ -1160,6 +1288,17 @@ set_runlog_func(
   // not implemented yet
   ASSERT(id_offset == 0);
 
+  if (cs->map_addr) {
+    if (map_resize(cs, total_entries) < 0) return -1;
+    rls->run_u = total_entries;
+    if (total_entries > 0) {
+      memcpy(rls->runs, entries, total_entries * sizeof(rls->runs[0]));
+      cs->dirty_low = 0;
+      cs->dirty_high = total_entries;
+    }
+    return 0;
+  }
+
   if (total_entries > rls->run_a) {
     if (!rls->run_a) rls->run_a = 128;
     xfree(rls->runs);
@@ -1204,6 +1343,7 @@ flush_func(struct rldb_plugin_cnts *cdata)
   struct runlog_state *rls = cs->rl_state;
 
   if (cs->run_fd < 0) ERR_R("invalid descriptor %d", cs->run_fd);
+  if (cs->map_addr) return map_sync(cs);
   if (sf_lseek(cs->run_fd, sizeof(rls->head), SEEK_SET, "run") == (off_t) -1)
     return -1;
   if (do_write(cs->run_fd, rls->runs, rls->run_u * sizeof(rls->runs[0])) < 0)
@@ -1239,7 +1379,11 @@ get_insert_run_id(
   struct run_entry *runs = 0;
 
   ASSERT(rls->run_u <= rls->run_a);
-  if (rls->run_u == rls->run_a) {
+  if (cs->map_addr) {
+    // the file grows by one record, it is shrunk back on failure
+    if (rls->run_u == rls->run_a && map_resize(cs, rls->run_u + 1) < 0)
+      return -1;
+  } else if (rls->run_u == rls->run_a) {
     int new_a = rls->run_a * 2;
     struct run_entry *new_r = 0;
 
@@ -1320,6 +1464,7 @@ get_insert_run_id(
   if (j < rls->run_u) {
     err("append_record: cannot safely insert a run at position %d", i);
     err("append_record: the run %d is transient!", j);
+    if (cs->map_addr) do_truncate(cs);
     return -1;
   }
 
@@ -1334,6 +1479,11 @@ get_insert_run_id(
   runs[i].status = RUN_EMPTY;
   runs[i].time = t;
   runs[i].nsec = nsec;
+  if (cs->map_addr) {
+    if (cs->dirty_low >= cs->dirty_high || i < cs->dirty_low) cs->dirty_low = i;
+    cs->dirty_high = rls->run_u;
+    return i;
+  }
   if (sf_lseek(cs->run_fd, sizeof(rls->head) + i * sizeof(runs[0]),
                SEEK_SET, "run") == (off_t) -1) return -1;
   if (do_write(cs->run_fd, &runs[i], (rls->run_u - i) * sizeof(runs[0])) < 0)
@@ -1350,6 +1500,17 @@ do_flush_entry(struct rldb_file_cnts *cs, int num)
 
   if (cs->run_fd < 0) ERR_R("invalid descriptor %d", cs->run_fd);
   if (num < 0 || num >= rls->run_u) ERR_R("invalid entry number %d", num);
+  if (cs->map_addr) {
+    // the record is already in the page cache, remember it for map_sync
+    if (cs->dirty_low >= cs->dirty_high) {
+      cs->dirty_low = num;
+      cs->dirty_high = num + 1;
+    } else {
+      if (num < cs->dirty_low) cs->dirty_low = num;
+      if (num >= cs->dirty_high) cs->dirty_high = num + 1;
+    }
+    return num;
+  }
   if (sf_lseek(cs->run_fd, sizeof(rls->head) + sizeof(rls->runs[0]) * num,
                SEEK_SET, "run") == (off_t) -1) return -1;
   if (do_write(cs->run_fd, &rls->runs[num], sizeof(rls->runs[0])) < 0)
@@ -1728,6 +1889,11 @@ squeeze_func(struct rldb_plugin_cnts *cdata)
 
   // update log on disk
   if (do_truncate(cs) < 0) return -1;
+  if (cs->map_addr && first_moved >= 0) {
+    cs->dirty_low = first_moved;
+    cs->dirty_high = rls->run_u;
+    return retval;
+  }
   if (first_moved == -1) {
     // no entries were moved because the only entries empty were the last
     return retval;
@@ -1,6 +1,6 @@
 /* -*- c -*- */
 
-/* Copyright (C) 2012-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2012-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -46,6 +46,7 @@
 #include "ejudge/exec.h"
 #include "ejudge/logger.h"
 #include "ejudge/process_stats.h"
+#include "ejudge/test_data_cache.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -62,7 +63,10 @@
 #include <signal.h>
 #include <utime.h>
 #include <sys/mman.h>
+#include <stddef.h>
 #ifndef __MINGW32__
+#include <poll.h>
+#include <sys/wait.h>
 #include <sys/vfs.h>
 #endif
 #ifdef HAVE_TERMIOS_H
@@ -2370,6 +2374,267 @@ report_args_and_env(testinfo_t *ti)
   return args;
 }
 
+/* the environment of the checker which does not depend on the test */
+static void
+setup_checker_run_environment(
+        tpTask tsk,
+        const struct super_run_in_global_packet *srgp,
+        const struct super_run_in_problem_packet *srpp)
+{
+  if (srpp->scoring_checker > 0) {
+    task_SetEnv(tsk, "EJUDGE_SCORING_CHECKER", "1");
+    if (srpp->enable_checker_token > 0) {
+      task_SetEnv(tsk, "EJUDGE_CHECKER_TOKEN", "1");
+    }
+  }
+  task_SetEnv(tsk, "EJUDGE", "1");
+  if (srgp->checker_locale && srgp->checker_locale[0]) {
+    task_SetEnv(tsk, "EJUDGE_LOCALE", srgp->checker_locale);
+  }
+  if (srpp->enable_extended_info > 0) {
+    unsigned char buf[64];
+    snprintf(buf, sizeof(buf), "%d", srgp->user_id);
+    task_SetEnv(tsk, "EJUDGE_USER_ID", buf);
+    snprintf(buf, sizeof(buf), "%d", srgp->contest_id);
+    task_SetEnv(tsk, "EJUDGE_CONTEST_ID", buf);
+    snprintf(buf, sizeof(buf), "%d", srgp->run_id);
+    task_SetEnv(tsk, "EJUDGE_RUN_ID", buf);
+    task_SetEnv(tsk, "EJUDGE_USER_LOGIN", srgp->user_login);
+    task_SetEnv(tsk, "EJUDGE_USER_NAME", srgp->user_name);
+    if (srpp->test_count > 0) {
+      snprintf(buf, sizeof(buf), "%d", srpp->test_count);
+      task_SetEnv(tsk, "EJUDGE_TEST_COUNT", buf);
+    }
+  }
+}
+
+#ifndef __WIN32__
+/*
+ * The checker linked with the server main (see checkers/checker.h)
+ * stays alive for the whole run. It gets a request for each test
+ * over the socket passed in EJUDGE_CHECKER_SERVER_FD, checks the
+ * test in a forked process and replies with its exit status.
+ */
+struct checker_server
+{
+  tpTask tsk;
+  int fd;
+  int pid;                      // the process which owns the server
+  int failed;                   // the checker does not support the mode
+  int detached;                 // do not use the server in this process
+  unsigned char *check_cmd;
+};
+static struct checker_server checker_server = { .fd = -1 };
+
+static void
+checker_server_stop(void)
+{
+  struct checker_server *cs = &checker_server;
+
+  if (cs->pid == getpid()) {
+    if (cs->fd >= 0) close(cs->fd);
+    if (cs->tsk) {
+      task_KillProcessGroup(cs->tsk);
+      task_Wait(cs->tsk);
+      task_Delete(cs->tsk);
+    }
+  } else if (cs->fd >= 0) {
+    // inherited from the parent process
+    close(cs->fd);
+  }
+  xfree(cs->check_cmd);
+  cs->tsk = NULL;
+  cs->fd = -1;
+  cs->pid = 0;
+  cs->failed = 0;
+  cs->check_cmd = NULL;
+}
+
+/* test workers of the parallel mode run one test each */
+static void
+checker_server_detach(void)
+{
+  checker_server_stop();
+  checker_server.detached = 1;
+}
+
+/* read a reply line, returns -2 on timeout */
+static int
+checker_server_read(int fd, int timeout_ms, unsigned char *buf, size_t size)
+{
+  size_t len = 0;
+  struct timespec ts;
+  long long deadline = 0;
+
+  if (timeout_ms > 0) {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    deadline = ts.tv_sec * 1000LL + ts.tv_nsec / 1000000 + timeout_ms;
+  }
+  buf[0] = 0;
+  while (1) {
+    int wait_ms = -1;
+    if (deadline > 0) {
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      long long now = ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+      if (now >= deadline) return -2;
+      wait_ms = deadline - now;
+    }
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    int r = poll(&pfd, 1, wait_ms);
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0) return -1;
+    if (!r) return -2;
+    ssize_t rr = read(fd, buf + len, size - len - 1);
+    if (rr < 0 && errno == EINTR) continue;
+    if (rr <= 0) return -1;
+    len += rr;
+    buf[len] = 0;
+    if (memchr(buf, '\n', len)) return len;
+    if (len >= size - 1) return -1;
+  }
+}
+
+static int
+checker_server_start(
+        const struct super_run_in_global_packet *srgp,
+        const struct super_run_in_problem_packet *srpp,
+        const unsigned char *check_cmd,
+        const unsigned char *check_dir,
+        const unsigned char *check_out_path)
+{
+  struct checker_server *cs = &checker_server;
+  int sfd[2] = { -1, -1 };
+  unsigned char buf[256];
+  tpTask tsk = NULL;
+
+  if (cs->detached) return -1;
+  if (cs->pid == getpid() && cs->check_cmd && !strcmp(cs->check_cmd, check_cmd)) {
+    if (cs->failed) return -1;
+    if (cs->tsk) return 0;
+  }
+  checker_server_stop();
+  cs->pid = getpid();
+  cs->check_cmd = xstrdup(check_cmd);
+
+  if (socketpair(PF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sfd) < 0) {
+    err("checker_server_start: socketpair failed: %s", os_ErrorMsg());
+    cs->failed = 1;
+    return -1;
+  }
+  // the other end is inherited by the checker
+  fcntl(sfd[1], F_SETFD, 0);
+
+  tsk = task_New();
+  task_AddArg(tsk, check_cmd);
+  task_SetPathAsArg0(tsk);
+  task_SetRedir(tsk, 0, TSR_FILE, "/dev/null", TSK_READ);
+  task_SetRedir(tsk, 1, TSR_FILE, check_out_path, TSK_APPEND, TSK_FULL_RW);
+  task_SetRedir(tsk, 2, TSR_DUP, 1);
+  task_SetWorkingDir(tsk, check_dir);
+  if (srpp->checker_max_stack_size > 0) {
+    task_SetStackSize(tsk, srpp->checker_max_stack_size);
+  }
+  if (srpp->checker_max_vm_size > 0) {
+    task_SetVMSize(tsk, srpp->checker_max_vm_size);
+  }
+  if (srpp->checker_max_rss_size > 0) {
+    task_SetRSSSize(tsk, srpp->checker_max_rss_size);
+  }
+  setup_environment(tsk, srpp->checker_env, 0, NULL, 1);
+  setup_checker_run_environment(tsk, srgp, srpp);
+  snprintf(buf, sizeof(buf), "%d", sfd[1]);
+  task_SetEnv(tsk, "EJUDGE_CHECKER_SERVER_FD", buf);
+  task_EnableProcessGroup(tsk);
+  task_EnableAllSignals(tsk);
+  task_PrintArgs(tsk);
+
+  if (task_Start(tsk) < 0) {
+    append_msg_to_log(check_out_path, "failed to start checker %s", check_cmd);
+    task_Delete(tsk);
+    close(sfd[0]);
+    close(sfd[1]);
+    cs->failed = 1;
+    return -1;
+  }
+  close(sfd[1]);
+  cs->tsk = tsk;
+  cs->fd = sfd[0];
+
+  int timeout_ms = srpp->checker_real_time_limit_ms;
+  if (timeout_ms <= 0) timeout_ms = 10000;
+  if (checker_server_read(cs->fd, timeout_ms, buf, sizeof(buf)) < 0
+      || strcmp(buf, "ready\n") != 0) {
+    append_msg_to_log(check_out_path,
+                      "checker %s does not support the server mode, starting it for each test",
+                      check_cmd);
+    checker_server_stop();
+    cs->pid = getpid();
+    cs->check_cmd = xstrdup(check_cmd);
+    cs->failed = 1;
+    return -1;
+  }
+  info("checker server %s started", check_cmd);
+  return 0;
+}
+
+/* send the request, the status is returned in *p_exitcode */
+static int
+checker_server_check(
+        const struct super_run_in_problem_packet *srpp,
+        const char *req_s,
+        size_t req_z,
+        const unsigned char *check_out_path,
+        int *p_exitcode)
+{
+  struct checker_server *cs = &checker_server;
+  unsigned char buf[256];
+  const char *p = req_s;
+  size_t z = req_z;
+
+  while (z > 0) {
+    ssize_t w = write(cs->fd, p, z);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) {
+      append_msg_to_log(check_out_path, "checker server write error: %s", os_ErrorMsg());
+      checker_server_stop();
+      return -1;
+    }
+    p += w; z -= w;
+  }
+
+  int r = checker_server_read(cs->fd, srpp->checker_real_time_limit_ms, buf, sizeof(buf));
+  if (r == -2) {
+    append_msg_to_log(check_out_path, "checker timeout (real time %d ms)",
+                      srpp->checker_real_time_limit_ms);
+    err("checker timeout (real time %d ms)", srpp->checker_real_time_limit_ms);
+    checker_server_stop();
+    return -1;
+  }
+  char kind = 0;
+  int value = 0;
+  long cpu_ms = 0;
+  if (r < 0 || sscanf(buf, "%c%d%ld", &kind, &value, &cpu_ms) != 3
+      || (kind != 'x' && kind != 's')) {
+    append_msg_to_log(check_out_path, "checker server terminated unexpectedly");
+    checker_server_stop();
+    return -1;
+  }
+  if (srpp->checker_time_limit_ms > 0
+      && (cpu_ms > srpp->checker_time_limit_ms || (kind == 's' && value == SIGXCPU))) {
+    append_msg_to_log(check_out_path, "checker timeout (%ld ms)", cpu_ms);
+    err("checker timeout (%ld ms)", cpu_ms);
+    return -1;
+  }
+  if (kind == 's') {
+    append_msg_to_log(check_out_path, "checker terminated with signal %d (%s)",
+                      value, os_GetSignalString(value));
+    return -1;
+  }
+  *p_exitcode = value;
+  return 0;
+}
+#endif
+
 static int
 invoke_checker(
         const struct super_run_in_global_packet *srgp,
@@ -2398,12 +2663,87 @@ invoke_checker(
   int env_u = 0;
   char **env_v = 0;
   int user_score_mode = 0;
+  int exitcode = 0;
 
   if (ti) {
     env_u = ti->checker_env.u;
     env_v = ti->checker_env.v;
   }
 
+  switch (srgp->scoring_system_val) {
+  case SCORE_KIROV:
+  case SCORE_OLYMPIAD:
+    test_max_score = -1;
+    if (test_score_val && cur_test > 0 && cur_test < test_score_count) {
+      test_max_score = test_score_val[cur_test];
+    }
+    if (test_max_score < 0) {
+      test_max_score = srpp->test_score;
+    }
+    if (test_max_score < 0) test_max_score = 0;
+    break;
+  case SCORE_MOSCOW:
+    test_max_score = srpp->full_score - 1;
+    break;
+  case SCORE_ACM:
+    test_max_score = 0;
+    break;
+  default:
+    abort();
+  }
+  if (srgp->separate_user_score > 0 && output_only > 0) {
+    user_score_mode = 1;
+  }
+
+#ifndef __WIN32__
+  if (srpp->enable_checker_server > 0
+      && checker_server_start(srgp, srpp, check_cmd, check_dir, check_out_path) >= 0) {
+    char *req_s = NULL;
+    size_t req_z = 0;
+    FILE *req_f = open_memstream(&req_s, &req_z);
+    fprintf(req_f, "a %s\na %s\n", test_src, output_path);
+    if (srpp->use_corr > 0) {
+      fprintf(req_f, "a %s\n", corr_src);
+    }
+    if (srpp->use_info > 0) {
+      fprintf(req_f, "a %s\n", info_src);
+    }
+    if (srpp->use_tgz > 0) {
+      fprintf(req_f, "a %s\na %s\n", tgzdir_src, working_dir);
+    }
+    fprintf(req_f, "d %s\n", check_dir);
+    if (srpp->scoring_checker > 0) {
+      fprintf(req_f, "o %s\nE %s\n", score_out_path, check_out_path);
+    } else {
+      fprintf(req_f, "O %s\n", check_out_path);
+    }
+    if (srpp->checker_time_limit_ms > 0) {
+      fprintf(req_f, "t %d\n", srpp->checker_time_limit_ms);
+    }
+    for (int i = 0; env_v && i < env_u; ++i) {
+      if (env_v[i]) fprintf(req_f, "e %s\n", env_v[i]);
+    }
+    if (srpp->scoring_checker > 0) {
+      fprintf(req_f, "e EJUDGE_MAX_SCORE=%d\n", test_max_score);
+    }
+    if (user_score_mode) {
+      fprintf(req_f, "e EJUDGE_USER_SCORE=1\n");
+    }
+    if (srpp->enable_extended_info > 0) {
+      fprintf(req_f, "e EJUDGE_TEST_NUM=%d\n", cur_test);
+    }
+    fprintf(req_f, "\n");
+    fclose(req_f); req_f = NULL;
+    int r = checker_server_check(srpp, req_s, req_z, check_out_path, &exitcode);
+    free(req_s); req_s = NULL;
+    if (r < 0) {
+      status = RUN_CHECK_FAILED;
+      goto cleanup;
+    }
+    goto checker_exited;
+  }
+#endif
+
   tsk = task_New();
   task_AddArg(tsk, check_cmd);
   task_SetPathAsArg0(tsk);
@@ -2447,61 +2787,20 @@ invoke_checker(
     task_SetRSSSize(tsk, srpp->checker_max_rss_size);
   }
 	
-  switch (srgp->scoring_system_val) {
-  case SCORE_KIROV:
-  case SCORE_OLYMPIAD:
-    test_max_score = -1;
-    if (test_score_val && cur_test > 0 && cur_test < test_score_count) {
-      test_max_score = test_score_val[cur_test];
-    }
-    if (test_max_score < 0) {
-      test_max_score = srpp->test_score;
-    }
-    if (test_max_score < 0) test_max_score = 0;
-    break;
-  case SCORE_MOSCOW:
-    test_max_score = srpp->full_score - 1;
-    break;
-  case SCORE_ACM:
-    test_max_score = 0;
-    break;
-  default:
-    abort();
-  }
   setup_environment(tsk, srpp->checker_env, env_u, env_v, 1);
+  setup_checker_run_environment(tsk, srgp, srpp);
   if (srpp->scoring_checker > 0) {
-    task_SetEnv(tsk, "EJUDGE_SCORING_CHECKER", "1");
-    if (srpp->enable_checker_token > 0) {
-      task_SetEnv(tsk, "EJUDGE_CHECKER_TOKEN", "1");
-    }
     unsigned char buf[64];
     snprintf(buf, sizeof(buf), "%d", test_max_score);
     task_SetEnv(tsk, "EJUDGE_MAX_SCORE", buf);
   }
-  task_SetEnv(tsk, "EJUDGE", "1");
-  if (srgp->checker_locale && srgp->checker_locale[0]) {
-    task_SetEnv(tsk, "EJUDGE_LOCALE", srgp->checker_locale);
-  }
-  if (srgp->separate_user_score > 0 && output_only > 0) {
+  if (user_score_mode) {
     task_SetEnv(tsk, "EJUDGE_USER_SCORE", "1");
-    user_score_mode = 1;
   }
   if (srpp->enable_extended_info > 0) {
     unsigned char buf[64];
-    snprintf(buf, sizeof(buf), "%d", srgp->user_id);
-    task_SetEnv(tsk, "EJUDGE_USER_ID", buf);
-    snprintf(buf, sizeof(buf), "%d", srgp->contest_id);
-    task_SetEnv(tsk, "EJUDGE_CONTEST_ID", buf);
-    snprintf(buf, sizeof(buf), "%d", srgp->run_id);
-    task_SetEnv(tsk, "EJUDGE_RUN_ID", buf);
     snprintf(buf, sizeof(buf), "%d", cur_test);
     task_SetEnv(tsk, "EJUDGE_TEST_NUM", buf);
-    task_SetEnv(tsk, "EJUDGE_USER_LOGIN", srgp->user_login);
-    task_SetEnv(tsk, "EJUDGE_USER_NAME", srgp->user_name);
-    if (srpp->test_count > 0) {
-      snprintf(buf, sizeof(buf), "%d", srpp->test_count);
-      task_SetEnv(tsk, "EJUDGE_TEST_COUNT", buf);
-    }
   }
   task_EnableAllSignals(tsk);
 
@@ -2533,7 +2832,9 @@ invoke_checker(
     goto cleanup;
   }
 
-  int exitcode = task_ExitCode(tsk);
+  exitcode = task_ExitCode(tsk);
+
+checker_exited:
   if (exitcode == 1) exitcode = RUN_WRONG_ANSWER_ERR;
   if (exitcode == 2) exitcode = RUN_PRESENTATION_ERR;
   if (exitcode == RUN_PRESENTATION_ERR && srpp->disable_pe > 0) {
@@ -2712,12 +3013,32 @@ does_test_exist(
 
   test_src[0] = 0;
   if (srpp->test_pat && srpp->test_pat[0]) {
+    int count = test_data_cache_count(NULL, srpp->test_dir, srpp->test_pat);
+    if (count >= 0) return cur_test <= count;
     snprintf(test_base, sizeof(test_base), srpp->test_pat, cur_test);
     snprintf(test_src, sizeof(test_src), "%s/%s", srpp->test_dir, test_base);
   }
   return os_CheckAccess(test_src, REUSE_R_OK) >= 0;
 }
 
+/* in the parallel mode the files are collected in the stage directory
+   and appended to the archive by the parent process in the test order */
+static void
+archive_test_file(
+        full_archive_t far,
+        const unsigned char *stage_dir,
+        const unsigned char *entry_name,
+        const unsigned char *path)
+{
+  if (stage_dir) {
+    if (generic_copy_file(0, NULL, path, "", 0, stage_dir, entry_name, "") < 0) {
+      err("failed to copy %s to %s/%s", path, stage_dir, entry_name);
+    }
+  } else if (far) {
+    full_archive_append_file(far, entry_name, 0, path);
+  }
+}
+
 static int
 run_one_test(
         const struct ejudge_cfg *config,
@@ -2728,6 +3049,8 @@ run_one_test(
         int cur_test,
         struct testinfo_vector *tests,
         full_archive_t far,
+        const unsigned char *stage_dir,
+        const unsigned char *check_dir,
         const unsigned char *exe_name,
         const unsigned char *report_path,
         const unsigned char *check_cmd,
@@ -2771,7 +3094,6 @@ run_one_test(
   const unsigned char *output_path_to_check = NULL;
   unsigned char test_checker_out_path[PATH_MAX];
 
-  unsigned char check_dir[PATH_MAX];
   unsigned char exe_path[PATH_MAX];
   unsigned char working_dir[PATH_MAX];
   unsigned char input_path[PATH_MAX];
@@ -2830,15 +3152,25 @@ run_one_test(
     return -1;
   }
 
-  if (srpp->test_count > 0 && cur_test > srpp->test_count) {
+  // the test count comes from the packet or the test data cache manifest
+  int test_count = srpp->test_count;
+  if (test_count <= 0) {
+    test_count = test_data_cache_count(NULL, srpp->test_dir, srpp->test_pat);
+  }
+  if (test_count > 0 && cur_test > test_count) {
     return -1;
   }
 
   test_base[0] = 0;
   test_src[0] = 0;
+  int test_cached = 0;
   if (srpp->test_pat && srpp->test_pat[0]) {
     snprintf(test_base, sizeof(test_base), srpp->test_pat, cur_test);
     snprintf(test_src, sizeof(test_src), "%s/%s", srpp->test_dir, test_base);
+    if (test_data_cache_lookup(NULL, srpp->test_dir, srpp->test_pat, cur_test,
+                               test_src, sizeof(test_src)) >= 0) {
+      test_cached = 1;
+    }
   }
   corr_base[0] = 0;
   corr_src[0] = 0;
@@ -2846,7 +3178,9 @@ run_one_test(
     snprintf(corr_base, sizeof(corr_base), srpp->corr_pat, cur_test);
     snprintf(corr_src, sizeof(corr_src), "%s/%s", srpp->corr_dir, corr_base);
   }
-  if (srpp->use_corr > 0 && corr_src[0]) {
+  if (srpp->use_corr > 0 && corr_src[0]
+      && test_data_cache_lookup(NULL, srpp->corr_dir, srpp->corr_pat, cur_test,
+                                corr_src, sizeof(corr_src)) < 0) {
     mirror_file(agent, corr_src, sizeof(corr_src), mirror_dir);
   }
   info_base[0] = 0;
@@ -2854,6 +3188,8 @@ run_one_test(
   if (srpp->use_info > 0) {
     snprintf(info_base, sizeof(info_base), srpp->info_pat, cur_test);
     snprintf(info_src, sizeof(info_src), "%s/%s", srpp->info_dir, info_base);
+    test_data_cache_lookup(NULL, srpp->info_dir, srpp->info_pat, cur_test,
+                           info_src, sizeof(info_src));
   }
   tgz_base[0] = 0;
   tgzdir_base[0] = 0;
@@ -2867,16 +3203,10 @@ run_one_test(
   }
 
   // avoid check access operation if the test count is known
-  if (srpp->test_count <= 0 && os_CheckAccess(test_src, REUSE_R_OK) < 0) {
+  if (test_count <= 0 && os_CheckAccess(test_src, REUSE_R_OK) < 0) {
     return -1;
   }
 
-  if (tst && tst->check_dir && tst->check_dir[0]) {
-    snprintf(check_dir, sizeof(check_dir), "%s", tst->check_dir);
-  } else {
-    snprintf(check_dir, sizeof(check_dir), "%s", global->run_check_dir);
-  }
-
   ASSERT(cur_test == tests->size);
 
   if (tests->size >= tests->reserved) {
@@ -3085,7 +3415,11 @@ run_one_test(
     xfree(bytes_s);
     if (log_f) fclose(log_f);
   } else {
-    if (generic_copy_file(0, global->run_work_dir, exe_name, "", 0, check_dir, exe_name, "") < 0) {
+    unsigned char exe_src_path[PATH_MAX];
+    unsigned char exe_dst_path[PATH_MAX];
+    snprintf(exe_src_path, sizeof(exe_src_path), "%s/%s", global->run_work_dir, exe_name);
+    snprintf(exe_dst_path, sizeof(exe_dst_path), "%s/%s", check_dir, exe_name);
+    if (stage_file(exe_src_path, exe_dst_path) < 0) {
       append_msg_to_log(check_out_path, "failed to copy %s/%s -> %s/%s", global->run_work_dir, exe_name,
                         check_dir, exe_name);
       goto check_failed;
@@ -3176,8 +3510,18 @@ run_one_test(
     }
   } else {
     /* copy the test */
-    mirror_file(agent, test_src, sizeof(test_src), mirror_dir);
-    if (generic_copy_file(0, NULL, test_src, "", copy_flag, check_dir, srpp->input_file, "") < 0) {
+    if (!test_cached) {
+      mirror_file(agent, test_src, sizeof(test_src), mirror_dir);
+    }
+    int r;
+    if (copy_flag) {
+      r = generic_copy_file(0, NULL, test_src, "", copy_flag, check_dir, srpp->input_file, "");
+    } else {
+      unsigned char test_dst[PATH_MAX];
+      snprintf(test_dst, sizeof(test_dst), "%s/%s", check_dir, srpp->input_file);
+      r = stage_file(test_src, test_dst);
+    }
+    if (r < 0) {
       append_msg_to_log(check_out_path, "failed to copy test file %s -> %s/%s",
                         test_src, check_dir, srpp->input_file);
       goto check_failed;
@@ -3476,6 +3820,8 @@ run_one_test(
       task_AppendContainerOptions(tsk, srgp->lang_container_options);
     if (srgp->lang_short_name && *srgp->lang_short_name)
       task_SetLanguageName(tsk, srgp->lang_short_name);
+    if (config && config->container_pool_size > 0)
+      task_SetContainerPool(tsk, config->container_pool_size);
     if (tst->secure_exec_type_val == SEXEC_TYPE_JAVA) {
       task_PutEnv(tsk, "EJUDGE_JAVA_POLICY=fileio.policy");
     }
@@ -3711,9 +4057,9 @@ run_one_test(
     if (srgp->max_file_length > 0 && srgp->enable_full_archive <= 0 && file_size <= srgp->max_file_length) {
       generic_read_file(&cur_info->output, 0, 0, 0, 0, output_path, "");
     }
-    if (far) {
+    if (far || stage_dir) {
       snprintf(arch_entry_name, sizeof(arch_entry_name), "%06d.o", cur_test);
-      full_archive_append_file(far, arch_entry_name, 0, output_path);
+      archive_test_file(far, stage_dir, arch_entry_name, output_path);
     }
   }
 
@@ -3727,9 +4073,9 @@ run_one_test(
     if (srgp->max_file_length > 0 && srgp->enable_full_archive <= 0 && file_size <= srgp->max_file_length) {
       generic_read_file(&cur_info->error, 0, 0, 0, 0, error_path, "");
     }
-    if (far) {
+    if (far || stage_dir) {
       snprintf(arch_entry_name, sizeof(arch_entry_name), "%06d.e", cur_test);
-      full_archive_append_file(far, arch_entry_name, 0, error_path);
+      archive_test_file(far, stage_dir, arch_entry_name, error_path);
     }
   }
 
@@ -3946,9 +4292,9 @@ read_checker_output:;
   if (file_size >= 0) {
     cur_info->chk_out_size = file_size;
     generic_read_file(&cur_info->chk_out, 0, 0, 0, 0, check_out_path, "");
-    if (far) {
+    if (far || stage_dir) {
       snprintf(arch_entry_name, sizeof(arch_entry_name), "%06d.c", cur_test);
-      full_archive_append_file(far, arch_entry_name, 0, check_out_path);
+      archive_test_file(far, stage_dir, arch_entry_name, check_out_path);
     }
   }
 
@@ -3991,6 +4337,71 @@ check_failed:
   goto read_checker_output;
 }
 
+static int
+run_one_test_retry(
+        const struct ejudge_cfg *config,
+        serve_state_t state,
+        const struct super_run_in_packet *srp,
+        const struct section_tester_data *tst,
+        struct AgentClient *agent,
+        int cur_test,
+        struct testinfo_vector *tests,
+        full_archive_t far,
+        const unsigned char *stage_dir,
+        const unsigned char *check_dir,
+        const unsigned char *exe_name,
+        const unsigned char *report_path,
+        const unsigned char *check_cmd,
+        const unsigned char *interactor_cmd,
+        char **start_env,
+        int open_tests_count,
+        const int *open_tests_val,
+        int test_score_count,
+        const int *test_score_val,
+        long long expected_free_space,
+        int *p_has_real_time,
+        int *p_has_max_memory_used,
+        int *p_has_max_rss,
+        long *p_report_time_limit_ms,
+        long *p_report_real_time_limit_ms,
+        const unsigned char *mirror_dir,
+        const struct remap_spec *remaps,
+        int user_input_mode,
+        const unsigned char *inp_data,
+        size_t inp_size)
+{
+  int tl_retry = 0;
+  int tl_retry_count = srp->global->time_limit_retry_count;
+  int status;
+
+  if (tl_retry_count <= 0) tl_retry_count = 1;
+
+  while (1) {
+    status = run_one_test(config, state, srp, tst,
+                          agent,
+                          cur_test, tests,
+                          far, stage_dir, check_dir,
+                          exe_name, report_path, check_cmd,
+                          interactor_cmd, start_env,
+                          open_tests_count, open_tests_val,
+                          test_score_count, test_score_val,
+                          expected_free_space,
+                          p_has_real_time, p_has_max_memory_used,
+                          p_has_max_rss,
+                          p_report_time_limit_ms, p_report_real_time_limit_ms,
+                          mirror_dir, remaps,
+                          user_input_mode,
+                          inp_data,
+                          inp_size);
+    if (status != RUN_TIME_LIMIT_ERR && status != RUN_WALL_TIME_LIMIT_ERR)
+      break;
+    if (++tl_retry >= tl_retry_count) break;
+    info("test failed due to TL, do it again");
+    --tests->size;
+  }
+  return status;
+}
+
 static void
 init_testinfo_vector(struct testinfo_vector *tv)
 {
@@ -4228,10 +4639,14 @@ check_output_only(
     snprintf(corr_base, sizeof(corr_base), srpp->corr_pat, cur_test);
     snprintf(corr_src, sizeof(corr_src), "%s/%s", srpp->corr_dir, corr_base);
   }
-  if (test_src[0]) {
+  if (test_src[0]
+      && test_data_cache_lookup(NULL, srpp->test_dir, srpp->test_pat, cur_test,
+                                test_src, sizeof(test_src)) < 0) {
     mirror_file(agent, test_src, sizeof(test_src), mirror_dir);
   }
-  if (srpp->use_corr > 0 && corr_src[0]) {
+  if (srpp->use_corr > 0 && corr_src[0]
+      && test_data_cache_lookup(NULL, srpp->corr_dir, srpp->corr_pat, cur_test,
+                                corr_src, sizeof(corr_src)) < 0) {
     mirror_file(agent, corr_src, sizeof(corr_src), mirror_dir);
   }
 
@@ -4446,6 +4861,423 @@ append_skipped_test(
   cur_info->max_score = test_max_score;
 }
 
+#ifndef __WIN32__
+/*
+ * Parallel testing: each test is run in a separate process with its
+ * own check directory. The worker writes the test result and the files
+ * for the full archive to the per-test stage directory, and the parent
+ * merges them in the test order, so the report does not depend on
+ * the order in which the tests complete.
+ */
+
+static const size_t testinfo_string_offsets[] =
+{
+  offsetof(struct testinfo, input),
+  offsetof(struct testinfo, output),
+  offsetof(struct testinfo, error),
+  offsetof(struct testinfo, correct),
+  offsetof(struct testinfo, chk_out),
+  offsetof(struct testinfo, test_checker),
+  offsetof(struct testinfo, args),
+  offsetof(struct testinfo, comment),
+  offsetof(struct testinfo, team_comment),
+  offsetof(struct testinfo, exit_comment),
+  offsetof(struct testinfo, program_stats_str),
+  offsetof(struct testinfo, interactor_stats_str),
+  offsetof(struct testinfo, checker_stats_str),
+  offsetof(struct testinfo, checker_token),
+};
+/* the corresponding size fields, 0 for nul-terminated strings */
+static const size_t testinfo_size_offsets[] =
+{
+  offsetof(struct testinfo, input_size),
+  offsetof(struct testinfo, output_size),
+  offsetof(struct testinfo, error_size),
+  offsetof(struct testinfo, correct_size),
+  offsetof(struct testinfo, chk_out_size),
+  offsetof(struct testinfo, test_checker_size),
+  0, 0, 0, 0, 0, 0, 0, 0,
+};
+enum { TESTINFO_STRING_COUNT = sizeof(testinfo_string_offsets) / sizeof(testinfo_string_offsets[0]) };
+
+struct parallel_test_result
+{
+  int status;
+  int has_real_time;
+  int has_max_memory_used;
+  int has_max_rss;
+  long report_time_limit_ms;
+  long report_real_time_limit_ms;
+  struct testinfo info;         /* string pointers are not used */
+  long long lengths[TESTINFO_STRING_COUNT]; /* -1 for NULL */
+};
+
+struct parallel_test_worker
+{
+  int pid;
+  int fd;                       /* EOF when the worker exits */
+  int test_num;
+  unsigned char check_dir[PATH_MAX];
+};
+
+static int
+write_parallel_test_result(
+        const unsigned char *path,
+        struct parallel_test_result *res,
+        const struct testinfo *ti)
+{
+  FILE *f = NULL;
+  int i;
+
+  memset(&res->info, 0, sizeof(res->info));
+  if (ti) res->info = *ti;
+  for (i = 0; i < TESTINFO_STRING_COUNT; ++i) {
+    char **pp = (char **) ((char *) &res->info + testinfo_string_offsets[i]);
+    long long len = -1;
+    if (*pp) {
+      if (testinfo_size_offsets[i]) {
+        len = *(const long *) ((const char *) &res->info + testinfo_size_offsets[i]);
+      }
+      if (len < 0) len = strlen(*pp);
+    }
+    res->lengths[i] = len;
+    *pp = NULL;
+  }
+
+  if (!(f = fopen(path, "wb"))) {
+    err("failed to open %s: %s", path, os_ErrorMsg());
+    return -1;
+  }
+  fwrite(res, sizeof(*res), 1, f);
+  for (i = 0; i < TESTINFO_STRING_COUNT; ++i) {
+    if (res->lengths[i] > 0) {
+      const char *s = *(char * const *) ((const char *) ti + testinfo_string_offsets[i]);
+      fwrite(s, 1, res->lengths[i], f);
+    }
+  }
+  if (ferror(f)) {
+    err("failed to write %s", path);
+    fclose(f);
+    return -1;
+  }
+  if (fclose(f) < 0) {
+    err("failed to write %s: %s", path, os_ErrorMsg());
+    return -1;
+  }
+  return 0;
+}
+
+static int
+read_parallel_test_result(
+        const unsigned char *path,
+        struct parallel_test_result *res)
+{
+  FILE *f = NULL;
+  int i;
+
+  memset(res, 0, sizeof(*res));
+  if (!(f = fopen(path, "rb"))) {
+    err("failed to open %s: %s", path, os_ErrorMsg());
+    return -1;
+  }
+  if (fread(res, sizeof(*res), 1, f) != 1) goto fail;
+  for (i = 0; i < TESTINFO_STRING_COUNT; ++i) {
+    char **pp = (char **) ((char *) &res->info + testinfo_string_offsets[i]);
+    long long len = res->lengths[i];
+    *pp = NULL;
+    if (len < 0) continue;
+    if (len > INT_MAX) goto fail;
+    *pp = xmalloc(len + 1);
+    if (len > 0 && fread(*pp, 1, len, f) != len) goto fail;
+    (*pp)[len] = 0;
+  }
+  fclose(f);
+  return 0;
+
+fail:
+  err("invalid testing result file %s", path);
+  for (i = 0; i < TESTINFO_STRING_COUNT; ++i) {
+    char **pp = (char **) ((char *) &res->info + testinfo_string_offsets[i]);
+    if (res->lengths[i] >= 0) xfree(*pp);
+    *pp = NULL;
+  }
+  fclose(f);
+  return -1;
+}
+
+static int
+run_tests_parallel(
+        const struct ejudge_cfg *config,
+        serve_state_t state,
+        const struct super_run_in_packet *srp,
+        const struct section_tester_data *tst,
+        int worker_count,
+        int test_count,
+        struct testinfo_vector *tests,
+        full_archive_t far,
+        const unsigned char *messages_path,
+        const unsigned char *check_dir,
+        const unsigned char *exe_name,
+        const unsigned char *report_path,
+        const unsigned char *check_cmd,
+        char **start_env,
+        int open_tests_count,
+        const int *open_tests_val,
+        int test_score_count,
+        const int *test_score_val,
+        long long expected_free_space,
+        int *p_has_real_time,
+        int *p_has_max_memory_used,
+        int *p_has_max_rss,
+        long *p_report_time_limit_ms,
+        long *p_report_real_time_limit_ms,
+        int *p_tests_passed,
+        const unsigned char *mirror_dir,
+        const struct remap_spec *remaps,
+        struct run_listener *listener)
+{
+  const struct section_global_data *global = state->global;
+  struct parallel_test_worker *workers = NULL;
+  struct pollfd *pfds = NULL;
+  int *poll_map = NULL;
+  unsigned char stage_dir[PATH_MAX];
+  unsigned char result_path[PATH_MAX];
+  unsigned char arch_path[PATH_MAX];
+  unsigned char arch_entry_name[PATH_MAX];
+  static const char arch_suffixes[] = "oec";
+  int next_test = 1, running = 0, failed = 0, retval = -1;
+  int i, j, n, cur_test;
+
+  if (worker_count > test_count) worker_count = test_count;
+  info("running %d tests in %d processes", test_count, worker_count);
+
+  XCALLOC(workers, worker_count);
+  XCALLOC(pfds, worker_count);
+  XCALLOC(poll_map, worker_count);
+  for (i = 0; i < worker_count; ++i) {
+    workers[i].pid = -1;
+    workers[i].fd = -1;
+  }
+  for (i = 0; i < worker_count; ++i) {
+    snprintf(workers[i].check_dir, sizeof(workers[i].check_dir), "%s_w%d", check_dir, i + 1);
+    if (os_MakeDirPath(workers[i].check_dir, 0755) < 0) {
+      append_msg_to_log(messages_path, "failed to create check directory %s", workers[i].check_dir);
+      goto cleanup;
+    }
+  }
+
+  while (1) {
+    while (!failed && running < worker_count && next_test <= test_count) {
+      int pfd[2] = { -1, -1 };
+      int pid;
+
+      for (i = 0; workers[i].pid > 0; ++i);
+      cur_test = next_test++;
+      if (listener && listener->ops && listener->ops->before_test) {
+        listener->ops->before_test(listener, cur_test);
+      }
+
+      snprintf(stage_dir, sizeof(stage_dir), "%s/partest_%06d", global->run_work_dir, cur_test);
+      if (os_MakeDirPath(stage_dir, 0755) < 0) {
+        append_msg_to_log(messages_path, "failed to create directory %s", stage_dir);
+        failed = 1;
+        break;
+      }
+      clear_directory(stage_dir);
+      if (pipe2(pfd, O_CLOEXEC) < 0) {
+        append_msg_to_log(messages_path, "pipe() failed: %s", os_ErrorMsg());
+        failed = 1;
+        break;
+      }
+      if ((pid = fork()) < 0) {
+        append_msg_to_log(messages_path, "fork() failed: %s", os_ErrorMsg());
+        close(pfd[0]);
+        close(pfd[1]);
+        failed = 1;
+        break;
+      }
+      if (!pid) {
+        // the worker process
+        struct parallel_test_result res;
+        int status;
+
+        close(pfd[0]);
+        checker_server_detach();
+        memset(&res, 0, sizeof(res));
+        res.report_time_limit_ms = -1;
+        res.report_real_time_limit_ms = -1;
+        // the parent has not collected the results of the preceding
+        // tests yet, so the vector may be too short for cur_test
+        if (cur_test >= tests->reserved) {
+          int new_reserved = tests->reserved;
+          if (!new_reserved) new_reserved = 32;
+          while (new_reserved <= cur_test) new_reserved *= 2;
+          tests->data = (typeof(tests->data)) xrealloc(tests->data, new_reserved * sizeof(tests->data[0]));
+          memset(&tests->data[tests->reserved], 0, (new_reserved - tests->reserved) * sizeof(tests->data[0]));
+          tests->reserved = new_reserved;
+        }
+        tests->size = cur_test;
+        status = run_one_test_retry(config, state, srp, tst,
+                                    NULL,
+                                    cur_test, tests,
+                                    NULL, stage_dir, workers[i].check_dir,
+                                    exe_name, report_path, check_cmd,
+                                    NULL, start_env,
+                                    open_tests_count, open_tests_val,
+                                    test_score_count, test_score_val,
+                                    expected_free_space,
+                                    &res.has_real_time, &res.has_max_memory_used,
+                                    &res.has_max_rss,
+                                    &res.report_time_limit_ms,
+                                    &res.report_real_time_limit_ms,
+                                    mirror_dir, remaps,
+                                    0, NULL, 0);
+        res.status = status;
+        snprintf(result_path, sizeof(result_path), "%s/result", stage_dir);
+        if (write_parallel_test_result(result_path, &res,
+                                       (status >= 0)?&tests->data[cur_test]:NULL) < 0) {
+          _exit(1);
+        }
+        _exit(0);
+      }
+      close(pfd[1]);
+      workers[i].pid = pid;
+      workers[i].fd = pfd[0];
+      workers[i].test_num = cur_test;
+      ++running;
+    }
+    if (!running) break;
+
+    for (i = 0, n = 0; i < worker_count; ++i) {
+      if (workers[i].pid > 0) {
+        pfds[n].fd = workers[i].fd;
+        pfds[n].events = POLLIN;
+        pfds[n].revents = 0;
+        poll_map[n++] = i;
+      }
+    }
+    if (poll(pfds, n, -1) < 0) {
+      if (errno == EINTR) continue;
+      err("run_tests_parallel: poll failed: %s", os_ErrorMsg());
+      // just wait for all the workers
+      for (j = 0; j < n; ++j) pfds[j].revents = POLLHUP;
+    }
+    for (j = 0; j < n; ++j) {
+      int wstatus = 0;
+
+      if (!pfds[j].revents) continue;
+      i = poll_map[j];
+      while (waitpid(workers[i].pid, &wstatus, 0) < 0 && errno == EINTR);
+      if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+        append_msg_to_log(messages_path, "test %d: testing process terminated abnormally",
+                          workers[i].test_num);
+      }
+      close(workers[i].fd);
+      workers[i].pid = -1;
+      workers[i].fd = -1;
+      --running;
+    }
+  }
+  if (failed) goto cleanup;
+
+  for (cur_test = 1; cur_test <= test_count; ++cur_test) {
+    struct parallel_test_result res;
+
+    snprintf(stage_dir, sizeof(stage_dir), "%s/partest_%06d", global->run_work_dir, cur_test);
+    snprintf(result_path, sizeof(result_path), "%s/result", stage_dir);
+    if (read_parallel_test_result(result_path, &res) < 0) {
+      append_msg_to_log(messages_path, "test %d: testing result is not available", cur_test);
+      goto cleanup;
+    }
+    // the test does not exist
+    if (res.status < 0) break;
+
+    ASSERT(cur_test == tests->size);
+    if (tests->size >= tests->reserved) {
+      tests->reserved *= 2;
+      if (!tests->reserved) tests->reserved = 32;
+      tests->data = (typeof(tests->data)) xrealloc(tests->data, tests->reserved * sizeof(tests->data[0]));
+    }
+    tests->data[tests->size++] = res.info;
+
+    if (res.has_real_time) *p_has_real_time = 1;
+    if (res.has_max_memory_used) *p_has_max_memory_used = 1;
+    if (res.has_max_rss) *p_has_max_rss = 1;
+    if (res.report_time_limit_ms != -1) *p_report_time_limit_ms = res.report_time_limit_ms;
+    if (res.report_real_time_limit_ms != -1) *p_report_real_time_limit_ms = res.report_real_time_limit_ms;
+    if (res.status == RUN_OK) ++(*p_tests_passed);
+
+    if (far) {
+      for (j = 0; arch_suffixes[j]; ++j) {
+        snprintf(arch_entry_name, sizeof(arch_entry_name), "%06d.%c", cur_test, arch_suffixes[j]);
+        snprintf(arch_path, sizeof(arch_path), "%s/%s", stage_dir, arch_entry_name);
+        if (access(arch_path, R_OK) >= 0) {
+          full_archive_append_file(far, arch_entry_name, 0, arch_path);
+        }
+      }
+    }
+  }
+  retval = 0;
+
+cleanup:
+  for (cur_test = 1; cur_test < next_test; ++cur_test) {
+    snprintf(stage_dir, sizeof(stage_dir), "%s/partest_%06d", global->run_work_dir, cur_test);
+    remove_directory_recursively(stage_dir, 0);
+  }
+  for (i = 0; i < worker_count; ++i) {
+    if (workers[i].check_dir[0]) {
+      remove_directory_recursively(workers[i].check_dir, 0);
+    }
+  }
+  xfree(poll_map);
+  xfree(pfds);
+  xfree(workers);
+  return retval;
+}
+
+/* the number of tests for the parallel mode, 0 if the tests must be
+   run sequentially */
+static int
+get_parallel_test_count(
+        const struct ejudge_cfg *config,
+        serve_state_t state,
+        const struct section_tester_data *tst,
+        const struct super_run_in_packet *srp,
+        struct AgentClient *agent,
+        int accept_testing,
+        const unsigned char *interactor_cmd,
+        int interactive_valuer,
+        int user_input_mode)
+{
+  const struct super_run_in_global_packet *srgp = srp->global;
+  const struct super_run_in_problem_packet *srpp = srp->problem;
+  int test_count;
+
+  if (srpp->parallel_tests <= 1) return 0;
+  // testing stops on the first failed test
+  if (srgp->scoring_system_val != SCORE_KIROV
+      && srgp->scoring_system_val != SCORE_OLYMPIAD) return 0;
+  if (srpp->stop_on_first_fail > 0) return 0;
+  if (accept_testing || srgp->accepting_mode > 0) return 0;
+  // the next test depends on the results of the previous ones
+  if (interactive_valuer) return 0;
+  if (interactor_cmd || user_input_mode) return 0;
+  if (agent) return 0;
+  if (tst && tst->nwrun_spool_dir && tst->nwrun_spool_dir[0]) return 0;
+  // without containers all the tests run under the same ejexec uid,
+  // so the process checks and kill-all of one test hit the others
+  if (srgp->suid_run > 0 && srgp->enable_container <= 0) return 0;
+
+  test_count = srpp->test_count;
+  if (test_count <= 0) {
+    for (test_count = 0; does_test_exist(config, state, srp, test_count + 1); ++test_count) {
+    }
+  }
+  if (test_count <= 1) return 0;
+  return test_count;
+}
+#endif
+
 void
 run_tests(
         const struct ejudge_cfg *config,
@@ -4726,6 +5558,34 @@ run_tests(
       goto check_failed;
     }
   }
+
+  int parallel_test_count = get_parallel_test_count(config, state, tst, srp, agent,
+                                                    accept_testing, interactor_cmd,
+                                                    valuer_tsk != NULL, user_input_mode);
+  if (parallel_test_count > 0) {
+    int worker_count = srpp->parallel_tests;
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu_count > 0 && worker_count > cpu_count) worker_count = cpu_count;
+    if (worker_count > 1) {
+      if (run_tests_parallel(config, state, srp, tst,
+                             worker_count, parallel_test_count,
+                             &tests, far, messages_path, check_dir,
+                             exe_name, report_path, check_cmd,
+                             start_env,
+                             open_tests_count, open_tests_val,
+                             test_score_count, test_score_val,
+                             expected_free_space,
+                             &has_real_time, &has_max_memory_used,
+                             &has_max_rss,
+                             &report_time_limit_ms, &report_real_time_limit_ms,
+                             &tests_passed,
+                             mirror_dir, remaps, listener) < 0) {
+        goto check_failed;
+      }
+      status = RUN_OK;
+      goto testing_completed;
+    }
+  }
 #endif
 
   while (1) {
@@ -4734,36 +5594,26 @@ run_tests(
         && accept_testing
         && cur_test > srpp->tests_to_accept) break;
 
-    int tl_retry = 0;
-    int tl_retry_count = srgp->time_limit_retry_count;
-    if (tl_retry_count <= 0) tl_retry_count = 1;
-
     if (listener && listener->ops && listener->ops->before_test) {
       listener->ops->before_test(listener, cur_test);
     }
 
-    while (1) {
-      status = run_one_test(config, state, srp, tst,
-                            agent,
-                            cur_test, &tests,
-                            far, exe_name, report_path, check_cmd,
-                            interactor_cmd, start_env,
-                            open_tests_count, open_tests_val,
-                            test_score_count, test_score_val,
-                            expected_free_space,
-                            &has_real_time, &has_max_memory_used,
-                            &has_max_rss,
-                            &report_time_limit_ms, &report_real_time_limit_ms,
-                            mirror_dir, remaps,
-                            user_input_mode,
-                            inp_data,
-                            inp_size);
-      if (status != RUN_TIME_LIMIT_ERR && status != RUN_WALL_TIME_LIMIT_ERR)
-        break;
-      if (++tl_retry >= tl_retry_count) break;
-      info("test failed due to TL, do it again");
-      --tests.size;
-    }
+    status = run_one_test_retry(config, state, srp, tst,
+                                agent,
+                                cur_test, &tests,
+                                far, NULL, check_dir,
+                                exe_name, report_path, check_cmd,
+                                interactor_cmd, start_env,
+                                open_tests_count, open_tests_val,
+                                test_score_count, test_score_val,
+                                expected_free_space,
+                                &has_real_time, &has_max_memory_used,
+                                &has_max_rss,
+                                &report_time_limit_ms, &report_real_time_limit_ms,
+                                mirror_dir, remaps,
+                                user_input_mode,
+                                inp_data,
+                                inp_size);
 
     if (status < 0) {
       status = RUN_OK;
@@ -4885,6 +5735,9 @@ run_tests(
     close(vefds[0]); vefds[0] = -1;
   }
 
+#ifndef __WIN32__
+testing_completed:
+#endif
   /* TESTING COMPLETED */
   get_current_time(&reply_pkt->ts6, &reply_pkt->ts6_us);
 
@@ -5171,6 +6024,9 @@ done:;
     task_Wait(valuer_tsk);
     task_Delete(valuer_tsk);
   }
+#ifndef __WIN32__
+  checker_server_stop();
+#endif
 
   if (far) full_archive_close(far);
   free_testinfo_vector(&tests);
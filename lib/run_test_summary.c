@@ -0,0 +1,167 @@
+/* -*- mode: c -*- */
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "ejudge/run_test_summary.h"
+#include "ejudge/runlog.h"
+#include "ejudge/serve_state.h"
+#include "ejudge/prepare.h"
+#include "ejudge/testing_report_xml.h"
+#include "ejudge/errlog.h"
+
+#include "ejudge/xalloc.h"
+#include "ejudge/logger.h"
+#include "ejudge/osdeps.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#define SUMMARY_FILE_NAME "test_summary.dat"
+
+void
+run_test_summary_make(
+        struct run_test_summary *rts,
+        const struct run_entry *re,
+        const struct testing_report_xml *tr)
+{
+  memset(rts, 0, sizeof(*rts));
+  memcpy(&rts->run_uuid, &re->run_uuid, sizeof(rts->run_uuid));
+  _Static_assert(sizeof(re->j) <= sizeof(rts->judge_uuid), "judge_uuid is too small");
+  memcpy(&rts->judge_uuid, &re->j, sizeof(re->j));
+  rts->is_valid = 1;
+  if (!tr || tr->run_tests <= 0 || !tr->tests) return;
+
+  rts->run_tests = tr->run_tests;
+  for (int i = 0; i < tr->run_tests; ++i) {
+    const struct testing_report_test *t = tr->tests[i];
+    if (!t) continue;
+    if (t->status >= 0 && t->status < 32) {
+      rts->status_mask |= 1U << t->status;
+    } else {
+      rts->has_other_status = 1;
+    }
+    if (t->status == RUN_OK) ++rts->passed_tests;
+    if (t->time > rts->max_time) rts->max_time = t->time;
+    if (t->real_time > rts->max_real_time) rts->max_real_time = t->real_time;
+    if ((int64_t) t->max_memory_used > rts->max_memory_used)
+      rts->max_memory_used = t->max_memory_used;
+  }
+}
+
+static struct run_test_summary_cache *
+open_cache(serve_state_t cs)
+{
+  struct run_test_summary_cache *cache;
+  path_t path;
+  struct stat stb;
+
+  if ((cache = cs->test_summary)) return cache;
+
+  XCALLOC(cache, 1);
+  cs->test_summary = cache;
+  cache->fd = -1;
+  if (!cs->global || !cs->global->var_dir || !*cs->global->var_dir) return cache;
+
+  snprintf(path, sizeof(path), "%s/%s", cs->global->var_dir, SUMMARY_FILE_NAME);
+  if ((cache->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600)) < 0) {
+    err("run_test_summary: cannot open %s: %s", path, os_ErrorMsg());
+    return cache;
+  }
+  if (fstat(cache->fd, &stb) < 0) {
+    err("run_test_summary: fstat failed: %s", os_ErrorMsg());
+    close(cache->fd); cache->fd = -1;
+    return cache;
+  }
+
+  int count = stb.st_size / sizeof(cache->items[0]);
+  if (count <= 0) return cache;
+  cache->reserved = 1024;
+  while (cache->reserved < count) cache->reserved *= 2;
+  XCALLOC(cache->items, cache->reserved);
+  ssize_t r = pread(cache->fd, cache->items, count * sizeof(cache->items[0]), 0);
+  if (r < 0) {
+    err("run_test_summary: read failed: %s", os_ErrorMsg());
+    r = 0;
+  }
+  // a partially written record at the end is ignored
+  cache->size = r / sizeof(cache->items[0]);
+  return cache;
+}
+
+void
+run_test_summary_store(
+        serve_state_t cs,
+        int run_id,
+        const struct run_test_summary *rts)
+{
+  struct run_test_summary_cache *cache = open_cache(cs);
+
+  if (run_id < 0) return;
+  if (run_id >= cache->reserved) {
+    int new_reserved = cache->reserved;
+    if (!new_reserved) new_reserved = 1024;
+    while (new_reserved <= run_id) new_reserved *= 2;
+    XREALLOC(cache->items, new_reserved);
+    memset(&cache->items[cache->reserved], 0, (new_reserved - cache->reserved) * sizeof(cache->items[0]));
+    cache->reserved = new_reserved;
+  }
+  cache->items[run_id] = *rts;
+  if (run_id >= cache->size) cache->size = run_id + 1;
+
+  if (cache->fd >= 0) {
+    if (pwrite(cache->fd, rts, sizeof(*rts), (off_t) run_id * sizeof(*rts)) != sizeof(*rts)) {
+      err("run_test_summary: write failed: %s", os_ErrorMsg());
+    }
+  }
+}
+
+const struct run_test_summary *
+run_test_summary_get(
+        serve_state_t cs,
+        const struct run_entry *re)
+{
+  struct run_test_summary_cache *cache = open_cache(cs);
+  int run_id = re->run_id;
+
+  if (run_id < 0 || run_id >= cache->size) return NULL;
+  const struct run_test_summary *rts = &cache->items[run_id];
+  // the run could be renumbered or rejudged since the summary was made
+  if (!rts->is_valid) return NULL;
+  if (memcmp(&rts->run_uuid, &re->run_uuid, sizeof(rts->run_uuid)) != 0) return NULL;
+  if (memcmp(&rts->judge_uuid, &re->j, sizeof(re->j)) != 0) return NULL;
+  return rts;
+}
+
+int
+run_test_summary_has_status(
+        const struct run_test_summary *rts,
+        int status)
+{
+  if (!rts) return -1;
+  if (status >= 0 && status < 32) return !!(rts->status_mask & (1U << status));
+  if (!rts->has_other_status) return 0;
+  return -1;
+}
+
+void
+run_test_summary_free(struct run_test_summary_cache *cache)
+{
+  if (!cache) return;
+  if (cache->fd >= 0) close(cache->fd);
+  xfree(cache->items);
+  xfree(cache);
+}
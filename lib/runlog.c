@@ -1,6 +1,6 @@
 /* -*- c -*- */
 
-/* Copyright (C) 2000-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2000-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -95,6 +95,17 @@ struct run_entry_v1
 static int update_user_flags(runlog_state_t state);
 static void build_indices(runlog_state_t state, int flags);
 static void extend_run_extras(runlog_state_t state);
+static void user_prob_hash_clear(runlog_state_t state);
+static void run_note_change(runlog_state_t state, int run_id);
+static void run_note_reset(runlog_state_t state);
+static void run_free_first_ok(runlog_state_t state);
+static int run_sync_first_ok(runlog_state_t state);
+static void run_free_columns(runlog_state_t state);
+static void user_prob_index_append(runlog_state_t state, int run_id);
+static void user_prob_index_rebuild(runlog_state_t state, int user_id);
+static void run_rebuild_all_user_run_indices(runlog_state_t state);
+static struct user_prob_hash_entry *
+user_prob_hash_find(runlog_state_t state, int user_id, int prob_id);
 static void run_drop_uuid_hash(runlog_state_t state);
 static int
 find_free_uuid_hash_index(
@@ -116,6 +127,8 @@ run_init(teamdb_state_t ts)
   p->user_count = -1;
 
   p->uuid_hash_state = -1;
+  p->columns.change_serial = -1;
+  p->first_ok.change_serial = -1;
 
   return p;
 }
@@ -127,6 +140,10 @@ run_destroy(runlog_state_t state)
 
   xfree(state->user_flags.flags);
   xfree(state->run_extras);
+  xfree(state->user_prob_hash);
+  xfree(state->change_ring);
+  run_free_columns(state);
+  run_free_first_ok(state);
 
   run_drop_uuid_hash(state);
 
@@ -467,13 +484,12 @@ run_add_record(
       state->run_extras[urh->run_id_last - state->run_extra_f].next_user_id = i;
     }
     urh->run_id_last = i;
+    user_prob_index_append(state, i);
+    run_note_change(state, i);
   } else {
     // inserting somewhere in the middle
-    run_rebuild_user_run_index(state, team);
-    for (int j = i + 1; j < state->run_u; ++j) {
-      int uu = state->runs[j - state->run_f].user_id;
-      run_rebuild_user_run_index(state, uu);
-    }
+    run_note_reset(state);
+    run_rebuild_all_user_run_indices(state);
     // increase run_id for runs inserted after the given
     if (state->uuid_hash_state > 0) {
       for (int i = 0; i < state->uuid_hash_size; ++i) {
@@ -517,6 +533,7 @@ run_undo_add_record(runlog_state_t state, int run_id)
     state->uuid_hash_last_added_index = -1;
   }
   int result = state->iface->undo_add_entry(state->cnts, run_id);
+  run_note_reset(state);
   if (urh) {
     run_rebuild_user_run_index(state, user_id);
   }
@@ -557,9 +574,11 @@ run_change_status(
   if (state->runs[off_run_id].is_readonly)
     ERR_R("this entry is read-only");
 
-  return state->iface->change_status(state->cnts, runid, newstatus, newtest,
-                                     newpassedmode, newscore, judge_id,
-                                     judge_uuid);
+  int result = state->iface->change_status(state->cnts, runid, newstatus, newtest,
+                                           newpassedmode, newscore, judge_id,
+                                           judge_uuid);
+  if (result >= 0) run_note_change(state, runid);
+  return result;
 }
 
 int
@@ -597,17 +616,19 @@ run_change_status_3(
   if (state->runs[off_run_id].is_readonly)
     ERR_R("this entry is read-only");
 
-  return state->iface->change_status_3(state->cnts, /* cntx */
-                                       runid,       /* run_id */
-                                       newstatus,   /* new_status */
-                                       newtest,     /* new_test */
-                                       newpassedmode, /* new_passed_mode */
-                                       newscore,      /* new_score */
-                                       is_marked,     /* is_marked */
-                                       has_user_score, /* has_user_score */
-                                       user_status,    /* user_status */
-                                       user_tests_passed, /* user_tests_passed */
-                                       user_score);       /* user_score */
+  int result = state->iface->change_status_3(state->cnts, /* cntx */
+                                             runid,       /* run_id */
+                                             newstatus,   /* new_status */
+                                             newtest,     /* new_test */
+                                             newpassedmode, /* new_passed_mode */
+                                             newscore,      /* new_score */
+                                             is_marked,     /* is_marked */
+                                             has_user_score, /* has_user_score */
+                                             user_status,    /* user_status */
+                                             user_tests_passed, /* user_tests_passed */
+                                             user_score);       /* user_score */
+  if (result >= 0) run_note_change(state, runid);
+  return result;
 }
 
 int
@@ -633,7 +654,9 @@ run_change_status_4(
   if (state->runs[off_run_id].is_readonly)
     ERR_R("this entry is read-only");
 
-  return state->iface->change_status_4(state->cnts, runid, newstatus);
+  int result = state->iface->change_status_4(state->cnts, runid, newstatus);
+  if (result >= 0) run_note_change(state, runid);
+  return result;
 }
 
 int
@@ -851,16 +874,17 @@ run_get_attempts(
     run_rebuild_user_run_index(state, sample_re->user_id);
   }
 
-  // FIXME: use user_id+prob_id index
+  const struct user_prob_hash_entry *upe = user_prob_hash_find(state, sample_re->user_id, sample_re->prob_id);
+  ASSERT(upe);
 
-  for (i = urh->run_id_first; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].next_user_id) {
+  for (i = upe->run_id_first; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].next_user_prob_id) {
     ASSERT(i < state->run_u);
     const struct run_entry *re = &state->runs[i - state->run_f];
     ASSERT(re->user_id == sample_re->user_id);
+    ASSERT(re->prob_id == sample_re->prob_id);
     if (i >= runid) break;
 
     if (re->status == RUN_VIRTUAL_START || re->status == RUN_VIRTUAL_STOP) continue;
-    if (re->prob_id != sample_re->prob_id) continue;
     if ((re->status == RUN_COMPILE_ERR) && skip_ce_flag) continue;
     if (re->status == RUN_COMPILE_ERR && (ce_penalty > 0 || ce_penalty < -1)) {
       ++cen;
@@ -902,16 +926,25 @@ run_count_all_attempts(runlog_state_t state, int user_id, int prob_id)
     run_rebuild_user_run_index(state, user_id);
   }
 
-  // FIXME: use user_id+prob_id index
+  if (prob_id > 0) {
+    const struct user_prob_hash_entry *upe = user_prob_hash_find(state, user_id, prob_id);
+    if (!upe) return 0;
+    for (i = upe->run_id_first; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].next_user_prob_id) {
+      ASSERT(i < state->run_u);
+      const struct run_entry *re = &state->runs[i - state->run_f];
+      ASSERT(re->user_id == user_id && re->prob_id == prob_id);
+      if (run_is_normal_or_transient_status(re->status)) ++count;
+    }
+    ASSERT(i == -1);
+    return count;
+  }
 
   for (i = urh->run_id_first; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].next_user_id) {
     ASSERT(i < state->run_u);
     const struct run_entry *re = &state->runs[i - state->run_f];
     ASSERT(re->user_id == user_id);
     if (!run_is_normal_or_transient_status(re->status)) continue;
-    if (prob_id <= 0 || re->prob_id == prob_id) {
-      ++count;
-    }
+    ++count;
   }
   ASSERT(i == -1);
 
@@ -979,8 +1012,7 @@ run_count_tokens(runlog_state_t state, int user_id, int prob_id)
 int
 run_get_prev_successes(runlog_state_t state, int run_id)
 {
-  int user_id, successes = 0, i, cur_uid;
-  unsigned char *has_success = 0;
+  int user_id;
 
   if (run_id < state->run_f || run_id >= state->run_u) ERR_R("bad runid: %d", run_id);
   if (state->runs[run_id - state->run_f].status !=RUN_OK) ERR_R("runid %d is not OK", run_id);
@@ -998,27 +1030,31 @@ run_get_prev_successes(runlog_state_t state, int run_id)
       || (state->user_flags.flags[user_id] & TEAM_INVISIBLE))
     return RUN_TOO_MANY;
 
-  XALLOCAZ(has_success, state->user_flags.nuser);
-  for (i = state->run_f; i < run_id; i++) {
-    int i_off = i - state->run_f;
-    if (state->runs[i_off].status != RUN_OK) continue;
-    if (state->runs[i_off].is_hidden) continue;
-    if (state->runs[i_off].prob_id != state->runs[run_id - state->run_f].prob_id) continue;
-    cur_uid = state->runs[i_off].user_id;
-    if (cur_uid <= 0 || cur_uid >= state->user_flags.nuser
-        || state->user_flags.flags[cur_uid] < 0
-        || (state->user_flags.flags[cur_uid] & TEAM_BANNED)
-        || (state->user_flags.flags[cur_uid] & TEAM_INVISIBLE))
-      continue;
-    if (cur_uid == user_id) {
-      // the user already had OK before
-      return successes;
+  int prob_id = state->runs[run_id - state->run_f].prob_id;
+  if (prob_id < 0) return 0;
+  if (run_sync_first_ok(state) < 0) return -1;
+
+  const struct user_prob_hash_entry *upe = user_prob_hash_find(state, user_id, prob_id);
+  if (!upe || upe->run_id_first_ok < 0 || upe->run_id_first_ok > run_id) {
+    // the run was changed bypassing the change journal
+    state->first_ok.change_serial = -1;
+    if (run_sync_first_ok(state) < 0) return -1;
+    upe = user_prob_hash_find(state, user_id, prob_id);
+    if (!upe || upe->run_id_first_ok < 0) ERR_R("first OK index is inconsistent for run %d", run_id);
+  }
+
+  // the number of users, who solved the problem before the first OK of this user
+  const struct run_first_ok_prob *fp = &state->first_ok.probs[prob_id];
+  int low = 0, high = fp->size;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (fp->run_ids[mid] < upe->run_id_first_ok) {
+      low = mid + 1;
+    } else {
+      high = mid;
     }
-    if (has_success[cur_uid]) continue;
-    has_success[cur_uid] = 1;
-    successes++;
   }
-  return successes;
+  return low;
 }
 
 int
@@ -1068,6 +1104,8 @@ run_reset(
   state->run_extra_u = 0;
   state->run_extra_a = 0;
   state->run_extra_f = 0;
+  user_prob_hash_clear(state);
+  run_note_reset(state);
 
   xfree(state->urh.umap);
   xfree(state->urh.infos);
@@ -1099,12 +1137,11 @@ run_check_duplicate(runlog_state_t state, int run_id)
     run_rebuild_user_run_index(state, p->user_id);
   }
 
-  // FIXME: use user_id+prob_id index
-
-  for (i = state->run_extras[run_id - state->run_extra_f].prev_user_id; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].prev_user_id) {
+  for (i = state->run_extras[run_id - state->run_extra_f].prev_user_prob_id; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].prev_user_prob_id) {
     ASSERT(i < state->run_u);
     q = &state->runs[i - state->run_f];
     ASSERT(q->user_id == p->user_id);
+    ASSERT(q->prob_id == p->prob_id);
     if (q->status == RUN_VIRTUAL_START || q->status == RUN_VIRTUAL_STOP)
       continue;
     if (p->size == q->size
@@ -1125,6 +1162,7 @@ run_check_duplicate(runlog_state_t state, int run_id)
   if (i < 0) return 0;
   if (state->iface->set_status(state->cnts, run_id, RUN_IGNORED) < 0)
     return -1;
+  run_note_change(state, run_id);
   return i + 1;
 }
 
@@ -1149,15 +1187,17 @@ run_find_duplicate(
     run_rebuild_user_run_index(state, user_id);
   }
 
-  // FIXME: use user_id+prob_id index
+  const struct user_prob_hash_entry *upe = user_prob_hash_find(state, user_id, prob_id);
+  if (!upe) return -1;
 
-  for (i = urh->run_id_last; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].prev_user_id) {
+  for (i = upe->run_id_last; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].prev_user_prob_id) {
     ASSERT(i < state->run_u);
     q = &state->runs[i - state->run_f];
     ASSERT(q->user_id == user_id);
+    ASSERT(q->prob_id == prob_id);
     if (q->status == RUN_VIRTUAL_START || q->status == RUN_VIRTUAL_STOP)
       continue;
-    if (q->prob_id == prob_id && q->variant == variant) {
+    if (q->variant == variant) {
       if (q->lang_id == lang_id
           && q->size == size
           && q->h.sha1[0] == sha1[0]
@@ -1277,6 +1317,7 @@ run_set_entry(
   int f = 0;
   time_t stop_time;
   int old_user_id = 0;
+  int old_prob_id = 0;
 
   ASSERT(in);
   if (run_id < state->run_f || run_id >= state->run_u) ERR_R("bad runid: %d", run_id);
@@ -1308,6 +1349,7 @@ run_set_entry(
   /* blindly update all fields */
   memcpy(&te, out, sizeof(te));
   old_user_id = out->user_id;
+  old_prob_id = out->prob_id;
   if ((mask & RE_STATUS) && te.status != in->status) {
     te.status = in->status;
     f = 1;
@@ -1540,6 +1582,12 @@ run_set_entry(
 
   if (state->iface->set_entry(state->cnts, run_id, &te, mask) < 0) return -1;
   int new_user_id = state->runs[run_id - state->run_f].user_id;
+  if (new_user_id != old_user_id || state->runs[run_id - state->run_f].prob_id != old_prob_id) {
+    // the run moves to another (user_id, prob_id) pair
+    run_note_reset(state);
+  } else {
+    run_note_change(state, run_id);
+  }
   if (new_user_id != old_user_id) {
     struct user_run_header_info *urh = NULL;
 
@@ -1549,6 +1597,10 @@ run_set_entry(
     if ((urh = run_try_user_run_header(state, new_user_id))) {
       run_rebuild_user_run_index(state, new_user_id);
     }
+  } else if (state->runs[run_id - state->run_f].prob_id != old_prob_id) {
+    if (run_try_user_run_header(state, new_user_id)) {
+      user_prob_index_rebuild(state, new_user_id);
+    }
   }
   return 0;
 }
@@ -1679,6 +1731,11 @@ run_virtual_start(
   state->user_count = -1;
 
   if ((i = state->iface->add_entry(state->cnts, i, &re, RE_USER_ID | RE_IP | RE_SSL_FLAG | RE_STATUS)) < 0) return -1;
+  if (i == state->run_u - 1) {
+    run_note_change(state, i);
+  } else {
+    run_note_reset(state);
+  }
 
   urh = run_get_user_run_header(state, user_id, NULL);
   if (urh) {
@@ -1755,18 +1812,21 @@ run_virtual_stop(
   state->user_count = -1;
 
   if ((i = state->iface->add_entry(state->cnts, i, &re, RE_USER_ID | RE_IP | RE_SSL_FLAG | RE_STATUS)) < 0) return -1;
+  if (i == state->run_u - 1) {
+    run_note_change(state, i);
+  } else {
+    run_note_reset(state);
+  }
 
   // updating user_id index
   extend_run_extras(state);
 
-  run_rebuild_user_run_index(state, user_id);
-  if (i < state->run_u - 1) {
+  if (i == state->run_u - 1) {
+    run_rebuild_user_run_index(state, user_id);
+  } else {
     // inserting somewhere in the middle
-    // drop the following indices
-    for (int j = i + 1; j < state->run_u; ++j) {
-      int uu = state->runs[j - state->run_f].user_id;
-      run_rebuild_user_run_index(state, uu);
-    }
+    // the run_ids of the following runs change
+    run_rebuild_all_user_run_indices(state);
     // increase run_id for runs inserted after the given
     if (state->uuid_hash_state > 0) {
       for (int i = 0; i < state->uuid_hash_size; ++i) {
@@ -1831,6 +1891,8 @@ run_clear_entry(runlog_state_t state, int run_id)
 
   int user_id = state->runs[run_id - state->run_f].user_id;
   int result = state->iface->clear_entry(state->cnts, run_id);
+  // the cleared entry loses its user_id and prob_id
+  run_note_reset(state);
   if (result >= 0) {
     run_rebuild_user_run_index(state, user_id);
   }
@@ -1852,6 +1914,7 @@ run_clear_user_entries(
   }
 
   run_delete_user_run_header(state, user_id);
+  run_note_reset(state);
   return 0;
 }
 
@@ -1868,6 +1931,7 @@ run_forced_clear_entry(runlog_state_t state, int run_id)
   }
   state->max_user_id = -1;
   state->user_count = -1;
+  run_note_reset(state);
 
   return state->iface->clear_entry(state->cnts, run_id);
 }
@@ -1876,7 +1940,9 @@ int
 run_set_hidden(runlog_state_t state, int run_id)
 {
   if (run_id < 0 || run_id >= state->run_u) ERR_R("bad runid: %d", run_id);
-  return state->iface->set_hidden(state->cnts, run_id, 1);
+  int result = state->iface->set_hidden(state->cnts, run_id, 1);
+  if (result >= 0) run_note_change(state, run_id);
+  return result;
 }
 
 int
@@ -1907,6 +1973,7 @@ run_has_transient_user_runs(runlog_state_t state, int user_id)
 int
 run_squeeze_log(runlog_state_t state)
 {
+  run_note_reset(state);
   return state->iface->squeeze(state->cnts);
 }
 
@@ -2350,6 +2417,9 @@ build_indices(runlog_state_t state, int flags)
   int i;
   int max_team_id = -1;
 
+  user_prob_hash_clear(state);
+  run_note_reset(state);
+
   struct user_run_header_state *urh = &state->urh;
   for (int i = urh->low_user_id; i < urh->high_user_id; ++i) {
     int index = urh->umap[i - urh->low_user_id];
@@ -2397,6 +2467,7 @@ build_indices(runlog_state_t state, int flags)
       state->run_extras[urhi->run_id_last - state->run_extra_f].next_user_id = i;
     }
     urhi->run_id_last = i;
+    user_prob_index_append(state, i);
 
     if (state->runs[i_off].is_hidden) continue;
     switch (state->runs[i_off].status) {
@@ -2538,6 +2609,8 @@ teamdb_update_callback(void *user_ptr)
   xfree(state->user_flags.flags);
   memset(&state->user_flags, 0, sizeof(state->user_flags));
   state->user_flags.nuser = -1;
+  // banned and invisible users are not in the first OK index
+  state->first_ok.change_serial = -1;
 }
 
 static int
@@ -2593,7 +2666,20 @@ run_put_entry(
         runlog_state_t state,
         const struct run_entry *re)
 {
-  return state->iface->put_entry(state->cnts, re);
+  int old_user_id = 0, old_prob_id = 0;
+  if (re->run_id >= state->run_f && re->run_id < state->run_u) {
+    old_user_id = state->runs[re->run_id - state->run_f].user_id;
+    old_prob_id = state->runs[re->run_id - state->run_f].prob_id;
+  }
+  int result = state->iface->put_entry(state->cnts, re);
+  run_note_reset(state);
+  if (result >= 0 && old_user_id > 0 && (old_user_id != re->user_id || old_prob_id != re->prob_id)) {
+    run_clear_index(state, re->run_id);
+    if (run_try_user_run_header(state, old_user_id)) {
+      run_rebuild_user_run_index(state, old_user_id);
+    }
+  }
+  return result;
 }
 
 int
@@ -2628,10 +2714,11 @@ run_get_max_user_id(runlog_state_t state)
 {
   if (state->max_user_id < 0) {
     int max_user_id = 0;
-    for (int i = state->run_f; i < state->run_u; ++i) {
-      const struct run_entry *p = &state->runs[i - state->run_f];
-      if (p->status != RUN_EMPTY && p->user_id > 0 && p->user_id > max_user_id) {
-        max_user_id = p->user_id;
+    struct run_columns rc;
+    run_get_columns(state, &rc);
+    for (int i = rc.first; i < rc.total; ++i) {
+      if (rc.status[i] != RUN_EMPTY && rc.user_id[i] > max_user_id) {
+        max_user_id = rc.user_id[i];
       }
     }
     state->max_user_id = max_user_id;
@@ -2647,10 +2734,12 @@ run_get_total_users(runlog_state_t state)
     int user_count = 0;
     if (user_id_bound > 1) {
       unsigned char *map = (unsigned char*) xcalloc(user_id_bound, sizeof(map[0]));
-      for (int run_id = state->run_f; run_id < state->run_u; ++run_id) {
-        const struct run_entry *p = &state->runs[run_id - state->run_f];
-        if (p->status != RUN_EMPTY && p->user_id > 0 && p->user_id < user_id_bound) {
-          map[p->user_id] = 1;
+      struct run_columns rc;
+      run_get_columns(state, &rc);
+      for (int run_id = rc.first; run_id < rc.total; ++run_id) {
+        int cur_uid = rc.user_id[run_id];
+        if (rc.status[run_id] != RUN_EMPTY && cur_uid > 0 && cur_uid < user_id_bound) {
+          map[cur_uid] = 1;
         }
       }
       for (int user_id = 1; user_id < user_id_bound; ++user_id) {
@@ -2778,6 +2867,166 @@ run_get_user_prev_run_id(runlog_state_t state, int run_id)
   return state->run_extras[run_id - state->run_extra_f].prev_user_id;
 }
 
+int
+run_get_user_prob_first_run_id(runlog_state_t state, int user_id, int prob_id)
+{
+  struct user_run_header_info *urh = run_get_user_run_header(state, user_id, NULL);
+  if (!urh) return -1;
+  if (!urh->run_id_valid) {
+    run_rebuild_user_run_index(state, user_id);
+  }
+  const struct user_prob_hash_entry *upe = user_prob_hash_find(state, user_id, prob_id);
+  if (!upe) return -1;
+  return upe->run_id_first;
+}
+
+int
+run_get_user_prob_next_run_id(runlog_state_t state, int run_id)
+{
+  if (run_id < state->run_extra_f || run_id >= state->run_extra_u) return -1;
+  return state->run_extras[run_id - state->run_extra_f].next_user_prob_id;
+}
+
+int
+run_get_user_prob_count(runlog_state_t state)
+{
+  return state->user_prob_hash_used;
+}
+
+int64_t
+run_get_change_serial(runlog_state_t state)
+{
+  return state->change_serial;
+}
+
+/*
+ * returns the run_id changed at the given serial number,
+ * -1, if the change is no longer available
+ */
+int
+run_get_changed_run_id(runlog_state_t state, int64_t serial)
+{
+  if (serial < state->change_reset_serial || serial >= state->change_serial) return -1;
+  if (serial < state->change_serial - state->change_ring_size) return -1;
+  return state->change_ring[serial & (state->change_ring_size - 1)];
+}
+
+static void
+run_free_columns(runlog_state_t state)
+{
+  struct run_columns_state *rc = &state->columns;
+  xfree(rc->status);
+  xfree(rc->is_hidden);
+  xfree(rc->user_id);
+  xfree(rc->prob_id);
+  xfree(rc->lang_id);
+  xfree(rc->score);
+  xfree(rc->time);
+  memset(rc, 0, sizeof(*rc));
+  rc->change_serial = -1;
+}
+
+static void
+run_copy_to_columns(runlog_state_t state, int run_id)
+{
+  struct run_columns_state *rc = &state->columns;
+  const struct run_entry *re = &state->runs[run_id - state->run_f];
+  int i = run_id - rc->first;
+
+  rc->status[i] = re->status;
+  rc->is_hidden[i] = re->is_hidden;
+  rc->user_id[i] = re->user_id;
+  rc->prob_id[i] = re->prob_id;
+  rc->lang_id[i] = re->lang_id;
+  rc->score[i] = re->score;
+  rc->time[i] = re->time;
+}
+
+/* bring the columns up to date using the change journal */
+static void
+run_sync_columns(runlog_state_t state)
+{
+  struct run_columns_state *rc = &state->columns;
+  int count = state->run_u - state->run_f;
+
+  if (rc->change_serial >= 0 && rc->first == state->run_f && rc->size <= count) {
+    int64_t serial;
+    for (serial = rc->change_serial; serial < state->change_serial; ++serial) {
+      int run_id = run_get_changed_run_id(state, serial);
+      if (run_id < 0) break;
+      if (run_id >= rc->first && run_id < rc->first + rc->size) {
+        run_copy_to_columns(state, run_id);
+      }
+    }
+    if (serial < state->change_serial) {
+      rc->size = 0;
+    }
+  } else {
+    rc->size = 0;
+  }
+
+  if (count > rc->reserved) {
+    int new_reserved = rc->reserved;
+    if (!new_reserved) new_reserved = 1024;
+    while (new_reserved < count) new_reserved *= 2;
+    XREALLOC(rc->status, new_reserved);
+    XREALLOC(rc->is_hidden, new_reserved);
+    XREALLOC(rc->user_id, new_reserved);
+    XREALLOC(rc->prob_id, new_reserved);
+    XREALLOC(rc->lang_id, new_reserved);
+    XREALLOC(rc->score, new_reserved);
+    XREALLOC(rc->time, new_reserved);
+    rc->reserved = new_reserved;
+  }
+
+  rc->first = state->run_f;
+  for (int run_id = rc->first + rc->size; run_id < state->run_u; ++run_id) {
+    run_copy_to_columns(state, run_id);
+  }
+  rc->size = count;
+  rc->change_serial = state->change_serial;
+}
+
+void
+run_get_columns(runlog_state_t state, struct run_columns *out)
+{
+  struct run_columns_state *rc = &state->columns;
+
+  if (rc->change_serial != state->change_serial
+      || rc->first != state->run_f
+      || rc->size != state->run_u - state->run_f) {
+    run_sync_columns(state);
+  }
+
+  // adjust pointers, so arr[run_id] is the value for run_id, see run_get_entries_ptr
+  out->first = state->run_f;
+  out->total = state->run_u;
+  out->status = rc->status - rc->first;
+  out->is_hidden = rc->is_hidden - rc->first;
+  out->user_id = rc->user_id - rc->first;
+  out->prob_id = rc->prob_id - rc->first;
+  out->lang_id = rc->lang_id - rc->first;
+  out->score = rc->score - rc->first;
+  out->time = rc->time - rc->first;
+}
+
+static void
+run_note_change(runlog_state_t state, int run_id)
+{
+  if (!state->change_ring) {
+    state->change_ring_size = 4096;
+    XCALLOC(state->change_ring, state->change_ring_size);
+  }
+  state->change_ring[state->change_serial & (state->change_ring_size - 1)] = run_id;
+  ++state->change_serial;
+}
+
+static void
+run_note_reset(runlog_state_t state)
+{
+  state->change_reset_serial = ++state->change_serial;
+}
+
 int
 run_get_uuid_hash_state(runlog_state_t state)
 {
@@ -3077,6 +3326,158 @@ run_rebuild_user_run_index(runlog_state_t state, int user_id)
     }
     urhi->run_id_last = run_id;
   }
+
+  user_prob_index_rebuild(state, user_id);
+}
+
+/*
+ * rebuild the user and (user_id, prob_id) run lists of all the users
+ * in one pass over the runs, when the run_ids of many runs change
+ */
+static void
+run_rebuild_all_user_run_indices(runlog_state_t state)
+{
+  struct user_run_header_state *urh = &state->urh;
+
+  extend_run_extras(state);
+  for (int i = urh->low_user_id; i < urh->high_user_id; ++i) {
+    int index = urh->umap[i - urh->low_user_id];
+    if (index > 0) {
+      struct user_run_header_info *urhi = &urh->infos[index];
+      urhi->run_id_valid = 1;
+      urhi->run_id_first = -1;
+      urhi->run_id_last = -1;
+    }
+  }
+  for (int i = 0; i < state->user_prob_hash_size; ++i) {
+    state->user_prob_hash[i].run_id_first = -1;
+    state->user_prob_hash[i].run_id_last = -1;
+  }
+
+  for (int run_id = state->run_f; run_id < state->run_u; ++run_id) {
+    const struct run_entry *re = &state->runs[run_id - state->run_f];
+    if (re->status == RUN_EMPTY || re->user_id <= 0) continue;
+    struct user_run_header_info *urhi = run_get_user_run_header(state, re->user_id, NULL);
+    struct run_entry_extra *rex = &state->run_extras[run_id - state->run_extra_f];
+
+    rex->prev_user_id = urhi->run_id_last;
+    rex->next_user_id = -1;
+    if (urhi->run_id_last < 0) {
+      urhi->run_id_first = run_id;
+    } else {
+      state->run_extras[urhi->run_id_last - state->run_extra_f].next_user_id = run_id;
+    }
+    urhi->run_id_last = run_id;
+    user_prob_index_append(state, run_id);
+  }
+}
+
+static void
+user_prob_hash_clear(runlog_state_t state)
+{
+  xfree(state->user_prob_hash);
+  state->user_prob_hash = NULL;
+  state->user_prob_hash_size = 0;
+  state->user_prob_hash_used = 0;
+}
+
+static inline unsigned
+user_prob_hash_func(int user_id, int prob_id)
+{
+  return (unsigned) user_id * 2654435761U + (unsigned) prob_id * 40503U;
+}
+
+static struct user_prob_hash_entry *
+user_prob_hash_find(runlog_state_t state, int user_id, int prob_id)
+{
+  if (!state->user_prob_hash_size) return NULL;
+  unsigned index = user_prob_hash_func(user_id, prob_id) % state->user_prob_hash_size;
+  while (state->user_prob_hash[index].user_id > 0) {
+    struct user_prob_hash_entry *upe = &state->user_prob_hash[index];
+    if (upe->user_id == user_id && upe->prob_id == prob_id) return upe;
+    index = (index + 1) % state->user_prob_hash_size;
+  }
+  return NULL;
+}
+
+static struct user_prob_hash_entry *
+user_prob_hash_get(runlog_state_t state, int user_id, int prob_id)
+{
+  struct user_prob_hash_entry *upe = user_prob_hash_find(state, user_id, prob_id);
+  if (upe) return upe;
+
+  if (2 * (state->user_prob_hash_used + 1) >= state->user_prob_hash_size) {
+    int primes_ind = 0;
+    while (primes[primes_ind] > 0 && 2 * (state->user_prob_hash_used + 1) >= primes[primes_ind]) ++primes_ind;
+    // the table size is bounded by the number of runs
+    ASSERT(primes[primes_ind] > 0);
+    int new_size = primes[primes_ind];
+    struct user_prob_hash_entry *new_hash = xcalloc(new_size, sizeof(new_hash[0]));
+    for (int i = 0; i < state->user_prob_hash_size; ++i) {
+      const struct user_prob_hash_entry *cur = &state->user_prob_hash[i];
+      if (cur->user_id <= 0) continue;
+      unsigned index = user_prob_hash_func(cur->user_id, cur->prob_id) % new_size;
+      while (new_hash[index].user_id > 0) {
+        index = (index + 1) % new_size;
+      }
+      new_hash[index] = *cur;
+    }
+    xfree(state->user_prob_hash);
+    state->user_prob_hash = new_hash;
+    state->user_prob_hash_size = new_size;
+  }
+
+  unsigned index = user_prob_hash_func(user_id, prob_id) % state->user_prob_hash_size;
+  while (state->user_prob_hash[index].user_id > 0) {
+    index = (index + 1) % state->user_prob_hash_size;
+  }
+  upe = &state->user_prob_hash[index];
+  upe->user_id = user_id;
+  upe->prob_id = prob_id;
+  upe->run_id_first = -1;
+  upe->run_id_last = -1;
+  upe->run_id_first_ok = -1;
+  ++state->user_prob_hash_used;
+  return upe;
+}
+
+/* append run_id to the end of its (user_id, prob_id) list */
+static void
+user_prob_index_append(runlog_state_t state, int run_id)
+{
+  const struct run_entry *re = &state->runs[run_id - state->run_f];
+  struct user_prob_hash_entry *upe = user_prob_hash_get(state, re->user_id, re->prob_id);
+  struct run_entry_extra *rex = &state->run_extras[run_id - state->run_extra_f];
+
+  rex->prev_user_prob_id = upe->run_id_last;
+  rex->next_user_prob_id = -1;
+  if (upe->run_id_last < 0) {
+    upe->run_id_first = run_id;
+  } else {
+    state->run_extras[upe->run_id_last - state->run_extra_f].next_user_prob_id = run_id;
+  }
+  upe->run_id_last = run_id;
+}
+
+/* rebuild all (user_id, prob_id) lists of the user from the user list */
+static void
+user_prob_index_rebuild(runlog_state_t state, int user_id)
+{
+  struct user_run_header_info *urhi = run_get_user_run_header(state, user_id, NULL);
+  ASSERT(urhi);
+  ASSERT(urhi->run_id_valid);
+
+  // the entries for problems, which no longer have runs, are left empty
+  for (int i = 0; i < state->user_prob_hash_size; ++i) {
+    struct user_prob_hash_entry *upe = &state->user_prob_hash[i];
+    if (upe->user_id == user_id && upe->run_id_first >= 0) {
+      upe->run_id_first = -1;
+      upe->run_id_last = -1;
+    }
+  }
+  for (int run_id = urhi->run_id_first; run_id >= state->run_f; run_id = state->run_extras[run_id - state->run_extra_f].next_user_id) {
+    user_prob_index_append(state, run_id);
+  }
 }
 
 int
@@ -3100,3 +3501,161 @@ run_get_user_run_header_id_range(
   if (p_low_user_id) *p_low_user_id = urh->low_user_id;
   if (p_high_user_id) *p_high_user_id = urh->high_user_id;
 }
+
+static void
+run_free_first_ok(runlog_state_t state)
+{
+  struct run_first_ok_state *fo = &state->first_ok;
+  for (int i = 0; i < fo->prob_size; ++i) {
+    xfree(fo->probs[i].run_ids);
+  }
+  xfree(fo->probs);
+  memset(fo, 0, sizeof(*fo));
+  fo->change_serial = -1;
+}
+
+static struct run_first_ok_prob *
+first_ok_get_prob(runlog_state_t state, int prob_id)
+{
+  struct run_first_ok_state *fo = &state->first_ok;
+  if (prob_id >= fo->prob_size) {
+    int new_size = fo->prob_size;
+    if (!new_size) new_size = 16;
+    while (new_size <= prob_id) new_size *= 2;
+    XREALLOC(fo->probs, new_size);
+    memset(&fo->probs[fo->prob_size], 0, (new_size - fo->prob_size) * sizeof(fo->probs[0]));
+    fo->prob_size = new_size;
+  }
+  return &fo->probs[prob_id];
+}
+
+/* replace old_run_id with new_run_id in the ordered list, -1 means none */
+static void
+first_ok_prob_update(struct run_first_ok_prob *fp, int old_run_id, int new_run_id)
+{
+  int low = 0, high = fp->size;
+
+  if (old_run_id >= 0) {
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (fp->run_ids[mid] < old_run_id) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    ASSERT(low < fp->size && fp->run_ids[low] == old_run_id);
+    memmove(&fp->run_ids[low], &fp->run_ids[low + 1], (fp->size - low - 1) * sizeof(fp->run_ids[0]));
+    --fp->size;
+  }
+  if (new_run_id >= 0) {
+    if (fp->size == fp->reserved) {
+      if (!(fp->reserved *= 2)) fp->reserved = 16;
+      XREALLOC(fp->run_ids, fp->reserved);
+    }
+    low = 0; high = fp->size;
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (fp->run_ids[mid] < new_run_id) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    memmove(&fp->run_ids[low + 1], &fp->run_ids[low], (fp->size - low) * sizeof(fp->run_ids[0]));
+    fp->run_ids[low] = new_run_id;
+    ++fp->size;
+  }
+}
+
+static int
+first_ok_is_user_counted(runlog_state_t state, int user_id)
+{
+  return user_id > 0 && user_id < state->user_flags.nuser
+    && state->user_flags.flags[user_id] >= 0
+    && !(state->user_flags.flags[user_id] & TEAM_BANNED)
+    && !(state->user_flags.flags[user_id] & TEAM_INVISIBLE);
+}
+
+/* recompute the first OK run of the (user_id, prob_id) of the changed run */
+static void
+first_ok_update_run(runlog_state_t state, int run_id)
+{
+  if (run_id < state->run_f || run_id >= state->run_u) return;
+  const struct run_entry *re = &state->runs[run_id - state->run_f];
+  if (re->status == RUN_EMPTY || re->prob_id < 0) return;
+  if (!first_ok_is_user_counted(state, re->user_id)) return;
+
+  int run_id_first = run_get_user_prob_first_run_id(state, re->user_id, re->prob_id);
+  int new_run_id = -1;
+  for (int i = run_id_first; i >= state->run_f; i = state->run_extras[i - state->run_extra_f].next_user_prob_id) {
+    const struct run_entry *cur = &state->runs[i - state->run_f];
+    if (cur->status == RUN_OK && !cur->is_hidden) {
+      new_run_id = i;
+      break;
+    }
+  }
+
+  struct user_prob_hash_entry *upe = user_prob_hash_find(state, re->user_id, re->prob_id);
+  if (!upe || upe->run_id_first_ok == new_run_id) return;
+  first_ok_prob_update(first_ok_get_prob(state, re->prob_id), upe->run_id_first_ok, new_run_id);
+  upe->run_id_first_ok = new_run_id;
+}
+
+static void
+first_ok_rebuild(runlog_state_t state)
+{
+  struct run_first_ok_state *fo = &state->first_ok;
+  struct run_columns rc;
+
+  for (int i = 0; i < fo->prob_size; ++i) {
+    fo->probs[i].size = 0;
+  }
+  for (int i = 0; i < state->user_prob_hash_size; ++i) {
+    state->user_prob_hash[i].run_id_first_ok = -1;
+  }
+
+  run_get_columns(state, &rc);
+  for (int i = rc.first; i < rc.total; ++i) {
+    if (rc.status[i] != RUN_OK || rc.is_hidden[i] || rc.prob_id[i] < 0) continue;
+    if (!first_ok_is_user_counted(state, rc.user_id[i])) continue;
+    struct user_prob_hash_entry *upe = user_prob_hash_get(state, rc.user_id[i], rc.prob_id[i]);
+    if (upe->run_id_first_ok >= 0) continue;
+    upe->run_id_first_ok = i;
+    // the runs are scanned in the ascending order
+    struct run_first_ok_prob *fp = first_ok_get_prob(state, rc.prob_id[i]);
+    if (fp->size == fp->reserved) {
+      if (!(fp->reserved *= 2)) fp->reserved = 16;
+      XREALLOC(fp->run_ids, fp->reserved);
+    }
+    fp->run_ids[fp->size++] = i;
+  }
+}
+
+/* bring the first OK index up to date using the change journal */
+static int
+run_sync_first_ok(runlog_state_t state)
+{
+  struct run_first_ok_state *fo = &state->first_ok;
+  int64_t serial;
+
+  if (update_user_flags(state) < 0) return -1;
+  if (fo->change_serial == state->change_serial) return 0;
+
+  if (fo->change_serial >= 0) {
+    for (serial = fo->change_serial; serial < state->change_serial; ++serial) {
+      if (run_get_changed_run_id(state, serial) < 0) break;
+    }
+    if (serial == state->change_serial) {
+      for (serial = fo->change_serial; serial < state->change_serial; ++serial) {
+        first_ok_update_run(state, run_get_changed_run_id(state, serial));
+      }
+      fo->change_serial = state->change_serial;
+      return 0;
+    }
+  }
+
+  first_ok_rebuild(state);
+  fo->change_serial = state->change_serial;
+  return 0;
+}
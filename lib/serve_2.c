@@ -43,6 +43,7 @@
 #include "ejudge/super_run_packet.h"
 #include "ejudge/prepare_dflt.h"
 #include "ejudge/testing_report_xml.h"
+#include "ejudge/run_test_summary.h"
 #include "ejudge/server_framework.h"
 #include "ejudge/ej_uuid.h"
 #include "ejudge/team_extra.h"
@@ -91,6 +92,9 @@ serve_update_standings_file(
   //int p = 0;
   int charset_id = 0;
 
+  // the cached standings pages are no longer valid
+  ++state->standings_serial;
+
   //run_get_times(state->runlog_state, &start_time, 0, &duration, &stop_time, 0);
 
   /*
@@ -2447,12 +2451,14 @@ serve_run_request(
   srpp->max_file_size = prob->max_file_size;
   srpp->max_open_file_count = prob->max_open_file_count;
   srpp->max_process_count = prob->max_process_count;
+  srpp->parallel_tests = prob->parallel_tests;
   srpp->enable_process_group = prob->enable_process_group;
   srpp->enable_kill_all = prob->enable_kill_all;
   srgp->testlib_mode = prob->enable_testlib_mode;
   srpp->enable_extended_info = prob->enable_extended_info;
   srpp->stop_on_first_fail = prob->stop_on_first_fail;
   srpp->enable_control_socket = prob->enable_control_socket;
+  srpp->enable_checker_server = prob->enable_checker_server;
   if (prob->umask && prob->umask[0]) {
     srpp->umask = xstrdup(prob->umask);
   }
@@ -4208,33 +4214,27 @@ serve_read_run_packet(
     }
   }
 
+  // the parsed report is used both for the merge and for the summary
+  if (re.store_flags == STORE_FLAGS_UUID_BSON) {
+    new_tr = testing_report_parse_bson_data(new_rep_text, new_rep_len);
+  } else {
+    const unsigned char *new_start_ptr = NULL;
+    if (get_content_type(new_rep_text, &new_start_ptr) == CONTENT_TYPE_XML && new_start_ptr) {
+      new_tr = testing_report_parse_xml(new_start_ptr);
+    }
+  }
+
   // try to merge the testing reports
-  if (compiler_output) {
+  if (compiler_output && new_tr && !new_tr->compiler_output) {
+    new_tr->compiler_output = compiler_output; compiler_output = NULL;
+    xfree(new_rep_text); new_rep_text = NULL; new_rep_len = 0;
     if (re.store_flags == STORE_FLAGS_UUID_BSON) {
-      if ((new_tr = testing_report_parse_bson_data(new_rep_text, new_rep_len))) {
-        if (new_tr && !new_tr->compiler_output) {
-          new_tr->compiler_output = compiler_output; compiler_output = NULL;
-          xfree(new_rep_text); new_rep_text = NULL; new_rep_len = 0;
-          testing_report_to_mem_bson(&new_rep_text, &new_rep_len, new_tr);
-        }
-        testing_report_free(new_tr); new_tr = NULL;
-        xfree(compiler_output); compiler_output = NULL;
-      }
+      testing_report_to_mem_bson(&new_rep_text, &new_rep_len, new_tr);
     } else {
-      const unsigned char *new_start_ptr = NULL;
-      int new_content_type = get_content_type(new_rep_text, &new_start_ptr);
-      if (new_content_type == CONTENT_TYPE_XML && new_start_ptr) {
-        new_tr = testing_report_parse_xml(new_start_ptr);
-        if (new_tr && !new_tr->compiler_output) {
-          new_tr->compiler_output = compiler_output; compiler_output = NULL;
-          xfree(new_rep_text); new_rep_text = NULL; new_rep_len = 0;
-          testing_report_to_str(&new_rep_text, &new_rep_len, 1, new_tr);
-        }
-        testing_report_free(new_tr); new_tr = NULL;
-        xfree(compiler_output); compiler_output = NULL;
-      }
+      testing_report_to_str(&new_rep_text, &new_rep_len, 1, new_tr);
     }
   }
+  xfree(compiler_output); compiler_output = NULL;
 
   if (re.store_flags == STORE_FLAGS_UUID_BSON) {
     rep_flags = uuid_archive_prepare_write_path(state, rep_path, sizeof(rep_path),
@@ -4276,6 +4276,14 @@ serve_read_run_packet(
       goto failed;
   }
 
+  // save the summary of the testing report for the filters
+  if (new_tr) {
+    struct run_test_summary rts;
+    run_test_summary_make(&rts, &re, new_tr);
+    run_test_summary_store(state, reply_pkt->run_id, &rts);
+    testing_report_free(new_tr); new_tr = NULL;
+  }
+
   /* add auditing information */
   if (!(f = open_memstream(&audit_text, &audit_text_size))) return 1;
   fprintf(f, "  Profiling information:\n");
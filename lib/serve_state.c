@@ -38,6 +38,7 @@
 #include "ejudge/win32_compat.h"
 #include "ejudge/variant_map.h"
 #include "ejudge/xuser_plugin.h"
+#include "ejudge/run_test_summary.h"
 #include "ejudge/statusdb.h"
 #include "ejudge/variant_plugin.h"
 #include "ejudge/submit_plugin.h"
@@ -248,6 +249,14 @@ serve_state_destroy(
 
   xfree(state->user_results);
 
+  for (i = 0; i < 2; ++i) {
+    if (state->acm_standings[i]) {
+      xfree(state->acm_standings[i]->cells);
+      xfree(state->acm_standings[i]);
+    }
+  }
+  run_test_summary_free(state->test_summary);
+
   if (state->compiler_options) {
     for (i = 1; i <= state->max_lang; ++i) {
       xfree(state->compiler_options[i]);
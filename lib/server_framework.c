@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2006-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2006-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -31,6 +31,7 @@
 #include "ejudge/metrics_contest.h"
 
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include <signal.h>
 #include <sys/types.h>
@@ -39,7 +40,8 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <errno.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 #include <netinet/ip.h>
@@ -48,6 +50,19 @@
 #include <sys/time.h>
 
 #define MAX_IN_PACKET_SIZE 134217728 /* 128 mb */
+#define MAX_EPOLL_EVENTS 256
+
+/* kinds of the epoll registrations */
+enum
+{
+  NSF_PE_SOCKET = 1,            /* control socket listener */
+  NSF_PE_WS_SOCKET,             /* websocket listener */
+  NSF_PE_CLIENT,                /* control connection */
+  NSF_PE_WS_CLIENT,             /* websocket connection */
+  NSF_PE_WATCH,                 /* external watch */
+};
+
+#define CLIENT_FROM_PE(p) ((struct client_state *)((char *)(p) - offsetof(struct client_state, pe)))
 
 static volatile int sighup_flag = 0;
 static volatile int sigint_flag = 0;
@@ -71,6 +86,7 @@ sigchld_handler(int signo)
 
 struct watchlist
 {
+  struct nsf_poll_entry pe;     /* must be the first */
   struct watchlist *next, *prev;
   int pending_removal;
   struct server_framework_watch w;
@@ -102,8 +118,81 @@ struct server_framework_state
 
   struct ws_client_state *ws_first;
   struct ws_client_state *ws_last;
+
+  // all the descriptors are kept registered in the epoll set,
+  // the interest mask is updated only when it changes
+  int epoll_fd;
+  struct nsf_poll_entry socket_pe;
+  struct nsf_poll_entry ws_pe;
+
+  // worker processes serving read-only requests
+  int is_worker;
+  int worker_u, worker_a;
+  pid_t *worker_pids;
 };
 
+static int
+get_epoll_fd(struct server_framework_state *state)
+{
+  if (state->epoll_fd < 0) {
+    if ((state->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+      err("epoll_create1 failed: %s", os_ErrorMsg());
+    }
+  }
+  return state->epoll_fd;
+}
+
+/* set the epoll interest mask for `fd', mask 0 removes the descriptor
+   from the epoll set, so hangups on idle descriptors are not reported */
+static void
+poll_entry_update(
+        struct server_framework_state *state,
+        struct nsf_poll_entry *pe,
+        int fd,
+        unsigned mask)
+{
+  struct epoll_event ev;
+  int efd;
+
+  if (fd < 0) {
+    pe->registered = 0;
+    pe->mask = 0;
+    return;
+  }
+  if (pe->registered && pe->mask == mask) return;
+  if (!pe->registered && !mask) return;
+  if ((efd = get_epoll_fd(state)) < 0) return;
+
+  if (!mask) {
+    if (epoll_ctl(efd, EPOLL_CTL_DEL, fd, NULL) < 0) {
+      err("epoll_ctl DEL %d failed: %s", fd, os_ErrorMsg());
+    }
+    pe->registered = 0;
+    pe->mask = 0;
+    return;
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = mask;
+  ev.data.ptr = pe;
+  if (epoll_ctl(efd, pe->registered?EPOLL_CTL_MOD:EPOLL_CTL_ADD, fd, &ev) < 0) {
+    err("epoll_ctl %s %d failed: %s", pe->registered?"MOD":"ADD", fd,
+        os_ErrorMsg());
+    return;
+  }
+  pe->registered = 1;
+  pe->mask = mask;
+}
+
+static unsigned
+watch_events(int mode)
+{
+  unsigned mask = 0;
+  if ((mode & NSF_READ)) mask |= EPOLLIN;
+  if ((mode & NSF_WRITE)) mask |= EPOLLOUT;
+  return mask;
+}
+
 static int
 nsf_get_peer_uid(const struct client_state *p);
 static int
@@ -148,6 +237,10 @@ client_state_new(struct server_framework_state *state, int fd)
   p->client_fds[0] = -1;
   p->client_fds[1] = -1;
   p->state = STATE_READ_CREDS;
+  p->b.pe.kind = NSF_PE_CLIENT;
+  p->b.pe.registered = 0;
+  p->b.pe.mask = 0;
+  poll_entry_update(state, &p->b.pe, fd, EPOLLIN);
 
   if (!state->clients_first) {
     state->clients_first = state->clients_last = p;
@@ -225,6 +318,10 @@ ws_client_state_new(
   if (remote_addr) p->remote_addr = xstrdup(remote_addr);
   p->remote_port = remote_port;
   p->ssl_flag = ssl_flag;
+  p->b.pe.kind = NSF_PE_WS_CLIENT;
+  p->b.pe.registered = 0;
+  p->b.pe.mask = 0;
+  poll_entry_update(state, &p->b.pe, fd, EPOLLIN);
 
   p->b.prev = (struct client_state *) state->ws_last;
   if (p->b.prev) {
@@ -236,6 +333,29 @@ ws_client_state_new(
   return p;
 }
 
+static int
+write_full(int fd, const void *buf, size_t size)
+{
+  const unsigned char *p = (const unsigned char *) buf;
+  ssize_t r;
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+  while (size > 0) {
+    if ((r = write(fd, p, size)) < 0) {
+      if (errno == EINTR) continue;
+      err("write error: %s", os_ErrorMsg());
+      return -1;
+    }
+    if (!r) {
+      err("write returned 0");
+      return -1;
+    }
+    p += r;
+    size -= r;
+  }
+  return 0;
+}
+
 void
 nsf_new_autoclose(struct server_framework_state *state,
                   struct client_state *p, void *write_buf,
@@ -244,6 +364,16 @@ nsf_new_autoclose(struct server_framework_state *state,
   struct ht_client_state *pp = (struct ht_client_state*) p;
   struct ht_client_state *q;
 
+  if (state->is_worker) {
+    // no event loop in the worker
+    if (pp->client_fds[0] >= 0) {
+      write_full(pp->client_fds[0], write_buf, write_len);
+    }
+    xfree(write_buf);
+    nsf_close_client_fds(p);
+    return;
+  }
+
   q = client_state_new(state, pp->client_fds[0]);
   q->client_fds[1] = pp->client_fds[1];
   q->write_buf = write_buf;
@@ -333,6 +463,7 @@ client_state_delete(
     state->clients_first = state->clients_last = 0;
   }
 
+  poll_entry_update(state, &p->pe, p->fd, 0);
   fcntl(p->fd, F_SETFL, fcntl(p->fd, F_GETFL) & ~O_NONBLOCK);
   if (p->fd >= 0) close(p->fd);
   if (pp->client_fds[0] >= 0) close(pp->client_fds[0]);
@@ -410,6 +541,7 @@ ws_client_state_delete(
     } else {
       state->ws_last = (struct ws_client_state *) p->b.prev;
     }
+    poll_entry_update(state, &p->b.pe, p->b.fd, 0);
     ws_client_state_free(p);
   }
 }
@@ -427,6 +559,8 @@ nsf_add_watch(struct server_framework_state *state,
 
   XCALLOC(p, 1);
   p->w = *w;
+  p->pe.kind = NSF_PE_WATCH;
+  poll_entry_update(state, &p->pe, p->w.fd, watch_events(p->w.mode));
   if (!state->w_last) {
     state->w_first = state->w_last = p;
   } else {
@@ -443,6 +577,8 @@ nsf_remove_watch(struct server_framework_state *state, int fd)
 
   for (p = state->w_first; p; p = p->next) {
     if (!p->pending_removal && p->w.fd == fd) {
+      // the descriptor is usually closed right after the removal
+      poll_entry_update(state, &p->pe, p->w.fd, 0);
       p->pending_removal = 1;
       return 1;
     }
@@ -1307,6 +1443,14 @@ nsf_enqueue_reply(struct server_framework_state *state,
 
   ASSERT(!pp->write_len);
 
+  if (state->is_worker) {
+    unsigned char *buf = alloca(len + sizeof(len));
+    memcpy(buf, &len, sizeof(len));
+    memcpy(buf + sizeof(len), msg, len);
+    write_full(p->fd, buf, len + sizeof(len));
+    return;
+  }
+
   pp->write_len = len + sizeof(len);
   pp->write_buf = xmalloc(pp->write_len);
   memcpy(pp->write_buf, &len, sizeof(len));
@@ -1428,6 +1572,12 @@ handle_control_command(
   else if (state->params->handle_packet)
     state->params->handle_packet(state, &p->b, p->read_len, pkt);
 
+  // the worker has completed its only request
+  if (state->is_worker) {
+    fflush(NULL);
+    _exit(0);
+  }
+
   if (p->state == STATE_READ_READY) p->state = STATE_READ_LEN;
   if (p->read_buf) xfree(p->read_buf);
   p->read_buf = 0;
@@ -1435,104 +1585,184 @@ handle_control_command(
   p->read_len = 0;
 }
 
+static unsigned
+client_events(const struct ht_client_state *p)
+{
+  if (p->state == STATE_WRITE || p->state == STATE_WRITECLOSE)
+    return EPOLLOUT;
+  if (p->state >= STATE_READ_CREDS && p->state <= STATE_READ_DATA)
+    return EPOLLIN;
+  return 0;
+}
+
+static unsigned
+ws_client_events(const struct ws_client_state *p)
+{
+  unsigned mask = 0;
+
+  switch (p->state) {
+  case WS_STATE_INITIAL:
+    mask = EPOLLIN;
+    break;
+  case WS_STATE_INITIAL_REPLY: case WS_STATE_HTTP_ERROR:
+    if (p->write_size > 0) mask = EPOLLOUT;
+    break;
+  case WS_STATE_ACTIVE:
+    if (!p->in_close_state) mask |= EPOLLIN;
+    if (p->write_size > 0) mask |= EPOLLOUT;
+    break;
+  case WS_STATE_DISCONNECT:
+    break;
+  default:
+    abort();
+  }
+  return mask;
+}
+
+/* events reported by epoll, hangups and errors are delivered
+   to the registered handlers as select() does */
+static unsigned
+ready_events(const struct epoll_event *ev)
+{
+  const struct nsf_poll_entry *pe = ev->data.ptr;
+  unsigned mask = ev->events & (EPOLLIN | EPOLLOUT);
+  if ((ev->events & (EPOLLERR | EPOLLHUP))) mask |= pe->mask;
+  return mask;
+}
+
+static void
+reap_workers(struct server_framework_state *state)
+{
+  int i, j, status;
+
+  for (i = 0, j = 0; i < state->worker_u; ++i) {
+    if (waitpid(state->worker_pids[i], &status, WNOHANG) > 0) {
+      if (WIFSIGNALED(status)) {
+        err("worker %d terminated by signal %d", state->worker_pids[i],
+            WTERMSIG(status));
+      }
+      continue;
+    }
+    state->worker_pids[j++] = state->worker_pids[i];
+  }
+  state->worker_u = j;
+}
+
+int
+nsf_fork_worker(
+        struct server_framework_state *state,
+        struct client_state *p,
+        int max_workers)
+{
+  struct ht_client_state *pp = (struct ht_client_state*) p;
+  pid_t pid;
+
+  // websocket replies are written by the main loop
+  if (!p || p->ops != &http_client_state_operations) return -1;
+  if (state->is_worker || max_workers <= 0) return -1;
+
+  reap_workers(state);
+  if (state->worker_u >= max_workers) return -1;
+
+  // do not let the worker write out the buffered data of the parent
+  fflush(NULL);
+  if ((pid = fork()) < 0) {
+    err("fork failed: %s", os_ErrorMsg());
+    return -1;
+  }
+  if (!pid) {
+    // the epoll set and the listening sockets belong to the parent
+    if (state->epoll_fd >= 0) close(state->epoll_fd);
+    state->epoll_fd = -1;
+    if (state->socket_fd >= 0) close(state->socket_fd);
+    state->socket_fd = -1;
+    if (state->ws_fd >= 0) close(state->ws_fd);
+    state->ws_fd = -1;
+    state->is_worker = 1;
+    signal(SIGHUP, SIG_DFL);
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGCHLD, SIG_DFL);
+    sigprocmask(SIG_SETMASK, &state->orig_mask, 0);
+    return 0;
+  }
+
+  if (state->worker_u == state->worker_a) {
+    if (!(state->worker_a *= 2)) state->worker_a = 8;
+    XREALLOC(state->worker_pids, state->worker_a);
+  }
+  state->worker_pids[state->worker_u++] = pid;
+
+  // the worker writes the reply and the page
+  if (pp->client_fds[0] >= 0) close(pp->client_fds[0]);
+  if (pp->client_fds[1] >= 0) close(pp->client_fds[1]);
+  pp->client_fds[0] = -1;
+  pp->client_fds[1] = -1;
+  return pid;
+}
+
+int
+nsf_is_worker(const struct server_framework_state *state)
+{
+  return state->is_worker;
+}
+
 void
 nsf_main_loop(struct server_framework_state *state)
 {
   struct ht_client_state *cur_clnt;
-  struct timeval timeout;
-  int fd_max, n, errcode;
-  fd_set rset, wset;
+  int timeout_ms, n, i;
+  struct epoll_event events[MAX_EPOLL_EVENTS];
+  struct nsf_poll_entry *pe;
   struct watchlist *pw;
   int mode;
   struct ws_client_state *ws_clnt;
   long long current_time_us;
+  int socket_ready, ws_ready;
+  unsigned mask;
+
+  state->socket_pe.kind = NSF_PE_SOCKET;
+  state->ws_pe.kind = NSF_PE_WS_SOCKET;
+  if (get_epoll_fd(state) < 0) return;
+
+  // signals are delivered only inside epoll_pwait
+  sigprocmask(SIG_SETMASK, &state->block_mask, 0);
 
   while (1) {
     int work_done = 1;
     if (state->params->loop_start) work_done = state->params->loop_start(state);
 
-    fd_max = -1;
-    FD_ZERO(&rset);
-    FD_ZERO(&wset);
-
-    if (state->socket_fd >= 0) {
-      FD_SET(state->socket_fd, &rset);
-      if (state->socket_fd > fd_max) fd_max = state->socket_fd;
-    }
-    if (state->ws_fd >= 0) {
-      FD_SET(state->ws_fd, &rset);
-      if (state->ws_fd > fd_max) fd_max = state->ws_fd;
-    }
+    // the registrations are persistent, only the changed interest
+    // masks are passed to the kernel
+    poll_entry_update(state, &state->socket_pe, state->socket_fd, EPOLLIN);
+    poll_entry_update(state, &state->ws_pe, state->ws_fd, EPOLLIN);
 
     for (cur_clnt = state->clients_first; cur_clnt; cur_clnt = (struct ht_client_state *) cur_clnt->b.next) {
-      if (cur_clnt->state==STATE_WRITE || cur_clnt->state==STATE_WRITECLOSE) {
-        FD_SET(cur_clnt->b.fd, &wset);
-        if (cur_clnt->b.fd > fd_max) fd_max = cur_clnt->b.fd;
-      } else if (cur_clnt->state >= STATE_READ_CREDS
-                 && cur_clnt->state <= STATE_READ_DATA) {
-        FD_SET(cur_clnt->b.fd, &rset);
-        if (cur_clnt->b.fd > fd_max) fd_max = cur_clnt->b.fd;
-      }
+      poll_entry_update(state, &cur_clnt->b.pe, cur_clnt->b.fd,
+                        client_events(cur_clnt));
     }
 
     for (ws_clnt = state->ws_first; ws_clnt; ws_clnt = (struct ws_client_state *) ws_clnt->b.next) {
-      switch (ws_clnt->state) {
-      case WS_STATE_INITIAL:
-        FD_SET(ws_clnt->b.fd, &rset);
-        if (ws_clnt->b.fd > fd_max) fd_max = ws_clnt->b.fd;
-        break;
-      case WS_STATE_INITIAL_REPLY: case WS_STATE_HTTP_ERROR:
-        if (ws_clnt->write_size > 0) {
-          FD_SET(ws_clnt->b.fd, &wset);
-          if (ws_clnt->b.fd > fd_max) fd_max = ws_clnt->b.fd;
-        }
-        break;
-      case WS_STATE_ACTIVE:
-        if (!ws_clnt->in_close_state) {
-          FD_SET(ws_clnt->b.fd, &rset);
-          if (ws_clnt->b.fd > fd_max) fd_max = ws_clnt->b.fd;
-        }
-        if (ws_clnt->write_size > 0) {
-          FD_SET(ws_clnt->b.fd, &wset);
-            if (ws_clnt->b.fd > fd_max) fd_max = ws_clnt->b.fd;
-        }
-        break;
-      default:
-        abort();
-      }
+      poll_entry_update(state, &ws_clnt->b.pe, ws_clnt->b.fd,
+                        ws_client_events(ws_clnt));
     }
 
     remove_pending_watches(state);
     for (pw = state->w_first; pw; pw = pw->next) {
       if (pw->pending_removal || pw->w.fd < 0) continue;
-      if ((pw->w.mode & NSF_READ)) {
-        FD_SET(pw->w.fd, &rset);
-        if (pw->w.fd > fd_max) fd_max = pw->w.fd;
-      }
-      if ((pw->w.mode & NSF_WRITE)) {
-        FD_SET(pw->w.fd, &wset);
-        if (pw->w.fd > fd_max) fd_max = pw->w.fd;
-      }
+      poll_entry_update(state, &pw->pe, pw->w.fd, watch_events(pw->w.mode));
     }
 
-    timeout.tv_sec = state->params->select_timeout;
-    if (timeout.tv_sec <= 0) timeout.tv_sec = 10;
-    timeout.tv_usec = 0;
-    if (!work_done) timeout.tv_sec = 0;
+    timeout_ms = state->params->select_timeout;
+    if (timeout_ms <= 0) timeout_ms = 10;
+    timeout_ms *= 1000;
+    if (!work_done) timeout_ms = 0;
 
-    // here's a potential race condition :-(
-    // it cannot be handled properly until Linux
-    // has the proper pselect implementation
-    sigprocmask(SIG_SETMASK, &state->work_mask, 0);
-    errno = 0;
-    n = select(fd_max + 1, &rset, &wset, 0, &timeout);
-    errcode = errno;
-    sigprocmask(SIG_SETMASK, &state->block_mask, 0);
-    errno = errcode;
-    // end of race condition prone code
+    n = epoll_pwait(state->epoll_fd, events, MAX_EPOLL_EVENTS, timeout_ms,
+                    &state->work_mask);
 
     if (n < 0 && errno != EINTR) {
-      err("unexpected select error: %s", os_ErrorMsg());
+      err("unexpected epoll_pwait error: %s", os_ErrorMsg());
       continue;
     }
 
@@ -1542,21 +1772,42 @@ nsf_main_loop(struct server_framework_state *state)
       state->restart_requested = 1;
       break;
     }
+    if (sigchld_flag) {
+      sigchld_flag = 0;
+      reap_workers(state);
+    }
 
     if (n <= 0) continue;
 
     // call post-select callback
     if (state->params->post_select) state->params->post_select(state);
 
-    // process watches
-    for (pw = state->w_first; pw; pw = pw->next) {
-      if (pw->pending_removal || pw->w.fd < 0) continue;
-      mode = 0;
-      if ((pw->w.mode & NSF_READ) && FD_ISSET(pw->w.fd, &rset))
-        mode |= NSF_READ;
-      if ((pw->w.mode & NSF_WRITE) && FD_ISSET(pw->w.fd, &wset))
-        mode |= NSF_WRITE;
-      if (mode) pw->w.callback(state, &pw->w, mode);
+    // process watches, the watch entries are dropped from the ready
+    // list, as the watches may be freed below
+    socket_ready = 0;
+    ws_ready = 0;
+    for (i = 0; i < n; ++i) {
+      pe = events[i].data.ptr;
+      switch (pe->kind) {
+      case NSF_PE_SOCKET:
+        socket_ready = 1;
+        break;
+      case NSF_PE_WS_SOCKET:
+        ws_ready = 1;
+        break;
+      case NSF_PE_WATCH:
+        pw = (struct watchlist *) pe;
+        mask = ready_events(&events[i]);
+        events[i].data.ptr = NULL;
+        if (pw->pending_removal || pw->w.fd < 0) continue;
+        mode = 0;
+        if ((pw->w.mode & NSF_READ) && (mask & EPOLLIN))
+          mode |= NSF_READ;
+        if ((pw->w.mode & NSF_WRITE) && (mask & EPOLLOUT))
+          mode |= NSF_WRITE;
+        if (mode) pw->w.callback(state, &pw->w, mode);
+        break;
+      }
     }
     remove_pending_watches(state);
 
@@ -1566,38 +1817,44 @@ nsf_main_loop(struct server_framework_state *state)
     metrics.data->update_time = tv;
 
     // new WebSocket connections
-    if (state->ws_fd >= 0 && FD_ISSET(state->ws_fd, &rset)) {
+    if (state->ws_fd >= 0 && ws_ready) {
       accept_new_ws_connections(state);
     }
 
     // check for new control connections
-    if (state->socket_fd >= 0 && FD_ISSET(state->socket_fd, &rset)) {
+    if (state->socket_fd >= 0 && socket_ready) {
       accept_new_connection(state);
     }
 
     // read from/write to control sockets
-    for (cur_clnt = state->clients_first; cur_clnt; cur_clnt = (struct ht_client_state *) cur_clnt->b.next) {
+    for (i = 0; i < n; ++i) {
+      if (!(pe = events[i].data.ptr) || pe->kind != NSF_PE_CLIENT) continue;
+      cur_clnt = (struct ht_client_state *) CLIENT_FROM_PE(pe);
+      mask = ready_events(&events[i]);
       switch (cur_clnt->state) {
       case STATE_READ_CREDS:
       case STATE_READ_FDS:
       case STATE_READ_LEN:
       case STATE_READ_DATA:
-        if (FD_ISSET(cur_clnt->b.fd, &rset))
+        if ((mask & EPOLLIN))
           read_from_control_connection(cur_clnt);
         break;
       case STATE_WRITE:
       case STATE_WRITECLOSE:
-        if (FD_ISSET(cur_clnt->b.fd, &wset))
+        if ((mask & EPOLLOUT))
           write_to_control_connection(cur_clnt);
         break;
       }
     }
 
-    for (ws_clnt = state->ws_first; ws_clnt; ws_clnt = (struct ws_client_state *) ws_clnt->b.next) {
-      if (FD_ISSET(ws_clnt->b.fd, &rset)) {
+    for (i = 0; i < n; ++i) {
+      if (!(pe = events[i].data.ptr) || pe->kind != NSF_PE_WS_CLIENT) continue;
+      ws_clnt = (struct ws_client_state *) CLIENT_FROM_PE(pe);
+      mask = ready_events(&events[i]);
+      if ((mask & EPOLLIN)) {
         read_ws_connection(state, ws_clnt, current_time_us);
       }
-      if (FD_ISSET(ws_clnt->b.fd, &wset)) {
+      if ((mask & EPOLLOUT)) {
         write_ws_connection(ws_clnt, current_time_us);
         if (ws_clnt->write_size == 0 && ws_clnt->state == WS_STATE_INITIAL_REPLY) {
           ws_clnt->state = WS_STATE_ACTIVE;
@@ -1836,6 +2093,11 @@ nsf_cleanup(struct server_framework_state *state)
   if (state->socket_fd >= 0) close(state->socket_fd);
   state->socket_fd = -1;
   unlink(state->params->socket_path);
+
+  if (state->epoll_fd >= 0) close(state->epoll_fd);
+  state->epoll_fd = -1;
+  state->socket_pe.registered = 0;
+  state->ws_pe.registered = 0;
 }
 
 int
@@ -1857,6 +2119,7 @@ nsf_init(
   state->user_data = data;
   //state->client_id = 1;
   state->server_start_time = server_start_time;
+  state->epoll_fd = -1;
   return state;
 }
 
@@ -0,0 +1,70 @@
+/* -*- mode: c -*- */
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "ejudge/spool_notify.h"
+#include "ejudge/fileutl.h"
+
+#include "ejudge/xalloc.h"
+#include "ejudge/osdeps.h"
+
+/* the spool directory is watched through the scan_dir queue, so
+   the events are seen by scan_dir without a second inotify watch */
+struct spool_notify
+{
+  unsigned char *queue_dir;
+};
+
+struct spool_notify *
+spool_notify_open(const unsigned char *queue_dir)
+{
+  struct spool_notify *sn = NULL;
+
+  if (!queue_dir || !*queue_dir) return NULL;
+  // sets up the watch
+  if (scan_dir_wait(queue_dir, 0) < 0) return NULL;
+
+  XCALLOC(sn, 1);
+  sn->queue_dir = xstrdup(queue_dir);
+  return sn;
+}
+
+struct spool_notify *
+spool_notify_close(struct spool_notify *sn)
+{
+  if (sn) {
+    xfree(sn->queue_dir);
+    xfree(sn);
+  }
+  return NULL;
+}
+
+int
+spool_notify_wait(struct spool_notify *sn, int timeout_ms)
+{
+  int r;
+
+  if (!sn) {
+    os_Sleep(timeout_ms);
+    return 0;
+  }
+
+  if ((r = scan_dir_wait(sn->queue_dir, timeout_ms)) < 0) {
+    // the watch is lost, it is set up again on the next call
+    os_Sleep(timeout_ms);
+    return 0;
+  }
+  return r;
+}
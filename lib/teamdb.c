@@ -1,6 +1,6 @@
 /* -*- c -*- */
 
-/* Copyright (C) 2000-2017 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2000-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -28,6 +28,7 @@
 #include "ejudge/logger.h"
 #include "ejudge/osdeps.h"
 #include "ejudge/userlist_bin.h"
+#include "ejudge/userlist_shm.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -156,6 +157,71 @@ close_connection(struct old_db_state *old_db)
   }
 }
 
+/* after so many deltas the complete list is requested to free memory */
+enum { MAX_DELTAS = 64 };
+
+static void
+free_users(teamdb_state_t state)
+{
+  if (!state->header) {
+    if (state->users) {
+      userlist_free((struct xml_tree*) state->users);
+    }
+  } else {
+    userlist_shm_free(state->header);
+  }
+  state->header = NULL;
+  state->users = NULL;
+  for (int i = 0; i < state->delta_u; ++i) {
+    userlist_shm_free(state->deltas[i]);
+  }
+  xfree(state->deltas);
+  state->deltas = NULL;
+  state->delta_u = state->delta_a = 0;
+  xfree(state->own_user_map);
+  state->own_user_map = NULL;
+  state->users_vintage = 0;
+}
+
+/* replaces the changed users in the current user map */
+static void
+apply_delta(teamdb_state_t state, UserlistBinaryHeader *header)
+{
+  const struct userlist_list *dl = userlist_bin_get_root(header);
+  struct userlist_list *ul = state->users;
+  const int32_t *removed = userlist_bin_get_removed(header);
+  int i;
+
+  if (!state->own_user_map || dl->user_map_size > ul->user_map_size) {
+    int new_size = ul->user_map_size;
+    if (dl->user_map_size > new_size) new_size = dl->user_map_size;
+    struct userlist_user **map = NULL;
+    XCALLOC(map, new_size);
+    if (ul->user_map_size > 0) {
+      memcpy(map, ul->user_map, ul->user_map_size * sizeof(map[0]));
+    }
+    xfree(state->own_user_map);
+    state->own_user_map = map;
+    ul->user_map = map;
+    ul->user_map_size = new_size;
+  }
+  for (i = 1; i < dl->user_map_size; ++i) {
+    if (dl->user_map[i]) ul->user_map[i] = dl->user_map[i];
+  }
+  for (i = 0; i < header->removed_count; ++i) {
+    if (removed[i] > 0 && removed[i] < ul->user_map_size) {
+      ul->user_map[removed[i]] = NULL;
+    }
+  }
+
+  if (state->delta_u == state->delta_a) {
+    if (!(state->delta_a *= 2)) state->delta_a = 8;
+    XREALLOC(state->deltas, state->delta_a);
+  }
+  state->deltas[state->delta_u++] = header;
+  state->users_vintage = header->vintage;
+}
+
 int
 teamdb_refresh(teamdb_state_t state)
 {
@@ -182,16 +248,45 @@ teamdb_refresh(teamdb_state_t state)
   if (cnts && cnts->user_contest_num) user_contest_id = cnts->user_contest_num;
 
   if (state->callbacks) {
-    r = state->callbacks->list_all_users(state->callbacks->user_data,
-                                         user_contest_id, NULL, &new_header);
+    r = -1;
+    if (state->callbacks->list_changed_users) {
+      unsigned long long vintage = 0;
+      if (state->header && state->users_vintage > 0 && state->delta_u < MAX_DELTAS) {
+        vintage = state->users_vintage;
+      }
+      r = state->callbacks->list_changed_users(state->callbacks->user_data,
+                                               user_contest_id, vintage,
+                                               &new_header);
+      if (r < 0) {
+        info("teamdb_refresh: cannot load changed users: %s, trying complete list",
+             userlist_strerror(-r));
+      }
+    }
+    if (r < 0) {
+      r = state->callbacks->list_all_users(state->callbacks->user_data,
+                                           user_contest_id, NULL, &new_header);
+    }
     if (r < 0) {
       err("teamdb_refresh: cannot load userlist: %s", userlist_strerror(-r));
       return -1;
     }
     data_size = new_header->pkt_size;
-    new_users = (struct userlist_list*) userlist_bin_get_root(new_header);
     state->need_update = 0;
     state->pseudo_vintage++;
+    if ((new_header->flags & USERLIST_BIN_DELTA)) {
+      if (!state->header || new_header->base_vintage != state->users_vintage) {
+        // should not happen, reload everything next time
+        err("teamdb_refresh: unexpected delta for vintage %llu",
+            (unsigned long long) new_header->base_vintage);
+        userlist_shm_free(new_header);
+        state->need_update = 1;
+        state->users_vintage = 0;
+        return -1;
+      }
+      apply_delta(state, new_header);
+      goto rebuild_index;
+    }
+    new_users = (struct userlist_list*) userlist_bin_get_root(new_header);
   } else {
     unsigned char *xml_text = NULL;
     if (open_connection(&state->old, user_contest_id) < 0) return -1;
@@ -234,16 +329,15 @@ teamdb_refresh(teamdb_state_t state)
     }
   }
 
-  if (!state->header) {
-    if (state->users) {
-      userlist_free((struct xml_tree*) state->users);
-    }
-  }
-  if (state->header) {
-    xfree(state->header);
-  }
+  free_users(state);
   state->header = new_header;
   state->users = new_users;
+  if (new_header) state->users_vintage = new_header->vintage;
+
+rebuild_index:
+  xfree(state->key_index);
+  state->key_index = 0;
+  state->key_index_size = 0;
   xfree(state->participants);
   state->participants = 0;
   xfree(state->u_contests);
@@ -356,68 +450,116 @@ teamdb_lookup(teamdb_state_t state, int teamno)
   return teamdb_lookup_client(state, teamno);
 }
 
-int
-teamdb_lookup_login(teamdb_state_t state, char const *login)
+enum
 {
-  int i;
+  KEY_LOGIN,
+  KEY_NAME,
+  KEY_CYPHER,
 
-  if (state->disabled) return -1;
+  KEY_LAST
+};
 
-  if (teamdb_refresh(state) < 0) return -1;
-  if (!state->participants) return -1;
-  for (i = 0; i < state->total_participants; i++) {
-    ASSERT(state->participants[i]);
-    ASSERT(state->participants[i]->login);
-    if (!strcmp(state->participants[i]->login, login))
-      return state->participants[i]->id;
+static const unsigned char *
+get_participant_key(const struct userlist_user *u, int kind)
+{
+  const unsigned char *v = 0;
+
+  if (!u) return 0;
+  switch (kind) {
+  case KEY_LOGIN:
+    return u->login;
+  case KEY_NAME:
+    if (u->cnts0) v = u->cnts0->name;
+    if (!v || !*v) v = u->login;
+    return v;
+  case KEY_CYPHER:
+    if (u->cnts0) v = u->cnts0->exam_cypher;
+    return v;
   }
-  return -1;
+  return 0;
 }
 
-int
-teamdb_lookup_name(teamdb_state_t state, char const *name)
+static unsigned
+key_hash(const unsigned char *s)
 {
-  int i;
-  const unsigned char *v;
-  const struct userlist_user *u = 0;
+  unsigned h = 2166136261U;
 
-  if (state->disabled) return -1;
+  for (; *s; ++s) {
+    h ^= *s;
+    h *= 16777619U;
+  }
+  return h;
+}
 
-  if (teamdb_refresh(state) < 0) return -1;
-  if (!state->participants) return -1;
-  for (i = 0; i < state->total_participants; i++) {
-    u = state->participants[i];
-    ASSERT(u);
-    v = 0;
-    if (u->cnts0) v = u->cnts0->name;
-    if (!v || !*v) v = state->participants[i]->login;
-    ASSERT(v);
-    if (!strcmp(v, name))
-      return state->participants[i]->id;
+static void
+build_key_index(teamdb_state_t state)
+{
+  int size = 16, kind, i;
+  unsigned mask, h;
+  int *index;
+  const unsigned char *key, *key2;
+
+  while (size < 2 * state->total_participants) size *= 2;
+  XCALLOC(state->key_index, KEY_LAST * size);
+  state->key_index_size = size;
+  mask = size - 1;
+
+  for (kind = 0; kind < KEY_LAST; ++kind) {
+    index = state->key_index + kind * size;
+    for (i = 0; i < state->total_participants; ++i) {
+      if (!(key = get_participant_key(state->participants[i], kind)))
+        continue;
+      for (h = key_hash(key) & mask; index[h]; h = (h + 1) & mask) {
+        key2 = get_participant_key(state->participants[index[h] - 1], kind);
+        // the first participant with the given key wins
+        if (!strcmp(key, key2)) break;
+      }
+      if (!index[h]) index[h] = i + 1;
+    }
   }
-  return -1;
 }
 
-int
-teamdb_lookup_cypher(teamdb_state_t state, char const *cypher)
+static int
+lookup_key(teamdb_state_t state, int kind, const unsigned char *key)
 {
-  int i;
+  unsigned mask, h;
+  const int *index;
   const struct userlist_user *u;
-  const struct userlist_user_info *ui;
 
   if (state->disabled) return -1;
+  if (!key) return -1;
 
   if (teamdb_refresh(state) < 0) return -1;
   if (!state->participants) return -1;
-  for (i = 0; i < state->total_participants; i++) {
-    if (!(u = state->participants[i])) continue;
-    if (!(ui = u->cnts0)) continue;
-    if (ui->exam_cypher && !strcmp(ui->exam_cypher, cypher))
-      return u->id;
+  if (!state->key_index) build_key_index(state);
+
+  mask = state->key_index_size - 1;
+  index = state->key_index + kind * state->key_index_size;
+  for (h = key_hash(key) & mask; index[h]; h = (h + 1) & mask) {
+    u = state->participants[index[h] - 1];
+    if (!strcmp(get_participant_key(u, kind), key)) return u->id;
   }
   return -1;
 }
 
+int
+teamdb_lookup_login(teamdb_state_t state, char const *login)
+{
+  return lookup_key(state, KEY_LOGIN, login);
+}
+
+int
+teamdb_lookup_name(teamdb_state_t state, char const *name)
+{
+  return lookup_key(state, KEY_NAME, name);
+}
+
+int
+teamdb_lookup_cypher(teamdb_state_t state, char const *cypher)
+{
+  return lookup_key(state, KEY_CYPHER, cypher);
+}
+
 char *
 teamdb_get_login(teamdb_state_t state, int teamid)
 {
@@ -828,13 +970,8 @@ teamdb_destroy(teamdb_state_t state)
   }
   xfree(state->callbacks);
 
-  if (!state->header) {
-    if (state->users) {
-      userlist_free((struct xml_tree*) state->users);
-    }
-  } else {
-    xfree(state->header);
-  }
+  free_users(state);
+  xfree(state->key_index);
   xfree(state->participants);
   xfree(state->u_contests);
   for (i = 0; i < state->extra_num; i++)
@@ -0,0 +1,624 @@
+/* -*- mode: c; c-basic-offset: 4 -*- */
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "ejudge/test_data_cache.h"
+#include "ejudge/test_count_cache.h"
+#include "ejudge/dyntrie.h"
+#include "ejudge/sha256.h"
+#include "ejudge/xalloc.h"
+#include "ejudge/errlog.h"
+#include "ejudge/osdeps.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <limits.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <ctype.h>
+#include <time.h>
+
+enum { HASH_SIZE = SHA256_BLOCK_SIZE * 2 + 1 };
+
+#define TEST_DATA_CACHE_DEFAULT_SIZE (4LL * 1024 * 1024 * 1024)
+
+/* objects used recently might be being copied by another process */
+enum { EVICT_GRACE_TIME = 600 };
+
+struct test_data_entry
+{
+    long long size;
+    long long mtime_ns;
+    long long dev;
+    long long ino;
+    unsigned char hash[HASH_SIZE];
+    unsigned char valid;
+};
+
+struct test_data_set
+{
+    unsigned char *dir;
+    unsigned char *pattern;
+    unsigned char *key;
+    long long last_check_us;
+    int loaded;
+    int count;
+    struct test_data_entry *entries; // indexed from 1
+    int entrya;
+};
+
+struct test_data_cache_state
+{
+    unsigned char *cache_dir;
+    struct test_data_set **sets;
+    size_t seta, setu;
+    struct dyntrie_node *trie;
+    int tmp_serial;
+    long long max_size;
+    long long total_size;
+};
+
+struct test_data_object
+{
+    unsigned char path[PATH_MAX];
+    long long size;
+    time_t mtime;
+};
+
+static struct test_data_cache_state *default_state = NULL;
+
+static int
+is_valid_hash(const unsigned char *hash)
+{
+    int i;
+    for (i = 0; hash[i]; ++i) {
+        if (!isxdigit(hash[i])) return 0;
+    }
+    return i == HASH_SIZE - 1;
+}
+
+static int
+object_sort_func(const void *p1, const void *p2)
+{
+    const struct test_data_object *o1 = (const struct test_data_object *) p1;
+    const struct test_data_object *o2 = (const struct test_data_object *) p2;
+    if (o1->mtime < o2->mtime) return -1;
+    if (o1->mtime > o2->mtime) return 1;
+    return 0;
+}
+
+/* collect all the objects, the mtime of an object is updated on each use */
+static long long
+scan_objects(
+        struct test_data_cache_state *s,
+        struct test_data_object **p_objs,
+        size_t *p_count)
+{
+    struct test_data_object *objs = NULL;
+    size_t a = 0, u = 0;
+    long long total = 0;
+    unsigned char dir1[PATH_MAX];
+    unsigned char dir2[PATH_MAX];
+    DIR *d1, *d2;
+    struct dirent *dd1, *dd2;
+    struct stat stb;
+
+    snprintf(dir1, sizeof(dir1), "%s/objects", s->cache_dir);
+    if (!(d1 = opendir(dir1))) {
+        err("test_data_cache: cannot open '%s': %s", dir1, os_ErrorMsg());
+        goto done;
+    }
+    while ((dd1 = readdir(d1))) {
+        if (strlen(dd1->d_name) != 2 || !isxdigit(dd1->d_name[0])
+            || !isxdigit(dd1->d_name[1])) continue;
+        snprintf(dir2, sizeof(dir2), "%s/%s", dir1, dd1->d_name);
+        if (!(d2 = opendir(dir2))) continue;
+        while ((dd2 = readdir(d2))) {
+            if (!is_valid_hash(dd2->d_name)) continue;
+            if (u == a) {
+                if (!(a *= 2)) a = 64;
+                XREALLOC(objs, a);
+            }
+            snprintf(objs[u].path, sizeof(objs[u].path), "%s/%s", dir2, dd2->d_name);
+            if (lstat(objs[u].path, &stb) < 0 || !S_ISREG(stb.st_mode)) continue;
+            objs[u].mtime = stb.st_mtime;
+            objs[u].size = stb.st_size;
+            total += stb.st_size;
+            ++u;
+        }
+        closedir(d2);
+    }
+    closedir(d1);
+
+done:
+    if (p_objs) {
+        *p_objs = objs;
+        *p_count = u;
+    } else {
+        xfree(objs);
+    }
+    return total;
+}
+
+/* remove the least recently used objects, the removed objects are
+   stored again by test_data_cache_lookup when they are needed */
+static void
+evict_objects(struct test_data_cache_state *s)
+{
+    struct test_data_object *objs = NULL;
+    size_t count = 0, i;
+    long long total, target;
+    int removed = 0;
+    time_t min_time = time(NULL) - EVICT_GRACE_TIME;
+
+    total = scan_objects(s, &objs, &count);
+    // leave some room to avoid rescanning on each store
+    target = s->max_size - s->max_size / 8;
+    if (total > s->max_size) {
+        qsort(objs, count, sizeof(objs[0]), object_sort_func);
+        for (i = 0; i < count && total > target; ++i) {
+            if (objs[i].mtime >= min_time) break;
+            if (unlink(objs[i].path) < 0 && errno != ENOENT) continue;
+            total -= objs[i].size;
+            ++removed;
+        }
+        info("test_data_cache: %d objects removed, size is %lld", removed, total);
+    }
+    s->total_size = total;
+    xfree(objs);
+}
+
+struct test_data_cache_state *
+test_data_cache_new(const unsigned char *cache_dir, long long max_size)
+{
+    unsigned char path[PATH_MAX];
+
+    if (os_MakeDirPath(cache_dir, 0755) < 0) {
+        err("test_data_cache: cannot create '%s'", cache_dir);
+        return NULL;
+    }
+    snprintf(path, sizeof(path), "%s/objects", cache_dir);
+    os_MakeDirPath(path, 0755);
+    snprintf(path, sizeof(path), "%s/manifests", cache_dir);
+    os_MakeDirPath(path, 0755);
+    snprintf(path, sizeof(path), "%s/tmp", cache_dir);
+    os_MakeDirPath(path, 0700);
+
+    struct test_data_cache_state *s = NULL;
+    XCALLOC(s, 1);
+    s->cache_dir = xstrdup(cache_dir);
+    s->setu = 1;
+    s->seta = 16;
+    XCALLOC(s->sets, s->seta);
+    s->max_size = max_size;
+    if (s->max_size <= 0) s->max_size = TEST_DATA_CACHE_DEFAULT_SIZE;
+    s->total_size = scan_objects(s, NULL, NULL);
+    info("test_data_cache: %s, size %lld, limit %lld", s->cache_dir,
+         s->total_size, s->max_size);
+    if (s->total_size > s->max_size) evict_objects(s);
+    return s;
+}
+
+struct test_data_cache_state *
+test_data_cache_free(struct test_data_cache_state *s)
+{
+    if (s) {
+        if (default_state == s) default_state = NULL;
+        dyntrie_free(&s->trie, NULL, NULL);
+        for (int i = 1; i < s->setu; ++i) {
+            struct test_data_set *ts = s->sets[i];
+            if (ts) {
+                free(ts->dir);
+                free(ts->pattern);
+                free(ts->key);
+                free(ts->entries);
+                free(ts);
+            }
+        }
+        free(s->sets);
+        free(s->cache_dir);
+        free(s);
+    }
+    return NULL;
+}
+
+void
+test_data_cache_set_default(struct test_data_cache_state *s)
+{
+    default_state = s;
+}
+
+static void
+hash_to_hex(const uint8_t *digest, unsigned char *buf)
+{
+    for (int i = 0; i < SHA256_BLOCK_SIZE; ++i) {
+        snprintf(buf + i * 2, 3, "%02x", digest[i]);
+    }
+}
+
+static long long
+get_current_time_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static int
+is_same_file(const struct test_data_entry *e, const struct stat *stb)
+{
+    return e->size == stb->st_size
+        && e->mtime_ns == stb->st_mtim.tv_sec * 1000000000LL + stb->st_mtim.tv_nsec
+        && e->dev == stb->st_dev
+        && e->ino == stb->st_ino;
+}
+
+static void
+make_manifest_path(
+        const struct test_data_cache_state *s,
+        const struct test_data_set *ts,
+        unsigned char *buf,
+        size_t size)
+{
+    SHA256_CTX ctx;
+    uint8_t digest[SHA256_BLOCK_SIZE];
+    unsigned char hex[HASH_SIZE];
+
+    sha256_init(&ctx);
+    sha256_update(&ctx, (const uint8_t *) ts->key, strlen(ts->key));
+    sha256_final(&ctx, digest);
+    hash_to_hex(digest, hex);
+    snprintf(buf, size, "%s/manifests/%s", s->cache_dir, hex);
+}
+
+static void
+make_object_path(
+        const struct test_data_cache_state *s,
+        const unsigned char *hash,
+        unsigned char *buf,
+        size_t size)
+{
+    snprintf(buf, size, "%s/objects/%.2s/%s", s->cache_dir, hash, hash);
+}
+
+static void
+reserve_entries(struct test_data_set *ts, int count)
+{
+    if (count + 1 <= ts->entrya) return;
+    int newa = ts->entrya;
+    if (!newa) newa = 32;
+    while (newa < count + 1) newa *= 2;
+    XREALLOC(ts->entries, newa);
+    memset(ts->entries + ts->entrya, 0, (newa - ts->entrya) * sizeof(ts->entries[0]));
+    ts->entrya = newa;
+}
+
+/* the manifest lets a restarted process reuse the cache without
+   reading the source files again */
+static void
+load_manifest(struct test_data_cache_state *s, struct test_data_set *ts)
+{
+    unsigned char path[PATH_MAX];
+    unsigned char line[PATH_MAX + 256];
+    FILE *f = NULL;
+
+    ts->loaded = 1;
+    make_manifest_path(s, ts, path, sizeof(path));
+    if (!(f = fopen(path, "r"))) return;
+    if (!fgets(line, sizeof(line), f)) goto done;
+    size_t len = strlen(line);
+    if (len > 0 && line[len - 1] == '\n') line[--len] = 0;
+    if (strcmp(line, ts->key) != 0) goto done;
+
+    while (fgets(line, sizeof(line), f)) {
+        int num = 0;
+        struct test_data_entry e = {};
+        if (sscanf(line, "%d%lld%lld%lld%lld%64s", &num, &e.size, &e.mtime_ns,
+                   &e.dev, &e.ino, e.hash) != 6) {
+            break;
+        }
+        if (num <= 0 || num > 1000000 || strlen(e.hash) != HASH_SIZE - 1) break;
+        reserve_entries(ts, num);
+        e.valid = 1;
+        ts->entries[num] = e;
+    }
+
+done:;
+    fclose(f);
+}
+
+static void
+save_manifest(struct test_data_cache_state *s, const struct test_data_set *ts)
+{
+    unsigned char path[PATH_MAX];
+    unsigned char tmp_path[PATH_MAX];
+    FILE *f = NULL;
+
+    make_manifest_path(s, ts, path, sizeof(path));
+    snprintf(tmp_path, sizeof(tmp_path), "%s/tmp/manifest_%d_%d", s->cache_dir,
+             (int) getpid(), ++s->tmp_serial);
+    if (!(f = fopen(tmp_path, "w"))) {
+        err("test_data_cache: cannot create '%s': %s", tmp_path, os_ErrorMsg());
+        return;
+    }
+    fprintf(f, "%s\n", ts->key);
+    for (int i = 1; i <= ts->count; ++i) {
+        const struct test_data_entry *e = &ts->entries[i];
+        if (!e->valid) continue;
+        fprintf(f, "%d %lld %lld %lld %lld %s\n", i, e->size, e->mtime_ns,
+                e->dev, e->ino, e->hash);
+    }
+    if (ferror(f)) {
+        err("test_data_cache: write error to '%s'", tmp_path);
+        fclose(f);
+        unlink(tmp_path);
+        return;
+    }
+    if (fclose(f) < 0 || rename(tmp_path, path) < 0) {
+        err("test_data_cache: cannot save '%s': %s", path, os_ErrorMsg());
+        unlink(tmp_path);
+    }
+}
+
+/* copy the file into the cache computing its hash on the way,
+   identical files are stored only once */
+static int
+store_object(
+        struct test_data_cache_state *s,
+        const unsigned char *src_path,
+        struct test_data_entry *e)
+{
+    unsigned char tmp_path[PATH_MAX];
+    unsigned char obj_path[PATH_MAX];
+    unsigned char obj_dir[PATH_MAX];
+    int sfd = -1, dfd = -1;
+    int retval = -1;
+    struct stat stb1, stb2;
+    SHA256_CTX ctx;
+    uint8_t digest[SHA256_BLOCK_SIZE];
+    char buf[65536];
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s/tmp/object_%d_%d", s->cache_dir,
+             (int) getpid(), ++s->tmp_serial);
+    if ((sfd = open(src_path, O_RDONLY | O_CLOEXEC, 0)) < 0) {
+        err("test_data_cache: cannot open '%s': %s", src_path, os_ErrorMsg());
+        goto done;
+    }
+    if (fstat(sfd, &stb1) < 0 || !S_ISREG(stb1.st_mode)) {
+        err("test_data_cache: '%s' is not a regular file", src_path);
+        goto done;
+    }
+    if ((dfd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0444)) < 0) {
+        err("test_data_cache: cannot create '%s': %s", tmp_path, os_ErrorMsg());
+        goto done;
+    }
+
+    sha256_init(&ctx);
+    while (1) {
+        ssize_t r = read(sfd, buf, sizeof(buf));
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) {
+            err("test_data_cache: read error on '%s': %s", src_path, os_ErrorMsg());
+            goto done;
+        }
+        if (!r) break;
+        sha256_update(&ctx, (const uint8_t *) buf, r);
+        char *p = buf;
+        while (r > 0) {
+            ssize_t w = write(dfd, p, r);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) {
+                err("test_data_cache: write error on '%s': %s", tmp_path, os_ErrorMsg());
+                goto done;
+            }
+            p += w; r -= w;
+        }
+    }
+    sha256_final(&ctx, digest);
+    if (close(dfd) < 0) {
+        dfd = -1;
+        err("test_data_cache: write error on '%s': %s", tmp_path, os_ErrorMsg());
+        goto done;
+    }
+    dfd = -1;
+
+    // the file must not change while it is copied
+    if (fstat(sfd, &stb2) < 0 || stb1.st_size != stb2.st_size
+        || stb1.st_mtim.tv_sec != stb2.st_mtim.tv_sec
+        || stb1.st_mtim.tv_nsec != stb2.st_mtim.tv_nsec) {
+        info("test_data_cache: '%s' is being modified", src_path);
+        goto done;
+    }
+
+    hash_to_hex(digest, e->hash);
+    make_object_path(s, e->hash, obj_path, sizeof(obj_path));
+    if (access(obj_path, R_OK) < 0) {
+        snprintf(obj_dir, sizeof(obj_dir), "%s/objects/%.2s", s->cache_dir, e->hash);
+        if (mkdir(obj_dir, 0755) < 0 && errno != EEXIST) {
+            err("test_data_cache: cannot create '%s': %s", obj_dir, os_ErrorMsg());
+            goto done;
+        }
+        if (rename(tmp_path, obj_path) < 0) {
+            err("test_data_cache: rename to '%s' failed: %s", obj_path, os_ErrorMsg());
+            goto done;
+        }
+        s->total_size += stb1.st_size;
+        if (s->total_size > s->max_size) evict_objects(s);
+    }
+
+    e->size = stb1.st_size;
+    e->mtime_ns = stb1.st_mtim.tv_sec * 1000000000LL + stb1.st_mtim.tv_nsec;
+    e->dev = stb1.st_dev;
+    e->ino = stb1.st_ino;
+    e->valid = 1;
+    retval = 0;
+
+done:;
+    if (sfd >= 0) close(sfd);
+    if (dfd >= 0) close(dfd);
+    unlink(tmp_path);
+    return retval;
+}
+
+static int
+make_source_path(
+        const struct test_data_set *ts,
+        int num,
+        unsigned char *buf,
+        size_t size)
+{
+    unsigned char name[PATH_MAX];
+    if (snprintf(name, sizeof(name), ts->pattern, num) >= sizeof(name)) return -1;
+    if (snprintf(buf, size, "%s/%s", ts->dir, name) >= size) return -1;
+    return 0;
+}
+
+/* bring a single entry up to date, returns 1 if it was changed */
+static int
+update_entry(struct test_data_cache_state *s, struct test_data_set *ts, int num)
+{
+    unsigned char path[PATH_MAX];
+    struct stat stb;
+    struct test_data_entry *e = &ts->entries[num];
+
+    if (make_source_path(ts, num, path, sizeof(path)) < 0
+        || stat(path, &stb) < 0 || !S_ISREG(stb.st_mode)) {
+        if (!e->valid) return 0;
+        e->valid = 0;
+        return 1;
+    }
+    if (e->valid && is_same_file(e, &stb)) return 0;
+    e->valid = 0;
+    store_object(s, path, e);
+    return 1;
+}
+
+static void
+update_set(struct test_data_cache_state *s, struct test_data_set *ts, long long us)
+{
+    int changed = 0;
+
+    ts->last_check_us = us;
+    if (!ts->loaded) load_manifest(s, ts);
+
+    // the file enumeration is shared with the test count cache
+    int count = test_count_cache_get(NULL, ts->dir, ts->pattern);
+    if (count < 0) {
+        ts->count = -1;
+        return;
+    }
+    reserve_entries(ts, count);
+    if (count != ts->count) changed = 1;
+    ts->count = count;
+    for (int i = 1; i <= count; ++i) {
+        changed |= update_entry(s, ts, i);
+    }
+    if (changed) save_manifest(s, ts);
+}
+
+static struct test_data_set *
+get_set(
+        struct test_data_cache_state *s,
+        const unsigned char *dir,
+        const unsigned char *pattern)
+{
+    if (!dir || !*dir || !pattern || !*pattern) return NULL;
+
+    unsigned char *key = NULL;
+    size_t key_z = 0;
+    FILE *key_f = open_memstream((char **) &key, &key_z);
+    fprintf(key_f, "%s/%s", dir, pattern);
+    fclose(key_f); key_f = NULL;
+
+    void *vidx = dyntrie_get(&s->trie, key);
+    if (!vidx) {
+        if (s->setu == s->seta) {
+            if (!(s->seta *= 2)) s->seta = 16;
+            XREALLOC(s->sets, s->seta);
+        }
+        int idx = s->setu++;
+        struct test_data_set *ts = NULL;
+        XCALLOC(ts, 1);
+        ts->dir = xstrdup(dir);
+        ts->pattern = xstrdup(pattern);
+        ts->key = key; key = NULL;
+        ts->count = -1;
+        s->sets[idx] = ts;
+        vidx = (void *) (intptr_t) idx;
+        dyntrie_insert(&s->trie, ts->key, vidx, 0, NULL);
+    }
+    free(key);
+
+    struct test_data_set *ts = s->sets[(int)(intptr_t) vidx];
+    long long us = get_current_time_us();
+    if (!ts->last_check_us || ts->last_check_us + 5000000 < us) {
+        update_set(s, ts, us);
+    }
+    return ts;
+}
+
+int
+test_data_cache_count(
+        struct test_data_cache_state *s,
+        const unsigned char *dir,
+        const unsigned char *pattern)
+{
+    if (!s) s = default_state;
+    if (!s) return -1;
+
+    struct test_data_set *ts = get_set(s, dir, pattern);
+    if (!ts) return -1;
+    return ts->count;
+}
+
+int
+test_data_cache_lookup(
+        struct test_data_cache_state *s,
+        const unsigned char *dir,
+        const unsigned char *pattern,
+        int num,
+        unsigned char *buf,
+        size_t size)
+{
+    if (!s) s = default_state;
+    if (!s) return -1;
+
+    struct test_data_set *ts = get_set(s, dir, pattern);
+    if (!ts || num <= 0 || num > ts->count) return -1;
+
+    // the file might have been changed since the last check
+    if (update_entry(s, ts, num)) save_manifest(s, ts);
+    struct test_data_entry *e = &ts->entries[num];
+    if (!e->valid) return -1;
+
+    unsigned char obj_path[PATH_MAX];
+    make_object_path(s, e->hash, obj_path, sizeof(obj_path));
+    if (access(obj_path, R_OK) < 0) {
+        // the object was removed from the cache, store it again
+        e->valid = 0;
+        if (!update_entry(s, ts, num) || !e->valid) return -1;
+        save_manifest(s, ts);
+    } else {
+        // mark as recently used
+        utimes(obj_path, NULL);
+    }
+    snprintf(buf, size, "%s", obj_path);
+    return 0;
+}
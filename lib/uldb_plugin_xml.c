@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2006-2022 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2006-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -29,9 +29,11 @@
 #include "ejudge/osdeps.h"
 #include "ejudge/xml_utils.h"
 
+#include <errno.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <zlib.h>
@@ -39,6 +41,9 @@
 // default interval to flush changes, in seconds
 #define DEFAULT_FLUSH_INTERVAL 600
 #define DEFAULT_BACKUP_INTERVAL (24*60*60)
+// the journal is merged into the database when it is larger than
+// the database and this size
+#define JOURNAL_COMPACT_SIZE (4*1024*1024)
 
 static struct common_plugin_data *init_func(void);
 static int finish_func(struct common_plugin_data *);
@@ -379,6 +384,12 @@ struct uldb_xml_state
   time_t last_backup_time;
   int backup_interval;
   struct userlist_list *userlist;
+
+  // the changes of the users since the last flush
+  unsigned char *journal_path;
+  int journal_fd;
+  long long journal_size;
+  long long db_size;
 };
 
 struct user_id_iterator
@@ -446,12 +457,205 @@ userlist_clone_member(
         int *p_serial,
         time_t current_time);
 
+/*
+ * The journal is a sequence of records "T USER_ID MEMBER_SERIAL SIZE\n"
+ * followed by SIZE bytes of data, where T is one of
+ *   U - the complete XML of the user, which replaces the old one
+ *   R - the user is removed
+ *   S - only the member serial is changed
+ * The journal is truncated each time the database is flushed.
+ */
+
+/* appends the current state of the user to the journal,
+   falls back to the flush of the complete database */
+static void
+journal_user(struct uldb_xml_state *state, int user_id)
+{
+  struct userlist_list *ul = state->userlist;
+  const struct userlist_user *u = 0;
+  char *text = 0;
+  size_t size = 0;
+  FILE *f;
+  char hdr[128];
+  int type = 'S';
+  struct iovec iov[2];
+  ssize_t w, total;
+
+  if (state->journal_fd < 0) goto fail;
+
+  if (user_id > 0) {
+    type = 'R';
+    if (user_id < ul->user_map_size && (u = ul->user_map[user_id]))
+      type = 'U';
+  }
+  if (u) {
+    if (!(f = open_memstream(&text, &size))) goto fail;
+    userlist_unparse_user(u, f, USERLIST_MODE_ALL, -1,
+                          USERLIST_SHOW_REG_PASSWD | USERLIST_SHOW_CNTS_PASSWD);
+    close_memstream(f);
+  }
+  iov[0].iov_base = hdr;
+  iov[0].iov_len = snprintf(hdr, sizeof(hdr), "%c %d %d %zu\n",
+                            type, user_id, ul->member_serial, size);
+  iov[1].iov_base = text;
+  iov[1].iov_len = size;
+  total = iov[0].iov_len + iov[1].iov_len;
+
+  // a single write, so a crash may only leave a truncated last record
+  while ((w = writev(state->journal_fd, iov, 2)) < 0 && errno == EINTR);
+  if (w != total) {
+    if (w < 0) err("journal: write failed: %s", os_ErrorMsg());
+    else err("journal: short write");
+    if (ftruncate(state->journal_fd, state->journal_size) < 0) {
+      err("journal: ftruncate failed: %s", os_ErrorMsg());
+    }
+    goto fail;
+  }
+  state->journal_size += total;
+  xfree(text);
+  return;
+
+fail:
+  xfree(text);
+  state->dirty = 1;
+  state->flush_interval /= 2;
+}
+
+static void
+journal_replace_user(struct userlist_list *ul, struct userlist_user *u)
+{
+  struct userlist_user *old, **new_map;
+  size_t new_size;
+
+  if (u->id >= ul->user_map_size) {
+    new_size = ul->user_map_size;
+    if (!new_size) new_size = 16;
+    while (u->id >= new_size) new_size *= 2;
+    new_map = (struct userlist_user**) xcalloc(new_size, sizeof(new_map[0]));
+    if (ul->user_map_size > 0)
+      memcpy(new_map, ul->user_map, ul->user_map_size * sizeof(new_map[0]));
+    xfree(ul->user_map);
+    ul->user_map = new_map;
+    ul->user_map_size = new_size;
+  }
+  if ((old = ul->user_map[u->id])) {
+    // group membership is not stored in the user
+    u->group_first = old->group_first;
+    u->group_last = old->group_last;
+    userlist_remove_user(ul, old);
+  }
+  xml_link_node_last(&ul->b, &u->b);
+  ul->user_map[u->id] = u;
+}
+
+/* applies the journal to the loaded database */
+static int
+replay_journal(struct uldb_xml_state *state)
+{
+  struct userlist_list *ul = state->userlist;
+  struct userlist_user *u;
+  FILE *f;
+  char hdr[128];
+  char type;
+  int user_id, serial, n, count = 0, retval = -1;
+  size_t size;
+  unsigned char *text = 0;
+  long good_size = 0, pos;
+  struct stat stb;
+
+  if (!(f = fopen(state->journal_path, "r"))) {
+    if (errno == ENOENT) return 0;
+    err("journal: cannot open %s: %s", state->journal_path, os_ErrorMsg());
+    return -1;
+  }
+  if (fstat(fileno(f), &stb) < 0) {
+    err("journal: fstat failed: %s", os_ErrorMsg());
+    goto cleanup;
+  }
+
+  while (fgets(hdr, sizeof(hdr), f)) {
+    n = 0;
+    if (!strchr(hdr, '\n')) {
+      // only the last record may be incomplete
+      if (feof(f)) break;
+      err("journal: %s: invalid record at %ld", state->journal_path, good_size);
+      goto cleanup;
+    }
+    if (sscanf(hdr, "%c %d %d %zu %n", &type, &user_id, &serial, &size, &n) != 4
+        || hdr[n] || user_id < 0 || serial < 0
+        || (type != 'U' && type != 'R' && type != 'S')
+        || (type != 'U' && size)) {
+      err("journal: %s: invalid record at %ld", state->journal_path, good_size);
+      goto cleanup;
+    }
+    pos = ftell(f);
+    if (size > stb.st_size - pos) {
+      // the last record is incomplete
+      break;
+    }
+    text = xmalloc(size + 1);
+    if (fread(text, 1, size, f) != size) {
+      err("journal: %s: read error at %ld", state->journal_path, pos);
+      goto cleanup;
+    }
+    text[size] = 0;
+
+    if (type == 'U') {
+      if (!(u = userlist_parse_user_str(text)) || u->id != user_id) {
+        err("journal: %s: invalid user at %ld", state->journal_path, good_size);
+        if (u) userlist_free(&u->b);
+        goto cleanup;
+      }
+      journal_replace_user(ul, u);
+    } else if (type == 'R') {
+      if (user_id > 0 && user_id < ul->user_map_size && ul->user_map[user_id])
+        userlist_remove_user(ul, ul->user_map[user_id]);
+    }
+    if (serial > ul->member_serial) ul->member_serial = serial;
+    xfree(text); text = 0;
+    good_size = ftell(f);
+    ++count;
+  }
+
+  if (good_size < stb.st_size) {
+    // the last record is incomplete
+    err("journal: %s: truncated at %ld", state->journal_path, good_size);
+    if (truncate(state->journal_path, good_size) < 0) {
+      err("journal: truncate failed: %s", os_ErrorMsg());
+      goto cleanup;
+    }
+  }
+  if (count > 0) {
+    info("journal: %d records are applied from %s", count, state->journal_path);
+  }
+  state->journal_size = good_size;
+  retval = 0;
+
+cleanup:
+  xfree(text);
+  fclose(f);
+  return retval;
+}
+
+static int
+open_journal(struct uldb_xml_state *state)
+{
+  state->journal_fd = open(state->journal_path,
+                           O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+  if (state->journal_fd < 0) {
+    err("journal: cannot open %s: %s", state->journal_path, os_ErrorMsg());
+    return -1;
+  }
+  return 0;
+}
+
 static struct common_plugin_data *
 init_func(void)
 {
   struct uldb_xml_state *state;
 
   XCALLOC(state, 1);
+  state->journal_fd = -1;
   return (struct common_plugin_data*) state;
 }
 
@@ -474,6 +678,8 @@ prepare_func(
     return -1;
   }
   state->db_path = xstrdup(ej_cfg->db_path);
+  state->journal_path = xmalloc(strlen(state->db_path) + 16);
+  sprintf(state->journal_path, "%s.journal", state->db_path);
 
   return 0;
 }
@@ -527,6 +733,10 @@ check_func(void *data)
   // load the XML
   if (!(state->userlist = userlist_parse(state->db_path)))
     return -1;
+  state->db_size = stb.st_size;
+  if (replay_journal(state) < 0)
+    return -1;
+  open_journal(state);
 
   state->flush_interval = DEFAULT_FLUSH_INTERVAL;
   state->last_flush_time = time(0);
@@ -549,6 +759,9 @@ create_func(void *data)
   state->flush_interval = 0;
   state->last_flush_time = 0;
   state->dirty = 1;
+  // the changes of the previous database are irrelevant
+  unlink(state->journal_path);
+  open_journal(state);
 
   return 1;
 }
@@ -576,10 +789,12 @@ flush_database(struct uldb_xml_state *state)
   fd = -1;
 
   userlist_unparse(state->userlist, f);
+  fflush(f);
   if (ferror(f)) {
     err("bdflush: write failed: %s", os_ErrorMsg());
     goto failed;
   }
+  state->db_size = ftell(f);
   if (fclose(f) < 0) {
     err("bdflush: fclose() failed: %s", os_ErrorMsg());
     f = NULL;
@@ -592,6 +807,12 @@ flush_database(struct uldb_xml_state *state)
     goto failed;
   }
 
+  // all the journaled changes are in the database now
+  if (state->journal_fd >= 0 && ftruncate(state->journal_fd, 0) < 0) {
+    err("bdflush: journal ftruncate() failed: %s", os_ErrorMsg());
+  }
+  state->journal_size = 0;
+
   state->last_flush_time = time(0);
   state->flush_interval = DEFAULT_FLUSH_INTERVAL;
   state->dirty = 0;
@@ -611,11 +832,14 @@ close_func(void *data)
   struct uldb_xml_state *state = (struct uldb_xml_state*) data;
 
   // ensure success on saving
+  if (state->journal_size > 0) state->dirty = 1;
   while (state->dirty) {
     flush_database(state);
     if (!state->dirty) break;
     sleep(10);
   }
+  if (state->journal_fd >= 0) close(state->journal_fd);
+  state->journal_fd = -1;
 
   return 0;
 }
@@ -730,6 +954,7 @@ sync_func(void *data)
 {
   struct uldb_xml_state *state = (struct uldb_xml_state*) data;
 
+  if (state->journal_size > 0) state->dirty = 1;
   state->flush_interval = 0;
 }
 
@@ -841,8 +1066,7 @@ new_user_func(
   }
 
   u->registration_time = time(0);
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, u->id);
 
   return u->id;
 }
@@ -865,7 +1089,7 @@ remove_user_func(void *data, int user_id)
     }
   }
   userlist_remove_user(ul, u);
-  state->dirty = 1;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -976,7 +1200,7 @@ new_cookie_func(
 
   if (p_cookie) *p_cookie = c;
 
-  state->dirty = 1;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1052,31 +1276,42 @@ new_cookie_2_func(
 
   if (p_cookie) *p_cookie = c;
 
-  state->dirty = 1;
+  journal_user(state, user_id);
   return 0;
 }
 
+static void
+do_remove_cookie(
+        struct userlist_list *ul,
+        struct userlist_user *u,
+        const struct userlist_cookie *cookie)
+{
+  struct xml_tree *p = (struct xml_tree*) cookie;
+
+  userlist_cookie_hash_del(ul, cookie);
+  xml_unlink_node(p);
+  userlist_free(p);
+  if (!u->cookies->first_down) {
+    xml_unlink_node(u->cookies);
+    userlist_free(u->cookies);
+    u->cookies = 0;
+  }
+}
+
 static int
 remove_cookie_func(void *data, const struct userlist_cookie *cookie)
 {
   struct uldb_xml_state *state = (struct uldb_xml_state*) data;
   struct userlist_list *ul = state->userlist;
   struct userlist_user *u;
-  struct xml_tree *p = (struct xml_tree*) cookie;
 
   if (cookie->user_id <= 0 || cookie->user_id >= ul->user_map_size
       || !(u = ul->user_map[cookie->user_id])) {
     return -1;
   }
 
-  userlist_cookie_hash_del(ul, cookie);
-  xml_unlink_node(p);
-  userlist_free(p);
-  if (!u->cookies->first_down) {
-    xml_unlink_node(u->cookies);
-    userlist_free(u->cookies);
-    u->cookies = 0;
-  }
+  do_remove_cookie(ul, u, cookie);
+  journal_user(state, u->id);
   return 0;
 }
 
@@ -1103,6 +1338,7 @@ remove_user_cookies_func(void *data, int user_id)
   xml_unlink_node(u->cookies);
   userlist_free(u->cookies);
   u->cookies = 0;
+  journal_user(state, user_id);
   return count;
 }
 
@@ -1114,7 +1350,7 @@ remove_expired_cookies_func(void *data, time_t cur_time)
   struct userlist_user *u;
   struct xml_tree *p, *q;
   struct userlist_cookie *c;
-  int count = 0, user_id;
+  int count = 0, user_id, removed;
 
   if (cur_time <= 0) cur_time = time(0);
 
@@ -1122,6 +1358,7 @@ remove_expired_cookies_func(void *data, time_t cur_time)
     if (!(u = ul->user_map[user_id])) continue;
     if (!u->cookies) continue;
 
+    removed = 0;
     for (p = u->cookies->first_down; p; p = q) {
       q = p->right;
       c = (struct userlist_cookie*) p;
@@ -1134,9 +1371,12 @@ remove_expired_cookies_func(void *data, time_t cur_time)
           }
 
        */
-      remove_cookie_func(data, c);
-      count++;
+      do_remove_cookie(ul, u, c);
+      removed++;
     }
+    // one journal record for all the cookies of the user
+    if (removed > 0) journal_user(state, user_id);
+    count += removed;
   }
   return count;
 }
@@ -1264,7 +1504,7 @@ touch_login_time_func(void *data, int user_id, int contest_id, time_t cur_time)
                                   0);
     if (ui) ui->last_login_time = cur_time;
   }
-  state->dirty = 1;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1312,7 +1552,7 @@ set_cookie_contest_func(void *data,
 
   if (cc->contest_id != contest_id) {
     cc->contest_id = contest_id;
-    state->dirty = 1;
+    journal_user(state, cc->user_id);
   }
   return 0;
 }
@@ -1327,7 +1567,7 @@ set_cookie_locale_func(void *data,
 
   if (cc->locale_id != locale_id) {
     cc->locale_id = locale_id;
-    state->dirty = 1;
+    journal_user(state, cc->user_id);
   }
   return 0;
 }
@@ -1342,7 +1582,7 @@ set_cookie_priv_level_func(void *data,
 
   if (cc->priv_level != priv_level) {
     cc->priv_level = priv_level;
-    state->dirty = 1;
+    journal_user(state, cc->user_id);
   }
   return 0;
 }
@@ -1358,7 +1598,7 @@ set_cookie_team_login_func(
 
   if (cc->team_login != team_login) {
     cc->team_login = team_login;
-    state->dirty = 1;
+    journal_user(state, cc->user_id);
   }
   return 0;
 }
@@ -1587,8 +1827,7 @@ set_reg_passwd_func(void *data, int user_id,
   u->passwd_method = method;
   if (cur_time <= 0) cur_time = time(0);
   u->last_pwdchange_time = cur_time;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1621,8 +1860,7 @@ set_team_passwd_func(void *data, int user_id, int contest_id,
   ui->team_passwd = xstrdup(password);
   ui->team_passwd_method = method;
   ui->last_pwdchange_time = cur_time;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1666,8 +1904,7 @@ register_contest_func(void *data,
   c->flags = flags;
   c->create_time = cur_time;
 
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   if (p_c) *p_c = c;
 
   return 1;
@@ -1749,8 +1986,7 @@ remove_member_func(void *data, int user_id, int contest_id,
   */
 
   ui->last_change_time = cur_time;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1877,8 +2113,7 @@ clear_team_passwd_func(void *data, int user_id, int contest_id,
 
   xfree(ui->team_passwd); ui->team_passwd = 0;
   ui->team_passwd_method = 0;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1906,8 +2141,7 @@ remove_registration_func(void *data, int user_id, int contest_id)
   xml_unlink_node(t);
   userlist_free(t);
 
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1929,8 +2163,7 @@ set_reg_status_func(void *data, int user_id, int contest_id, int status)
 
   if (status == c->status) return 0;
   c->status = status;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 1;
 }
 
@@ -1962,8 +2195,7 @@ set_reg_flags_func(void *data, int user_id, int contest_id, int cmd,
   if (new_value == c->flags) return 0;
 
   c->flags = new_value;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 1;
 }
 
@@ -1985,8 +2217,7 @@ remove_user_contest_info_func(void *data, int user_id, int contest_id)
     userlist_free(&uc->b);
   }
 
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 1;
 }
 
@@ -2009,8 +2240,7 @@ clear_user_field_func(void *data, int user_id, int field_id, time_t cur_time)
   if ((r = userlist_delete_user_field(u, field_id)) == 1) {
     if (field_id == USERLIST_NN_PASSWD) u->last_pwdchange_time = cur_time;
     else u->last_change_time = cur_time;
-    state->dirty = 1;
-    state->flush_interval /= 2;
+    journal_user(state, user_id);
   }
   return r;
 }
@@ -2045,8 +2275,7 @@ clear_user_info_field_func(void *data, int user_id, int contest_id,
   if ((r = userlist_delete_user_info_field(ui, field_id)) == 1) {
     if (field_id == USERLIST_NC_TEAM_PASSWD) ui->last_pwdchange_time = cur_time;
     else ui->last_change_time = cur_time;
-    state->dirty = 1;
-    state->flush_interval /= 2;
+    journal_user(state, user_id);
   }
   return r;
 }
@@ -2083,8 +2312,7 @@ clear_user_member_field_func(void *data, int user_id, int contest_id,
 
   if ((r = userlist_delete_member_field(m, field_id)) == 1) {
     m->last_change_time = cur_time;
-    state->dirty = 1;
-    state->flush_interval /= 2;
+    journal_user(state, user_id);
   }
   return r;
 }
@@ -2124,8 +2352,7 @@ set_user_field_func(void *data,
     if (field_id == USERLIST_NN_LOGIN) userlist_build_login_hash(ul);
     if (field_id == USERLIST_NN_PASSWD) u->last_pwdchange_time = cur_time;
     else u->last_change_time = cur_time;
-    state->dirty = 1;
-    state->flush_interval /= 2;
+    journal_user(state, user_id);
   }
   return r;
 }
@@ -2165,8 +2392,7 @@ set_user_info_field_func(void *data,
   if ((r = userlist_set_user_info_field_str(ui, field_id, value)) == 1) {
     if (field_id == USERLIST_NC_TEAM_PASSWD) ui->last_pwdchange_time = cur_time;
     else ui->last_change_time = cur_time;
-    state->dirty = 1;
-    state->flush_interval /= 2;
+    journal_user(state, user_id);
   }
   return r;
 }
@@ -2209,8 +2435,7 @@ set_user_member_field_func(void *data,
 
   if ((r = userlist_set_member_field_str(m, field_id, value)) == 1) {
     m->last_change_time = cur_time;
-    state->dirty = 1;
-    state->flush_interval /= 2;
+    journal_user(state, user_id);
   }
   return r;
 }
@@ -2277,8 +2502,7 @@ new_member_func(void *data, int user_id, int contest_id, int role,
   }
   mm->m[mm->u++] = m;
 
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return m->serial;
 }
 
@@ -2365,6 +2589,11 @@ maintenance_func(void *data, time_t cur_time)
     do_backup(state, cur_time);
   }
 
+  if (state->journal_size >= JOURNAL_COMPACT_SIZE
+      && state->journal_size >= state->db_size) {
+    state->dirty = 1;
+    state->flush_interval = 0;
+  }
   if (cur_time > state->last_flush_time + state->flush_interval) {
     flush_database(state);
   }
@@ -2439,8 +2668,7 @@ set_user_xml_func(void *data,
   // update the user's fields
   new_ui = new_u->cnts0;
   if (!new_ui) {
-    state->dirty = 1;
-    state->flush_interval /= 2;
+    journal_user(state, user_id);
     return 1;
   }
 
@@ -2702,8 +2930,7 @@ set_user_xml_func(void *data,
   }
 
   // FIXME: properly set the change flag?
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 1;
 }
 
@@ -2882,8 +3109,7 @@ copy_user_info_func(
   }
 
   ui_to->last_change_time = cur_time;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -2918,23 +3144,20 @@ check_user_reg_data_func(void *data, int user_id, int contest_id)
     if ((c->flags & USERLIST_UC_INCOMPLETE)) {
       cm = (struct userlist_contest*) c;
       cm->flags &= ~USERLIST_UC_INCOMPLETE;
-      state->dirty = 1;
-      state->flush_interval /= 2;
+      journal_user(state, user_id);
       return 1;
     }
   } else {
     if (!nerr && (c->flags & USERLIST_UC_INCOMPLETE)) {
       cm = (struct userlist_contest*) c;
       cm->flags &= ~USERLIST_UC_INCOMPLETE;
-      state->dirty = 1;
-      state->flush_interval /= 2;
+      journal_user(state, user_id);
       return 1;
     } else if (nerr > 0 && !(c->flags & USERLIST_UC_INCOMPLETE)
                && (!ui || !ui->cnts_read_only)) {
       cm = (struct userlist_contest*) c;
       cm->flags |= USERLIST_UC_INCOMPLETE;
-      state->dirty = 1;
-      state->flush_interval /= 2;
+      journal_user(state, user_id);
       return 1;
     }
   }
@@ -2995,8 +3218,7 @@ move_member_func(
   m->team_role = new_role;
 
   ui->last_change_time = cur_time;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -3288,7 +3510,7 @@ set_member_serial_func(void *data, int new_serial)
   if (ul->member_serial > new_serial) return -1;
   if (ul->member_serial == new_serial) return 0;
   ul->member_serial = new_serial;
-  state->dirty = 1;
+  journal_user(state, 0);
   return 1;
 }
 
@@ -3336,8 +3558,7 @@ set_simple_reg_func(
   u->simple_registration = value;
   if (cur_time <= 0) cur_time = time(0);
   u->last_change_time = cur_time;
-  state->dirty = 1;
-  state->flush_interval /= 2;
+  journal_user(state, user_id);
   return 0;
 }
 
@@ -1,6 +1,6 @@
 /* -*- mode: c -*- */
 
-/* Copyright (C) 2017 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2017-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -363,6 +363,8 @@ userlist_bin_marshall(
     header->max_user_id = cntx->max_user_id;
     header->root_offset = cntx->root_offset;
     header->contest_id = contest_id;
+    header->removed_count = cntx->removed_u;
+    header->removed_offset = cntx->removed_offset;
     memcpy(header->data, cntx->d.v, cntx->d.u);
     memcpy(header->data + cntx->d.u, cntx->s.v, cntx->s.u);
     return header;
@@ -379,6 +381,19 @@ userlist_bin_marshall_user_list(
     cntx->root_offset = make_offset(cntx, dul);
 }
 
+void
+userlist_bin_marshall_removed(
+        UserlistBinaryContext *cntx,
+        int user_id)
+{
+    if (user_id <= 0) return;
+    if (cntx->removed_u == cntx->removed_a) {
+        if (!(cntx->removed_a *= 2)) cntx->removed_a = 64;
+        XREALLOC(cntx->removed, cntx->removed_a);
+    }
+    cntx->removed[cntx->removed_u++] = user_id;
+}
+
 void
 userlist_bin_finish_context(
         UserlistBinaryContext *cntx)
@@ -401,6 +416,11 @@ userlist_bin_finish_context(
         // fix link pointers
         ul->user_map = make_offset_ptr(cntx, ul->user_map);
     }
+    if (cntx->removed_u > 0) {
+        int32_t *removed = ulalloc(cntx, cntx->removed_u * sizeof(removed[0]));
+        memcpy(removed, cntx->removed, cntx->removed_u * sizeof(removed[0]));
+        cntx->removed_offset = make_offset(cntx, removed);
+    }
     cntx->total_size = sizeof(UserlistBinaryHeader) + cntx->d.u + cntx->s.u;
 }
 
@@ -411,6 +431,7 @@ userlist_bin_destroy_context(
     xfree(cntx->d.v);
     xfree(cntx->s.v);
     xfree(cntx->user_offsets);
+    xfree(cntx->removed);
 }
 
 /* FIXME: unmarshaller should check all fields */
@@ -573,3 +594,10 @@ userlist_bin_get_root(const UserlistBinaryHeader *header)
 {
     return (const struct userlist_list *) (header->data + header->root_offset);
 }
+
+const int32_t *
+userlist_bin_get_removed(const UserlistBinaryHeader *header)
+{
+    if (!header->removed_count) return NULL;
+    return (const int32_t *) (header->data + header->removed_offset);
+}
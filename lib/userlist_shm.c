@@ -0,0 +1,234 @@
+/* -*- mode: c -*- */
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "ejudge/userlist_shm.h"
+#include "ejudge/userlist_bin.h"
+#include "ejudge/errlog.h"
+#include "ejudge/osdeps.h"
+#include "ejudge/sha256utils.h"
+#include "ejudge/xalloc.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+/*
+ * The image of each contest is written to a temporary file and
+ * renamed over the previous one, so a published file is never modified.
+ * The pointers are restored in a private mapping, thus only the pages
+ * of the structured data are copied, the strings stay shared.
+ * The directory is specific to the userlist server socket, so several
+ * ejudge installations under the same user do not share the images.
+ */
+
+static void
+make_shm_dir(unsigned char *buf, size_t size, const unsigned char *socket_path)
+{
+  char hash[64];
+
+  if (!socket_path) socket_path = "";
+  sha256b64ubuf(hash, sizeof(hash), socket_path, strlen(socket_path));
+  snprintf(buf, size, "/dev/shm/ejudge-userlist-%d-%s", (int) geteuid(), hash);
+}
+
+/* the directory must be private to the ejudge user */
+static int
+check_shm_dir(const unsigned char *dir, int create_flag)
+{
+  struct stat stb;
+
+  if (create_flag && mkdir(dir, 0700) < 0 && errno != EEXIST) {
+    err("userlist_shm: cannot create '%s': %s", dir, os_ErrorMsg());
+    return -1;
+  }
+  if (lstat(dir, &stb) < 0) {
+    if (create_flag) err("userlist_shm: '%s' does not exist", dir);
+    return -1;
+  }
+  if (!S_ISDIR(stb.st_mode) || stb.st_uid != geteuid()
+      || (stb.st_mode & 077)) {
+    err("userlist_shm: '%s' has invalid type, owner or permissions", dir);
+    return -1;
+  }
+  return 0;
+}
+
+int
+userlist_shm_publish(
+        const unsigned char *socket_path,
+        const UserlistBinaryHeader *header)
+{
+  unsigned char dir[PATH_MAX];
+  unsigned char path[PATH_MAX];
+  unsigned char tmp_path[PATH_MAX];
+  const unsigned char *ptr = (const unsigned char *) header;
+  size_t size = header->pkt_size;
+  ssize_t w;
+  int fd;
+
+  make_shm_dir(dir, sizeof(dir), socket_path);
+  if (check_shm_dir(dir, 1) < 0) return -1;
+  snprintf(path, sizeof(path), "%s/%d.bin", dir, header->contest_id);
+  snprintf(tmp_path, sizeof(tmp_path), "%s/%d.bin.tmp", dir, header->contest_id);
+
+  fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW, 0600);
+  if (fd < 0) {
+    err("userlist_shm: cannot create '%s': %s", tmp_path, os_ErrorMsg());
+    return -1;
+  }
+  while (size > 0) {
+    if ((w = write(fd, ptr, size)) < 0) {
+      if (errno == EINTR) continue;
+      err("userlist_shm: write to '%s' failed: %s", tmp_path, os_ErrorMsg());
+      goto fail;
+    }
+    ptr += w;
+    size -= w;
+  }
+  if (close(fd) < 0) {
+    fd = -1;
+    err("userlist_shm: close of '%s' failed: %s", tmp_path, os_ErrorMsg());
+    goto fail;
+  }
+  fd = -1;
+  if (rename(tmp_path, path) < 0) {
+    err("userlist_shm: rename to '%s' failed: %s", path, os_ErrorMsg());
+    goto fail;
+  }
+  return 0;
+
+fail:
+  if (fd >= 0) close(fd);
+  unlink(tmp_path);
+  return -1;
+}
+
+/* maps the image of the contest not older than vintage */
+UserlistBinaryHeader *
+userlist_shm_map(
+        const unsigned char *socket_path,
+        int contest_id,
+        unsigned long long vintage)
+{
+  unsigned char dir[PATH_MAX];
+  unsigned char path[PATH_MAX];
+  struct stat stb;
+  UserlistBinaryHeader *header;
+  void *ptr;
+  int fd;
+
+  make_shm_dir(dir, sizeof(dir), socket_path);
+  if (check_shm_dir(dir, 0) < 0) return NULL;
+  snprintf(path, sizeof(path), "%s/%d.bin", dir, contest_id);
+
+  if ((fd = open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW, 0)) < 0) {
+    err("userlist_shm: cannot open '%s': %s", path, os_ErrorMsg());
+    return NULL;
+  }
+  if (fstat(fd, &stb) < 0) {
+    err("userlist_shm: fstat failed: %s", os_ErrorMsg());
+    close(fd);
+    return NULL;
+  }
+  if (!S_ISREG(stb.st_mode) || stb.st_uid != geteuid()
+      || stb.st_size < (off_t) sizeof(*header) || stb.st_size > 0x7fffffff) {
+    err("userlist_shm: '%s' is invalid", path);
+    close(fd);
+    return NULL;
+  }
+  ptr = mmap(NULL, stb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    err("userlist_shm: mmap of '%s' failed: %s", path, os_ErrorMsg());
+    return NULL;
+  }
+  header = ptr;
+
+  if (header->version != USERLIST_BIN_VERSION || header->endianness != 1
+      || header->ptr_size != sizeof(void*)
+      || header->pkt_size != stb.st_size
+      || header->size > stb.st_size - sizeof(*header)
+      || header->root_offset >= header->struct_size
+      || header->contest_id != contest_id
+      || (header->flags & (USERLIST_BIN_DELTA | USERLIST_BIN_SNAPSHOT))) {
+    err("userlist_shm: '%s' has invalid header", path);
+    munmap(ptr, stb.st_size);
+    return NULL;
+  }
+  if (header->vintage < vintage) {
+    err("userlist_shm: '%s' is out of date: %llu < %llu", path,
+        (unsigned long long) header->vintage, vintage);
+    munmap(ptr, stb.st_size);
+    return NULL;
+  }
+  header->flags |= USERLIST_BIN_MAPPED;
+  userlist_bin_unmarshall(header);
+  return header;
+}
+
+void
+userlist_shm_remove(const unsigned char *socket_path, int contest_id)
+{
+  unsigned char dir[PATH_MAX];
+  unsigned char path[PATH_MAX];
+
+  make_shm_dir(dir, sizeof(dir), socket_path);
+  snprintf(path, sizeof(path), "%s/%d.bin", dir, contest_id);
+  if (unlink(path) < 0 && errno != ENOENT) {
+    err("userlist_shm: cannot remove '%s': %s", path, os_ErrorMsg());
+  }
+}
+
+void
+userlist_shm_remove_all(const unsigned char *socket_path)
+{
+  unsigned char dir[PATH_MAX];
+  unsigned char path[PATH_MAX];
+  DIR *d;
+  struct dirent *dd;
+
+  make_shm_dir(dir, sizeof(dir), socket_path);
+  if (!(d = opendir(dir))) return;
+  while ((dd = readdir(d))) {
+    if (!strcmp(dd->d_name, ".") || !strcmp(dd->d_name, "..")) continue;
+    snprintf(path, sizeof(path), "%s/%s", dir, dd->d_name);
+    if (unlink(path) < 0) {
+      err("userlist_shm: cannot remove '%s': %s", path, os_ErrorMsg());
+    }
+  }
+  closedir(d);
+  if (rmdir(dir) < 0 && errno != ENOENT) {
+    err("userlist_shm: cannot remove '%s': %s", dir, os_ErrorMsg());
+  }
+}
+
+void
+userlist_shm_free(UserlistBinaryHeader *header)
+{
+  if (!header) return;
+  if ((header->flags & USERLIST_BIN_MAPPED)) {
+    munmap(header, header->pkt_size);
+  } else {
+    xfree(header);
+  }
+}
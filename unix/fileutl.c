@@ -1,6 +1,6 @@
 /* -*- c -*- */
 
-/* Copyright (C) 2000-2017 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2000-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or
@@ -31,11 +31,17 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#include <time.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
 #include <stdio.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <zlib.h>
 #include <paths.h>
+#include <linux/fs.h>
 
 #if HAVE_FERROR_UNLOCKED - 0 == 0
 #define ferror_unlocked(x) ferror(x)
@@ -146,162 +152,525 @@ make_all_dir(char const *path, int access)
   return 0;
 }
 
-struct ignored_items
+/* A spool directory is kept in memory between the calls to scan_dir:
+   the names are grouped by priority, each group is a heap ordered by name.
+   The directory is rescanned only when inotify reports an overflow or,
+   if inotify is not available, when the directory has been modified.
+   All the queues of a process share one inotify instance with a watch
+   per directory, as the number of instances per user is limited.
+ */
+enum { SPOOL_PRIO_COUNT = 32 };
+
+struct spool_entry
+{
+  struct spool_entry *next;     /* hash chain */
+  unsigned char *name;
+  unsigned char prio;
+  unsigned char present;        /* the file exists in the directory */
+  unsigned char ignored;
+  unsigned char in_heap;
+};
+
+struct spool_heap
 {
-  unsigned char *dir;
   size_t a, u;
-  unsigned char **items;
+  struct spool_entry **v;
 };
-static struct ignored_items *ign;
-static size_t ign_a, ign_u;
 
-void
-scan_dir_add_ignored(const unsigned char *dir, const unsigned char *filename)
+struct spool_queue
 {
-  int i;
-  struct ignored_items *cur_ign = 0;
+  unsigned char *dir;
+  path_t dir_path;
+  int notify_wd;                /* inotify watch, -1 if not available */
+  int need_rescan;
+  int notified;                 /* an event has been seen for this queue */
+  struct timespec last_mtime;   /* used without inotify */
+  time_t last_scan;
+  size_t hash_size, entry_count;
+  struct spool_entry **hash;
+  struct spool_heap heaps[SPOOL_PRIO_COUNT];
+};
 
-  if (!dir || !*dir) return;
-  for (i = 0; i < ign_u; i++)
-    if (!strcmp(dir, ign[i].dir))
-      break;
-  if (i == ign_u) {
-    if (ign_u == ign_a) {
-      if (!ign_a) ign_a = 4;
-      ign_a *= 2;
-      XREALLOC(ign, ign_a);
+static struct spool_queue **spool_queues;
+static size_t spool_queue_a, spool_queue_u;
+static int spool_notify_fd = -1;
+static pid_t spool_notify_pid;
+
+static int
+spool_name_prio(const unsigned char *name)
+{
+  int prio;
+
+  /* if (strlen(de->d_name) != EJ_SERVE_PACKET_NAME_SIZE - 1) {
+    prio = 0;
+    } else */
+  if (name[0] >= '0' && name[0] <= '9') {
+    prio = -16 + (name[0] - '0');
+  } else if (name[0] >= 'A' && name[0] <= 'V') {
+    prio = -6 + (name[0] - 'A');
+  } else {
+    prio = 0;
+  }
+  if (prio < -16) prio = -16;
+  if (prio > 15) prio = 15;
+  return prio + 16;
+}
+
+static size_t
+spool_name_hash(const unsigned char *name)
+{
+  size_t h = 5381;
+  for (; *name; ++name) h = h * 33 + *name;
+  return h;
+}
+
+static struct spool_entry *
+spool_entry_find(struct spool_queue *q, const unsigned char *name)
+{
+  struct spool_entry *e;
+
+  if (!q->hash_size) return NULL;
+  for (e = q->hash[spool_name_hash(name) & (q->hash_size - 1)]; e; e = e->next) {
+    if (!strcmp(e->name, name)) return e;
+  }
+  return NULL;
+}
+
+static struct spool_entry *
+spool_entry_add(struct spool_queue *q, const unsigned char *name)
+{
+  struct spool_entry *e, *next, **new_hash;
+  size_t new_size, i, h;
+
+  if ((e = spool_entry_find(q, name))) return e;
+
+  if (q->entry_count >= q->hash_size) {
+    new_size = q->hash_size * 2;
+    if (!new_size) new_size = 256;
+    XCALLOC(new_hash, new_size);
+    for (i = 0; i < q->hash_size; ++i) {
+      for (e = q->hash[i]; e; e = next) {
+        next = e->next;
+        h = spool_name_hash(e->name) & (new_size - 1);
+        e->next = new_hash[h];
+        new_hash[h] = e;
+      }
     }
-    memset(&ign[ign_u], 0, sizeof(ign[0]));
-    ign[ign_u++].dir = xstrdup(dir);
+    xfree(q->hash);
+    q->hash = new_hash;
+    q->hash_size = new_size;
   }
-  cur_ign = &ign[i];
 
-  if (!filename || !*filename) return;
-  for (i = 0; i < cur_ign->u; i++)
-    if (!strcmp(filename, cur_ign->items[i]))
-      return;
+  XCALLOC(e, 1);
+  e->name = xstrdup(name);
+  e->prio = spool_name_prio(name);
+  h = spool_name_hash(name) & (q->hash_size - 1);
+  e->next = q->hash[h];
+  q->hash[h] = e;
+  ++q->entry_count;
+  return e;
+}
+
+static void
+spool_entry_free(struct spool_queue *q, struct spool_entry *e)
+{
+  struct spool_entry **pp;
+
+  for (pp = &q->hash[spool_name_hash(e->name) & (q->hash_size - 1)];
+       *pp && *pp != e; pp = &(*pp)->next);
+  ASSERT(*pp);
+  *pp = e->next;
+  --q->entry_count;
+  xfree(e->name);
+  xfree(e);
+}
 
-  if (cur_ign->u == cur_ign->a) {
-    if (!cur_ign->a) cur_ign->a = 8;
-    cur_ign->a *= 2;
-    XREALLOC(cur_ign->items, cur_ign->a);
+static void
+spool_heap_push(struct spool_heap *hp, struct spool_entry *e)
+{
+  size_t i, p;
+
+  if (hp->u == hp->a) {
+    if (!(hp->a *= 2)) hp->a = 16;
+    XREALLOC(hp->v, hp->a);
+  }
+  i = hp->u++;
+  while (i > 0) {
+    p = (i - 1) / 2;
+    if (strcmp(hp->v[p]->name, e->name) <= 0) break;
+    hp->v[i] = hp->v[p];
+    i = p;
   }
-  cur_ign->items[cur_ign->u++] = xstrdup(filename);
+  hp->v[i] = e;
+  e->in_heap = 1;
 }
 
-struct q_dir_entry
+static void
+spool_heap_pop(struct spool_heap *hp)
 {
-  unsigned char *name;
-  signed char    prio;
-  unsigned char  ign;
-};
+  struct spool_entry *last;
+  size_t i, c;
+
+  ASSERT(hp->u > 0);
+  hp->v[0]->in_heap = 0;
+  last = hp->v[--hp->u];
+  if (!hp->u) return;
+  i = 0;
+  while ((c = 2 * i + 1) < hp->u) {
+    if (c + 1 < hp->u && strcmp(hp->v[c + 1]->name, hp->v[c]->name) < 0) ++c;
+    if (strcmp(last->name, hp->v[c]->name) <= 0) break;
+    hp->v[i] = hp->v[c];
+    i = c;
+  }
+  hp->v[i] = last;
+}
 
-/* scans 'dir' directory and returns the filename found */
-int
-scan_dir(char const *partial_path, char *found_item, size_t fi_size, int random_mode)
+/* the first name of the group, dropping removed and ignored names */
+static struct spool_entry *
+spool_heap_top(struct spool_queue *q, struct spool_heap *hp)
 {
-  path_t         dir_path;
-  DIR           *d;
-  struct dirent *de;
-  int saved_errno;
-  int prio, found = 0, i, got_quit = 0, j;
-  unsigned char *items[32];
-  unsigned char *del_map = 0;
-  struct ignored_items *cur_ign = 0;
-  int low_prio = 32, high_prio = -1;
-
-  for (i = 0; i < ign_u; i++)
-    if (!strcmp(partial_path, ign[i].dir))
+  struct spool_entry *e;
+
+  while (hp->u > 0) {
+    e = hp->v[0];
+    if (e->present && !e->ignored) return e;
+    spool_heap_pop(hp);
+    if (!e->present) spool_entry_free(q, e);
+  }
+  return NULL;
+}
+
+static void
+spool_queue_add_name(struct spool_queue *q, const unsigned char *name)
+{
+  struct spool_entry *e = spool_entry_add(q, name);
+
+  e->present = 1;
+  if (!e->ignored && !e->in_heap && strcmp(name, "QUIT") != 0) {
+    spool_heap_push(&q->heaps[e->prio], e);
+  }
+}
+
+static void
+spool_queue_remove_name(struct spool_queue *q, const unsigned char *name)
+{
+  struct spool_entry *e = spool_entry_find(q, name);
+
+  if (!e) return;
+  e->present = 0;
+  if (!e->in_heap) spool_entry_free(q, e);
+}
+
+/* returns the inotify descriptor shared by all the queues */
+static int
+spool_notify_get_fd(void)
+{
+  size_t i;
+
+  if (spool_notify_fd >= 0 && spool_notify_pid != getpid()) {
+    // inherited through fork: the events would be split with the parent
+    close(spool_notify_fd);
+    spool_notify_fd = -1;
+    for (i = 0; i < spool_queue_u; ++i) {
+      spool_queues[i]->notify_wd = -1;
+      spool_queues[i]->need_rescan = 1;
+    }
+  }
+  if (spool_notify_fd < 0) {
+    if ((spool_notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0)
+      return -1;
+    spool_notify_pid = getpid();
+  }
+  return spool_notify_fd;
+}
+
+static void
+spool_queue_setup_notify(struct spool_queue *q)
+{
+  int fd;
+
+  if ((fd = spool_notify_get_fd()) < 0) return;
+  if (q->notify_wd >= 0) return;
+  // a directory watched twice gets the same watch descriptor
+  q->notify_wd = inotify_add_watch(fd, q->dir_path,
+                                   IN_CREATE | IN_MOVED_TO | IN_DELETE
+                                   | IN_MOVED_FROM | IN_DELETE_SELF
+                                   | IN_MOVE_SELF);
+}
+
+static struct spool_queue *
+spool_queue_find_wd(int wd)
+{
+  size_t i;
+
+  for (i = 0; i < spool_queue_u; ++i) {
+    if (spool_queues[i]->notify_wd == wd)
+      return spool_queues[i];
+  }
+  return NULL;
+}
+
+static void
+spool_queue_all_rescan(void)
+{
+  size_t i;
+
+  for (i = 0; i < spool_queue_u; ++i) {
+    spool_queues[i]->need_rescan = 1;
+    spool_queues[i]->notified = 1;
+  }
+}
+
+/* reads the pending events of all the queues */
+static void
+spool_notify_read_events(void)
+{
+  unsigned char buf[8192] __attribute__((aligned(__alignof__(struct inotify_event))));
+  const unsigned char *p, *bend;
+  const struct inotify_event *ev;
+  struct spool_queue *q;
+  int r;
+
+  if (spool_notify_get_fd() < 0) return;
+  while (1) {
+    r = read(spool_notify_fd, buf, sizeof(buf));
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0 && errno == EAGAIN) break;
+    if (r <= 0) {
+      err("scan_dir: inotify read failed: %s", os_ErrorMsg());
+      spool_queue_all_rescan();
       break;
-  if (i < ign_u) cur_ign = &ign[i];
+    }
+    p = buf;
+    bend = buf + r;
+    while (p < bend) {
+      ev = (const struct inotify_event *) p;
+      p += sizeof(*ev) + ev->len;
+      if ((ev->mask & IN_Q_OVERFLOW)) {
+        spool_queue_all_rescan();
+        continue;
+      }
+      if (!(q = spool_queue_find_wd(ev->wd))) continue;
+      q->notified = 1;
+      if ((ev->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))) {
+        q->need_rescan = 1;
+        if ((ev->mask & IN_MOVE_SELF)) {
+          // the watch follows the moved directory
+          inotify_rm_watch(spool_notify_fd, q->notify_wd);
+        }
+        // the watch is set up again on the rescan
+        q->notify_wd = -1;
+        continue;
+      }
+      if (!ev->len || !ev->name[0] || (ev->mask & IN_ISDIR)) continue;
+      if ((ev->mask & (IN_CREATE | IN_MOVED_TO))) {
+        spool_queue_add_name(q, ev->name);
+      } else if ((ev->mask & (IN_DELETE | IN_MOVED_FROM))) {
+        spool_queue_remove_name(q, ev->name);
+      }
+    }
+  }
+}
 
-  memset(items, 0, sizeof(items));
-  pathmake(dir_path, partial_path, "/", "dir", NULL);
-  if (!(d = opendir(dir_path))) {
+static int
+spool_queue_rescan(struct spool_queue *q)
+{
+  DIR *d;
+  struct dirent *de;
+  struct stat stb;
+  struct spool_entry *e, *next;
+  int saved_errno, prio;
+  size_t i, j;
+
+  // set the watch before reading the directory, so no change is lost
+  spool_queue_setup_notify(q);
+  if (q->notify_wd < 0 && stat(q->dir_path, &stb) >= 0) {
+    q->last_mtime = stb.st_mtim;
+  }
+  q->last_scan = time(NULL);
+
+  if (!(d = opendir(q->dir_path))) {
     saved_errno = errno;
-    err("scan_dir: opendir(\"%s\") failed: %s", dir_path, os_ErrorMsg());
+    err("scan_dir: opendir(\"%s\") failed: %s", q->dir_path, os_ErrorMsg());
+    q->need_rescan = 1;
     errno = saved_errno;
     return -saved_errno;
   }
 
-  if (cur_ign && cur_ign->u > 0) {
-    XALLOCAZ(del_map, cur_ign->u);
+  for (prio = 0; prio < SPOOL_PRIO_COUNT; ++prio) {
+    struct spool_heap *hp = &q->heaps[prio];
+    for (j = 0; j < hp->u; ++j) hp->v[j]->in_heap = 0;
+    hp->u = 0;
+  }
+  for (i = 0; i < q->hash_size; ++i) {
+    for (e = q->hash[i]; e; e = e->next) e->present = 0;
   }
 
   while ((de = readdir(d))) {
     if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
+    spool_entry_add(q, de->d_name)->present = 1;
+  }
+  closedir(d);
 
-    if (cur_ign) {
-      for (i = 0; i < cur_ign->u; i++)
-        if (!strcmp(cur_ign->items[i], de->d_name))
-          break;
-      if (i < cur_ign->u) {
-        del_map[i] = 1;
-        continue;
+  // drop vanished names, including the ignored ones
+  for (i = 0; i < q->hash_size; ++i) {
+    for (e = q->hash[i]; e; e = next) {
+      next = e->next;
+      if (!e->present) {
+        spool_entry_free(q, e);
+      } else if (!e->ignored && strcmp(e->name, "QUIT") != 0) {
+        spool_heap_push(&q->heaps[e->prio], e);
       }
     }
+  }
 
-    if (!strcmp("QUIT", de->d_name)) {
-      got_quit = 1;
-      continue;
-    }
+  q->need_rescan = 0;
+  return 0;
+}
 
-    /* if (strlen(de->d_name) != EJ_SERVE_PACKET_NAME_SIZE - 1) {
-      prio = 0;
-      } else */
-    if (de->d_name[0] >= '0' && de->d_name[0] <= '9') {
-      prio = -16 + (de->d_name[0] - '0');
-    } else if (de->d_name[0] >= 'A' && de->d_name[0] <= 'V') {
-      prio = -6 + (de->d_name[0] - 'A');
-    } else {
-      prio = 0;
-    }
-    if (prio < -16) prio = -16;
-    if (prio > 15) prio = 15;
-    prio += 16;
+static struct spool_queue *
+spool_queue_get(const unsigned char *dir)
+{
+  struct spool_queue *q;
+  size_t i;
 
-    if (prio < low_prio) low_prio = prio;
-    if (prio > high_prio) high_prio = prio;
+  for (i = 0; i < spool_queue_u; ++i) {
+    if (!strcmp(spool_queues[i]->dir, dir))
+      return spool_queues[i];
+  }
 
-    if (items[prio]) {
-      if (strcmp(items[prio], de->d_name) <= 0) continue;
-      items[prio] = (unsigned char*) alloca(strlen(de->d_name) + 1);
-      strcpy(items[prio], de->d_name);
-      continue;
+  if (spool_queue_u == spool_queue_a) {
+    if (!(spool_queue_a *= 2)) spool_queue_a = 4;
+    XREALLOC(spool_queues, spool_queue_a);
+  }
+  XCALLOC(q, 1);
+  q->dir = xstrdup(dir);
+  pathmake(q->dir_path, dir, "/", "dir", NULL);
+  q->notify_wd = -1;
+  q->need_rescan = 1;
+  spool_queues[spool_queue_u++] = q;
+  return q;
+}
+
+/* bring the in-memory queue up to date with the directory */
+static int
+spool_queue_refresh(struct spool_queue *q)
+{
+  struct stat stb;
+
+  if (q->notify_wd >= 0) spool_notify_read_events();
+  if (q->notify_wd < 0 && !q->need_rescan) {
+    // modifications within the same second as the last scan
+    // are not reliably visible in the mtime
+    if (stat(q->dir_path, &stb) < 0
+        || stb.st_mtim.tv_sec != q->last_mtime.tv_sec
+        || stb.st_mtim.tv_nsec != q->last_mtime.tv_nsec
+        || stb.st_mtim.tv_sec >= q->last_scan) {
+      q->need_rescan = 1;
     }
+  }
+  if (q->need_rescan) return spool_queue_rescan(q);
+  return 0;
+}
+
+void
+scan_dir_add_ignored(const unsigned char *dir, const unsigned char *filename)
+{
+  struct spool_queue *q;
+  struct spool_entry *e;
+
+  if (!dir || !*dir) return;
+  q = spool_queue_get(dir);
+
+  if (!filename || !*filename) return;
+  // the file has been just seen by the caller
+  e = spool_entry_add(q, filename);
+  if (!e->in_heap) e->present = 1;
+  e->ignored = 1;
+}
+
+/* waits for a change in the spool directory using the same inotify
+   descriptor as scan_dir, the events are applied to the in-memory queues,
+   the events of the other queues do not end the wait */
+int
+scan_dir_wait(const unsigned char *dir, int timeout_ms)
+{
+  struct spool_queue *q;
+  struct pollfd pfd;
+  struct timespec ts;
+  long long end_ms = 0, cur_ms;
+  int r;
 
-    items[prio] = (unsigned char*) alloca(strlen(de->d_name) + 1);
-    strcpy(items[prio], de->d_name);
-    found++;
+  if (!dir || !*dir) return -1;
+  q = spool_queue_get(dir);
+  if (q->notify_wd < 0 || spool_notify_pid != getpid()) {
+    spool_queue_setup_notify(q);
+    if (q->notify_wd < 0) return -1;
+    // the changes before the watch was set up are not known
+    q->need_rescan = 1;
+    return 1;
   }
-  closedir(d);
 
-  // cleanup ignored files
-  if (cur_ign) {
-    for (j = 0; j < cur_ign->u && del_map[j]; j++);
-    for (i = j; i < cur_ign->u; i++) {
-      if (del_map[i]) {
-        cur_ign->items[j++] = cur_ign->items[i];
-      } else {
-        xfree(cur_ign->items[i]);
-      }
+  if (timeout_ms > 0) {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    end_ms = ts.tv_sec * 1000LL + ts.tv_nsec / 1000000 + timeout_ms;
+  }
+  q->notified = 0;
+  while (1) {
+    memset(&pfd, 0, sizeof(pfd));
+    pfd.fd = spool_notify_fd;
+    pfd.events = POLLIN;
+    r = poll(&pfd, 1, timeout_ms);
+    if (r < 0) {
+      if (errno == EINTR) return 0;
+      err("scan_dir_wait: poll failed: %s", os_ErrorMsg());
+      return -1;
     }
-    cur_ign->u = j;
+    if (!r) return 0;
+    spool_notify_read_events();
+    if (q->notified || q->need_rescan) return 1;
+    if (timeout_ms > 0) {
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      cur_ms = ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+      if (cur_ms >= end_ms) return 0;
+      timeout_ms = end_ms - cur_ms;
+    } else if (!timeout_ms) {
+      return 0;
+    }
+  }
+}
+
+/* scans 'dir' directory and returns the filename found */
+int
+scan_dir(char const *partial_path, char *found_item, size_t fi_size, int random_mode)
+{
+  struct spool_queue *q;
+  struct spool_entry *e;
+  struct spool_entry *items[SPOOL_PRIO_COUNT];
+  int i, r;
+  int low_prio = SPOOL_PRIO_COUNT, high_prio = -1;
+
+  q = spool_queue_get(partial_path);
+  if ((r = spool_queue_refresh(q)) < 0) {
+    errno = -r;
+    return r;
   }
 
-  if (got_quit) {
+  if ((e = spool_entry_find(q, "QUIT")) && e->present && !e->ignored) {
     snprintf(found_item, fi_size, "%s", "QUIT");
     info("scan_dir: found QUIT packet");
     return 1;
   }
 
-  if (!found) return 0;
-
-  if (low_prio >= 32 || high_prio < 0) {
-    err("scan_dir: found == %d, but no items found!!!", found);
-    return 0;
+  for (i = 0; i < SPOOL_PRIO_COUNT; ++i) {
+    if ((items[i] = spool_heap_top(q, &q->heaps[i]))) {
+      if (i < low_prio) low_prio = i;
+      if (i > high_prio) high_prio = i;
+    }
   }
 
+  if (high_prio < 0) return 0;
+
   if (random_mode && low_prio != high_prio) {
     int range = high_prio - low_prio + 1;
     unsigned long long mask = (1ULL << range) - 1;
@@ -333,7 +702,7 @@ scan_dir(char const *partial_path, char *found_item, size_t fi_size, int random_
   }
 
   ASSERT(items[low_prio]);
-  snprintf(found_item, fi_size, "%s", items[low_prio]);
+  snprintf(found_item, fi_size, "%s", items[low_prio]->name);
   info("scan_dir: found '%s' (priority %d)", found_item, low_prio - 16);
   return 1;
 }
@@ -1200,6 +1569,86 @@ generic_copy_file(int sflags,
   return 1;
 }
 
+/* copy the data using the kernel: a reflink if the filesystem
+   supports it, otherwise copy_file_range, returns STAGE_COPIED if
+   neither works and nothing is written yet */
+static int
+kernel_copy_file(int sfd, int dfd, off_t size, const unsigned char *dst)
+{
+#if defined FICLONE
+  if (ioctl(dfd, FICLONE, sfd) >= 0) return STAGE_CLONED;
+#endif
+#if defined __NR_copy_file_range
+  off_t done = 0;
+  while (done < size) {
+    ssize_t r = syscall(__NR_copy_file_range, sfd, NULL, dfd, NULL,
+                        (size_t) (size - done), 0U);
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0 && !done && (errno == EXDEV || errno == ENOSYS || errno == EINVAL
+                           || errno == EOPNOTSUPP || errno == EBADF)) {
+      return STAGE_COPIED;
+    }
+    if (r < 0) {
+      err("copy_file_range to %s failed: %s", dst, os_ErrorMsg());
+      return -1;
+    }
+    if (!r) break;
+    done += r;
+  }
+  if (done == size) return STAGE_RANGE;
+  if (!done) return STAGE_COPIED;
+  err("copy_file_range to %s: short copy", dst);
+  return -1;
+#else
+  return STAGE_COPIED;
+#endif
+}
+
+/* put a file into a working directory without copying its data
+   where possible, returns the method used or a negative value on error */
+int
+stage_file(const unsigned char *src, const unsigned char *dst)
+{
+  struct stat stb;
+  int sfd = -1, dfd = -1, r;
+
+  if (lstat(src, &stb) < 0 || !S_ISREG(stb.st_mode)) {
+    // let the regular copy report the error
+    goto plain_copy;
+  }
+  unlink(dst);
+
+  if ((sfd = open(src, O_RDONLY | O_CLOEXEC, 0)) < 0) goto plain_copy;
+  if ((dfd = open(dst, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644)) < 0) {
+    err("stage_file: open(%s) failed: %s", dst, os_ErrorMsg());
+    close(sfd);
+    return -1;
+  }
+  r = kernel_copy_file(sfd, dfd, stb.st_size, dst);
+  close(sfd); sfd = -1;
+  if (r == STAGE_COPIED) {
+    close(dfd);
+    unlink(dst);
+    goto plain_copy;
+  }
+  if (r < 0) {
+    close(dfd);
+    unlink(dst);
+    return -1;
+  }
+  if (close(dfd) < 0) {
+    err("stage_file: close(%s) failed: %s", dst, os_ErrorMsg());
+    unlink(dst);
+    return -1;
+  }
+  return r;
+
+plain_copy:
+  write_log(0, LOG_INFO, "Copy: %s -> %s", src, dst);
+  if (do_copy_file(src, 0, dst, 0) < 0) return -1;
+  return STAGE_COPIED;
+}
+
 int
 make_executable(char const *path)
 {
@@ -1,6 +1,6 @@
 /* -*- c -*- */
 
-/* Copyright (C) 2005-2016 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2005-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -58,25 +58,84 @@ full_archive_find_file_zip(
         unsigned char **p_data);
 #endif
 
+static const unsigned char index_sig[4] = "EjIx";
+
+enum { ARCHIVE_VERSION = 2 };
+enum { COPY_BUF_SIZE = 65536 };
+
+static unsigned int
+name_hash(const unsigned char *name)
+{
+  // FNV-1a
+  unsigned int h = 2166136261U;
+  for (; *name; ++name) {
+    h ^= *name;
+    h *= 16777619U;
+  }
+  return h;
+}
+
+static int
+write_all(int fd, const void *data, size_t size)
+{
+  const char *buf = (const char *) data;
+  ssize_t wsz;
+
+  while (size > 0) {
+    if ((wsz = write(fd, buf, size)) <= 0) {
+      if (wsz < 0 && errno == EINTR) continue;
+      return -1;
+    }
+    size -= wsz, buf += wsz;
+  }
+  return 0;
+}
+
+static int
+pwrite_all(int fd, const void *data, size_t size, off_t offset)
+{
+  const char *buf = (const char *) data;
+  ssize_t wsz;
+
+  while (size > 0) {
+    if ((wsz = pwrite(fd, buf, size, offset)) <= 0) {
+      if (wsz < 0 && errno == EINTR) continue;
+      return -1;
+    }
+    size -= wsz, buf += wsz, offset += wsz;
+  }
+  return 0;
+}
+
 full_archive_t
 full_archive_open_write(const unsigned char *path)
+{
+  return full_archive_open_write_codec(path, FULL_ARCHIVE_CODEC_DEFLATE);
+}
+
+full_archive_t
+full_archive_open_write_codec(const unsigned char *path, int codec)
 {
   full_archive_t af = 0;
   int fd = -1;
   struct full_archive_file_header header;
-  char *buf;
-  int wtot, wsz, plen;
+  int plen;
 
   if (!path || !*path) {
     err("full_archive_open_write: path == NULL");
     goto failure;
   }
+  if (codec < 0 || codec >= FULL_ARCHIVE_CODEC_LAST) {
+    err("full_archive_open_write: invalid codec %d", codec);
+    goto failure;
+  }
 
 #if defined CONF_HAS_LIBZIP
   if ((plen = strlen(path)) > 4 && !strcmp(path + plen - 4, ".zip")) {
     return full_archive_open_write_zip(path);
   }
 #endif
+  (void) plen;
 
   if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) < 0) {
     err("full_archive_open_write: cannot open: %s", os_ErrorMsg());
@@ -85,19 +144,19 @@ full_archive_open_write(const unsigned char *path)
 
   memset(&header, 0, sizeof(header));
   strcpy(header.sig, file_sig);
-  header.version = 1;
+  header.version = ARCHIVE_VERSION;
+  header.codec = codec;
 
-  wtot = sizeof(header), buf = (char*) &header;
-  while (wtot > 0) {
-    if ((wsz = write(fd, buf, wtot)) <= 0) {
-      err("full_archive_open_write: write error: %s", os_ErrorMsg());
-      goto failure;
-    }
-    wtot -= wsz, buf += wsz;
+  if (write_all(fd, &header, sizeof(header)) < 0) {
+    err("full_archive_open_write: write error: %s", os_ErrorMsg());
+    goto failure;
   }
 
   XCALLOC(af, 1);
   af->fd = fd;
+  af->version = ARCHIVE_VERSION;
+  af->codec = codec;
+  af->write_mode = 1;
   af->cur_size = sizeof(header);
   return af;
 
@@ -110,6 +169,42 @@ full_archive_open_write(const unsigned char *path)
   return 0;
 }
 
+/* writes the name index and the trailer after the last entry */
+static int
+write_index(full_archive_t af)
+{
+  struct full_archive_index_slot *slots = 0;
+  struct full_archive_index_trailer trailer;
+  unsigned int slot_count = 16, mask, i, j;
+
+  while (slot_count < 2U * af->idx_u) slot_count *= 2;
+  mask = slot_count - 1;
+  XCALLOC(slots, slot_count);
+  for (i = 0; i < af->idx_u; ++i) {
+    for (j = af->idx[i].hash & mask; slots[j].offset; j = (j + 1) & mask);
+    slots[j] = af->idx[i];
+  }
+
+  memset(&trailer, 0, sizeof(trailer));
+  memcpy(trailer.sig, index_sig, sizeof(trailer.sig));
+  trailer.slot_count = slot_count;
+  trailer.index_offset = af->cur_size;
+
+  if (lseek(af->fd, af->cur_size, SEEK_SET) < 0
+      || write_all(af->fd, slots, slot_count * sizeof(slots[0])) < 0
+      || write_all(af->fd, &trailer, sizeof(trailer)) < 0) {
+    err("full_archive_close: index write error: %s", os_ErrorMsg());
+    // leave the archive readable by the sequential scan
+    if (ftruncate(af->fd, af->cur_size) < 0) {
+      err("full_archive_close: ftruncate failed: %s", os_ErrorMsg());
+    }
+    xfree(slots);
+    return -1;
+  }
+  xfree(slots);
+  return 0;
+}
+
 full_archive_t
 full_archive_close(full_archive_t af)
 {
@@ -123,15 +218,109 @@ full_archive_close(full_archive_t af)
 
   ASSERT(af->fd >= 0);
 
+  if (af->write_mode) {
+    write_index(af);
+  }
+
   if (af->mptr) {
     munmap((void*) af->mptr, af->msize);
   }
 
   close(af->fd);
+  xfree(af->idx);
   xfree(af);
   return 0;
 }
 
+/* copies the file to the archive compressing it on the fly */
+static int
+copy_entry_data(
+        full_archive_t af,
+        int fd2,
+        off_t offset,
+        long long *p_raw_size,
+        long long *p_size)
+{
+  unsigned char *in_buf = 0, *out_buf = 0;
+  z_stream zs;
+  int zs_active = 0, zr, flush;
+  ssize_t rsz;
+  long long raw_size = 0, size = 0;
+  size_t out_size;
+
+  if (lseek(af->fd, offset, SEEK_SET) < 0) {
+    err("full_archive_append_file: lseek failed: %s", os_ErrorMsg());
+    goto failure;
+  }
+
+  in_buf = xmalloc(COPY_BUF_SIZE);
+  out_buf = xmalloc(COPY_BUF_SIZE);
+
+  if (af->codec == FULL_ARCHIVE_CODEC_DEFLATE) {
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit(&zs, Z_BEST_SPEED) != Z_OK) {
+      err("full_archive_append_file: deflateInit failed");
+      goto failure;
+    }
+    zs_active = 1;
+  }
+
+  do {
+    while ((rsz = read(fd2, in_buf, COPY_BUF_SIZE)) < 0 && errno == EINTR);
+    if (rsz < 0) {
+      err("full_archive_append_file: read error: %s", os_ErrorMsg());
+      goto failure;
+    }
+    raw_size += rsz;
+
+    if (!zs_active) {
+      if (rsz > 0 && write_all(af->fd, in_buf, rsz) < 0) {
+        err("full_archive_append_file: write error: %s", os_ErrorMsg());
+        goto failure;
+      }
+      size += rsz;
+      continue;
+    }
+
+    flush = rsz > 0 ? Z_NO_FLUSH : Z_FINISH;
+    zs.next_in = in_buf;
+    zs.avail_in = rsz;
+    do {
+      zs.next_out = out_buf;
+      zs.avail_out = COPY_BUF_SIZE;
+      zr = deflate(&zs, flush);
+      if (zr == Z_STREAM_ERROR) {
+        err("full_archive_append_file: compressing failed");
+        goto failure;
+      }
+      out_size = COPY_BUF_SIZE - zs.avail_out;
+      if (out_size > 0 && write_all(af->fd, out_buf, out_size) < 0) {
+        err("full_archive_append_file: write error: %s", os_ErrorMsg());
+        goto failure;
+      }
+      size += out_size;
+    } while (!zs.avail_out);
+  } while (rsz > 0);
+
+  if (raw_size > 0x7fffffffLL || size > 0x7fffffffLL) {
+    err("full_archive_append_file: file is too big");
+    goto failure;
+  }
+
+  if (zs_active) deflateEnd(&zs);
+  xfree(in_buf);
+  xfree(out_buf);
+  *p_raw_size = raw_size;
+  *p_size = size;
+  return 0;
+
+ failure:
+  if (zs_active) deflateEnd(&zs);
+  xfree(in_buf);
+  xfree(out_buf);
+  return -1;
+}
+
 int
 full_archive_append_file(
         full_archive_t af,
@@ -143,10 +332,8 @@ full_archive_append_file(
   size_t header_size;
   int fd2 = -1;
   struct full_archive_entry_header *cur_head = 0;
-  char *file_buf = 0, *comp_buf = 0, *buf;
-  size_t file_size = 0;
-  uLong comp_size = 0;
-  long wtot, wsz;
+  long long raw_size = 0, comp_size = 0;
+  long data_end;
   unsigned char pad_buf[16];
 
   ASSERT(af);
@@ -170,84 +357,85 @@ full_archive_append_file(
   header_size = sizeof(struct full_archive_entry_header) + entry_name_len;
   header_size = (header_size + 15) & ~15;
 
-  if (generic_read_file(&file_buf, 0, &file_size, 0, 0, path, 0) < 0) {
-    err("full_archive_append_file: reading of `%s' failed", path);
+  if ((fd2 = open(path, O_RDONLY, 0)) < 0) {
+    err("full_archive_append_file: cannot open `%s': %s", path, os_ErrorMsg());
     goto failure;
   }
-  if (file_size > 0) {
-    comp_size = compressBound(file_size);
-    comp_buf = xcalloc(1, comp_size);
-    if (compress2(comp_buf, &comp_size, file_buf, file_size, 9) != Z_OK) {
-      err("full_archive_append_file: compressing failed");
-      goto failure;
-    }
-  } else {
-    comp_size = 0;
-    comp_buf = 0;
+
+  // the header is written after the data, when the sizes are known
+  if (copy_entry_data(af, fd2, af->cur_size + header_size, &raw_size, &comp_size) < 0) {
+    goto failure;
+  }
+  close(fd2); fd2 = -1;
+
+  // pad with zeroes
+  data_end = af->cur_size + header_size + comp_size;
+  memset(pad_buf, 0, sizeof(pad_buf));
+  if (write_all(af->fd, pad_buf, ((data_end + 15) & ~15) - data_end) < 0) {
+    err("full_archive_append_file: write error: %s", os_ErrorMsg());
+    goto failure;
   }
 
   cur_head = (struct full_archive_entry_header*) xcalloc(1, header_size);
   cur_head->header_size = header_size;
   cur_head->flags = flags;
   strcpy(cur_head->name, entry_name);
-  cur_head->raw_size = file_size;
+  cur_head->raw_size = raw_size;
   cur_head->size = comp_size;
 
-  if (lseek(af->fd, af->cur_size, SEEK_SET) < 0) {
-    err("full_archive_append_file: lseek failed: %s", os_ErrorMsg());
+  if (pwrite_all(af->fd, cur_head, header_size, af->cur_size) < 0) {
+    err("full_archive_append_file: write error: %s", os_ErrorMsg());
     goto failure;
   }
 
-  // write header
-  wtot = header_size, buf = (char*) cur_head;
-  while (wtot > 0) {
-    if ((wsz = write(af->fd, buf, wtot)) <= 0) {
-      err("full_archive_append_file: write error: %s", os_ErrorMsg());
-      goto failure;
-    }
-    wtot -= wsz, buf += wsz;
-  }
-
-  if (comp_size > 0) {
-    // write compressed file
-    wtot = comp_size, buf = comp_buf;
-    while (wtot > 0) {
-      if ((wsz = write(af->fd, buf, wtot)) <= 0) {
-        err("full_archive_append_file: write error: %s", os_ErrorMsg());
-        goto failure;
-      }
-      wtot -= wsz, buf += wsz;
-    }
-
-    // pad with zeroes
-    memset(pad_buf, 0, sizeof(pad_buf));
-    wtot = ((comp_size + 15) & ~15) - comp_size;
-    buf = pad_buf;
-    while (wtot > 0) {
-      if ((wsz = write(af->fd, buf, wtot)) <= 0) {
-        err("full_archive_append_file: write error: %s", os_ErrorMsg());
-        goto failure;
-      }
-      wtot -= wsz, buf += wsz;
-    }
+  if (af->idx_u == af->idx_a) {
+    if (!(af->idx_a *= 2)) af->idx_a = 64;
+    XREALLOC(af->idx, af->idx_a);
   }
+  af->idx[af->idx_u].hash = name_hash(entry_name);
+  af->idx[af->idx_u].reserved = 0;
+  af->idx[af->idx_u].offset = af->cur_size;
+  ++af->idx_u;
 
   xfree(cur_head);
-  xfree(file_buf);
-  xfree(comp_buf);
-  af->cur_size += header_size + comp_size;
-  af->cur_size = (af->cur_size + 15) & ~15;
+  af->cur_size = (data_end + 15) & ~15;
 
   return 0;
 
  failure:
   xfree(cur_head);
-  xfree(file_buf);
-  xfree(comp_buf);
   if (fd2 >= 0) close(fd2);
+  if (af->fd >= 0 && ftruncate(af->fd, af->cur_size) < 0) {
+    err("full_archive_append_file: ftruncate failed: %s", os_ErrorMsg());
+  }
   return -1;
 }
 
+/* locates the name index of a version 2 archive */
+static void
+open_index(full_archive_t af)
+{
+  const struct full_archive_index_trailer *trailer;
+  long hsize = sizeof(struct full_archive_file_header);
+  long tsize = sizeof(*trailer);
+
+  af->entries_end = af->msize;
+  if (af->msize < hsize + tsize) return;
+  trailer = (const struct full_archive_index_trailer *) (af->mptr + af->msize - tsize);
+  if (memcmp(trailer->sig, index_sig, sizeof(trailer->sig)) != 0) return;
+  if (!trailer->slot_count || (trailer->slot_count & (trailer->slot_count - 1))) return;
+  if (trailer->index_offset < hsize || (trailer->index_offset & 15)) return;
+  if (trailer->index_offset > af->msize - tsize) return;
+  if ((af->msize - tsize - trailer->index_offset) / sizeof(af->slots[0]) != trailer->slot_count
+      || (af->msize - tsize - trailer->index_offset) % sizeof(af->slots[0]) != 0) {
+    return;
+  }
+
+  af->entries_end = trailer->index_offset;
+  af->slots = (const struct full_archive_index_slot *) (af->mptr + trailer->index_offset);
+  af->slot_count = trailer->slot_count;
+}
+
 full_archive_t
 full_archive_open_read(const unsigned char *path)
 {
@@ -268,6 +456,7 @@ full_archive_open_read(const unsigned char *path)
     return full_archive_open_read_zip(path);
   }
 #endif
+  (void) plen;
 
   if ((fd = open(path, O_RDONLY, 0)) < 0) {
     err("full_archive_open_read: cannot open `%s': %s", path, os_ErrorMsg());
@@ -287,6 +476,7 @@ full_archive_open_read(const unsigned char *path)
     goto failure;
   }
   if ((mptr = mmap(0, msize, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    mptr = 0;
     err("full_archive_open_read: mmap failed: %s", os_ErrorMsg());
     goto failure;
   }
@@ -296,21 +486,108 @@ full_archive_open_read(const unsigned char *path)
     err("full_archive_open_read: file signature mismatch");
     goto failure;
   }
-  if (fhead->version != 1) {
+  if (fhead->version != 1 && fhead->version != ARCHIVE_VERSION) {
     err("full_archive_open_read: version mismatch");
     goto failure;
   }
+  if (fhead->version == ARCHIVE_VERSION && fhead->codec >= FULL_ARCHIVE_CODEC_LAST) {
+    err("full_archive_open_read: unsupported codec %d", fhead->codec);
+    goto failure;
+  }
 
   XCALLOC(af, 1);
   af->fd = fd;
   af->mptr = mptr;
   af->msize = msize;
+  af->version = fhead->version;
+  af->entries_end = msize;
+  if (af->version == 1) {
+    // version 1 entries are always compressed
+    af->codec = FULL_ARCHIVE_CODEC_DEFLATE;
+  } else {
+    af->codec = fhead->codec;
+    open_index(af);
+  }
   return af;
 
  failure:
   if (af) xfree(af);
   if (mptr) munmap(mptr, msize);
-  if (fd) close(fd);
+  if (fd >= 0) close(fd);
+  return 0;
+}
+
+/* validates the entry header at cur_ptr, returns an error code */
+static int
+check_entry(
+        full_archive_t af,
+        const unsigned char *cur_ptr,
+        const full_archive_entry_header_t **p_head)
+{
+  const unsigned char *end_ptr = af->mptr + af->entries_end;
+  const full_archive_entry_header_t *cur_head;
+  size_t name_len;
+
+  if (((unsigned long) cur_ptr & 15)) return 1;
+  if (cur_ptr > end_ptr) return 2;
+  if (cur_ptr + sizeof(*cur_head) > end_ptr) return 3;
+  cur_head = (const full_archive_entry_header_t *) cur_ptr;
+  if (cur_head->header_size < 0) return 4;
+  if ((cur_head->header_size & 15)) return 5;
+  if (cur_head->header_size < sizeof(*cur_head)) return 6;
+  if (cur_head->header_size > (((sizeof(*cur_head) + FULL_ARCHIVE_MAX_NAME_LEN) + 15) & ~15)) {
+    return 7;
+  }
+  if (cur_ptr + cur_head->header_size > end_ptr) return 3;
+  name_len = strnlen(cur_head->name, cur_head->header_size - sizeof(*cur_head));
+  if (cur_head->name[name_len]) return 8;
+  if (name_len > FULL_ARCHIVE_MAX_NAME_LEN) return 9;
+
+  cur_ptr += cur_head->header_size;
+  if (cur_head->size < 0) return 10;
+  if (cur_ptr + cur_head->size > end_ptr) return 11;
+
+  *p_head = cur_head;
+  return 0;
+}
+
+/* returns an error code */
+static int
+extract_entry(
+        full_archive_t af,
+        const full_archive_entry_header_t *cur_head,
+        long *p_raw_size,
+        unsigned int *p_flags,
+        unsigned char **p_data)
+{
+  const unsigned char *data_ptr = (const unsigned char *) cur_head + cur_head->header_size;
+  uLongf raw_size;
+
+  *p_raw_size = cur_head->raw_size;
+  *p_flags = cur_head->flags;
+
+  if (cur_head->raw_size <= 0) {
+    *p_data = xmalloc(1);
+    **p_data = 0;
+    return 0;
+  }
+
+  *p_data = xmalloc(cur_head->raw_size + 1);
+  if (af->codec == FULL_ARCHIVE_CODEC_STORE) {
+    if (cur_head->size != cur_head->raw_size) {
+      xfree(*p_data);
+      return 14;
+    }
+    memcpy(*p_data, data_ptr, cur_head->size);
+  } else {
+    raw_size = cur_head->raw_size;
+    if (uncompress(*p_data, &raw_size, data_ptr, cur_head->size) != Z_OK
+        || raw_size != cur_head->raw_size) {
+      xfree(*p_data);
+      return 13;
+    }
+  }
+  (*p_data)[cur_head->raw_size] = 0;
   return 0;
 }
 
@@ -323,9 +600,8 @@ full_archive_find_file(
         unsigned char **p_data)
 {
   const unsigned char *cur_ptr;
-  const unsigned char *end_ptr = af->mptr + af->msize;
-  const full_archive_entry_header_t *cur_head;
-  size_t name_len;
+  const unsigned char *end_ptr;
+  const full_archive_entry_header_t *cur_head = 0;
   int errcode = 0;
 
   ASSERT(af);
@@ -338,79 +614,49 @@ full_archive_find_file(
 
   ASSERT(af->mptr);
 
-  cur_ptr = af->mptr + sizeof(struct full_archive_file_header);
-  while (1) {
-    if (((unsigned long) cur_ptr & 15)) {
-      errcode = 1;
-      goto failure;
-    }
-    if (cur_ptr == end_ptr) break;
-    if (cur_ptr > end_ptr) {
-      errcode = 2;
-      goto failure;
-    }
-    if (cur_ptr + sizeof(*cur_head) > end_ptr) {
-      errcode = 3;
-      goto failure;
-    }
-    cur_head = (const full_archive_entry_header_t *) cur_ptr;
-    if (cur_head->header_size < 0) {
-      errcode = 4;
-      goto failure;
-    }
-    if ((cur_head->header_size & 15)) {
-      errcode = 5;
-      goto failure;
-    }
-    if (cur_head->header_size < sizeof(*cur_head)) {
-      errcode = 6;
-      goto failure;
-    }
-    if (cur_head->header_size > (((sizeof(*cur_head) + FULL_ARCHIVE_MAX_NAME_LEN) + 15) & ~15)) {
-      errcode = 7;
-      goto failure;
-    }
-    name_len = strnlen(cur_head->name, cur_head->header_size - sizeof(*cur_head));
-    if (cur_head->name[name_len]) {
-      errcode = 8;
-      goto failure;
-    }
-    if (name_len > FULL_ARCHIVE_MAX_NAME_LEN) {
-      errcode = 9;
-      goto failure;
+  if (af->slots) {
+    unsigned int h = name_hash(name);
+    unsigned int mask = af->slot_count - 1;
+    unsigned int i, j;
+
+    for (i = 0, j = h & mask; i < af->slot_count; ++i, j = (j + 1) & mask) {
+      const struct full_archive_index_slot *slot = &af->slots[j];
+      if (!slot->offset) break;
+      if (slot->hash != h) continue;
+      if (slot->offset < sizeof(struct full_archive_file_header)
+          || slot->offset >= af->entries_end) {
+        errcode = 15;
+        goto failure;
+      }
+      if ((errcode = check_entry(af, af->mptr + slot->offset, &cur_head))) {
+        goto failure;
+      }
+      if (!strcmp(cur_head->name, name)) {
+        if ((errcode = extract_entry(af, cur_head, p_raw_size, p_flags, p_data))) {
+          goto failure;
+        }
+        return 1;
+      }
     }
+    /* entry not found */
+    return 0;
+  }
 
-    cur_ptr += cur_head->header_size;
-    if (cur_head->size < 0) {
-      errcode = 10;
-      goto failure;
-    }
-    if (cur_ptr + cur_head->size > end_ptr) {
-      errcode = 11;
+  cur_ptr = af->mptr + sizeof(struct full_archive_file_header);
+  end_ptr = af->mptr + af->entries_end;
+  while (cur_ptr != end_ptr) {
+    if ((errcode = check_entry(af, cur_ptr, &cur_head))) {
       goto failure;
     }
 
     if (!strcmp(cur_head->name, name)) {
-      *p_raw_size = cur_head->raw_size;
-      *p_flags = cur_head->flags;
-
-      if (cur_head->raw_size <= 0) {
-        *p_data = xmalloc(1);
-        **p_data = 0;
-        return 1;
-      }
-
-      *p_data = xmalloc(cur_head->raw_size + 1);
-      if (uncompress(*p_data, p_raw_size, cur_ptr, cur_head->size) != Z_OK) {
-        xfree(*p_data);
-        errcode = 13;
+      if ((errcode = extract_entry(af, cur_head, p_raw_size, p_flags, p_data))) {
         goto failure;
       }
-      (*p_data)[cur_head->raw_size] = 0;
       return 1;
     }
 
-    cur_ptr += cur_head->size;
+    cur_ptr += cur_head->header_size + cur_head->size;
     cur_ptr = (const unsigned char*)(((unsigned long) cur_ptr + 15) & ~15);
     if (cur_ptr > end_ptr) {
       errcode = 12;
@@ -145,6 +145,7 @@ struct tTask
   int cleanup_invoked;          /* not to invoke cleanup handler several times */
   char *container_options;      /* options for containerization */
   char *language_name;          /* programming language name for container presets */
+  int container_pool_size;      /* the number of reusable cgroups for containers */
   int status_fd;                /* the receiving end of data pipe for container execution */
   int ipc_object_count;         /* the count of the remaining IPC objects */
   int orphan_process_count;     /* the count of the remaining processes */
@@ -1337,6 +1338,15 @@ task_SetLanguageName(tTask *tsk, const char *language_name)
   return 0;
 }
 
+int
+task_SetContainerPool(tTask *tsk, int size)
+{
+  task_init_module();
+  ASSERT(tsk);
+  tsk->container_pool_size = size;
+  return 0;
+}
+
 int
 task_SetControlSocket(tTask *tsk, int fd1, int fd2)
 {
@@ -1753,6 +1763,9 @@ task_StartContainer(tTask *tsk)
     int len = strlen(tsk->language_name);
     fprintf(spec_f, "ol%d%s", len, tsk->language_name);
   }
+  if (tsk->container_pool_size > 0) {
+    fprintf(spec_f, "p%d", tsk->container_pool_size);
+  }
 
   if (tsk->container_options) fputs(tsk->container_options, spec_f);
   fclose(spec_f); spec_f = NULL;
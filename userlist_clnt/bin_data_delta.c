@@ -0,0 +1,58 @@
+/* -*- mode: c -*- */
+
+/* Copyright (C) 2026 Alexander Chernov <cher@ejudge.ru> */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "userlist_clnt/private.h"
+
+int
+userlist_clnt_bin_data_delta(
+        struct userlist_clnt *clnt,
+        int cmd,
+        int contest_id,
+        int flags,
+        unsigned long long vintage,
+        unsigned char **p_data)
+{
+  struct userlist_pk_standings_delta *out = 0;
+  struct userlist_pk_bin_data *in = 0;
+  int r;
+  size_t out_size, in_size = 0;
+
+  out_size = sizeof(*out);
+  out = alloca(out_size);
+  memset(out, 0, out_size);
+  out->request_id = cmd;
+  out->contest_id = contest_id;
+  out->flags = flags;
+  out->vintage = vintage;
+  if ((r = userlist_clnt_send_packet(clnt, out_size, out)) < 0) return r;
+  if ((r = userlist_clnt_read_and_notify(clnt, &in_size, (void*) &in)) < 0)
+    return r;
+  if (in_size < sizeof(struct userlist_pk_bin_data)) {
+    xfree(in);
+    return -ULS_ERR_PROTOCOL;
+  }
+  if (in->reply_id != ULS_BIN_DATA) {
+    r = in->reply_id;
+    xfree(in);
+    return r;
+  }
+  if (in_size < sizeof(struct userlist_pk_xml_data)) {
+    xfree(in);
+    return -ULS_ERR_PROTOCOL;
+  }
+  *p_data = (unsigned char *) in;
+  return ULS_BIN_DATA;
+}
@@ -1,6 +1,6 @@
 /* -*- c -*- */
 
-/* Copyright (C) 2000-2016 Alexander Chernov <cher@ejudge.ru> */
+/* Copyright (C) 2000-2026 Alexander Chernov <cher@ejudge.ru> */
 
 /*
  * This program is free software; you can redistribute it and/or
@@ -978,6 +978,13 @@ make_hardlink(const unsigned char *oldname, const unsigned char *newname)
   return fast_copy_file(oldname, newname);
 }
 
+int
+stage_file(const unsigned char *src, const unsigned char *dst)
+{
+  if (fast_copy_file(src, dst) < 0) return -1;
+  return STAGE_COPIED;
+}
+
 int
 scan_executable_files(
         const unsigned char *dir,
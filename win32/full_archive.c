@@ -72,6 +72,13 @@ full_archive_open_write(const unsigned char *path)
   return 0;
 }
 
+full_archive_t
+full_archive_open_write_codec(const unsigned char *path, int codec)
+{
+  // only version 1 archives are written on this platform
+  return full_archive_open_write(path);
+}
+
 full_archive_t
 full_archive_close(full_archive_t af)
 {